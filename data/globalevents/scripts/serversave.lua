@@ -14,6 +14,8 @@ local function ServerSave()
 		end
 
 		if closeAtServerSave then
+			-- nobody is online to block spawns, bring everything back before reopening
+			Game.respawnMonsters()
 			Game.setGameState(GAME_STATE_NORMAL)
 		end
 	end
@@ -0,0 +1,97 @@
+-- Compares the batch area functions with the per-call loops they replace
+-- and returns one line per case, e.g. benchmarkAreaApis(player:getPosition(), 7, 100)
+local function measure(iterations, f)
+	local start = os.mtime()
+	local result
+	for _ = 1, iterations do
+		result = f()
+	end
+	return os.mtime() - start, result
+end
+
+function benchmarkAreaApis(position, radius, iterations)
+	radius = radius or 7
+	iterations = iterations or 100
+
+	local fromPosition = Position(position.x - radius, position.y - radius, position.z)
+	local toPosition = Position(position.x + radius, position.y + radius, position.z)
+	local ground = Tile(position) and Tile(position):getGround()
+	local itemId = ground and ground:getId() or 0
+
+	local cases = {
+		{
+			name = "spectator ids",
+			perCall = function()
+				local ids = {}
+				for _, creature in ipairs(Game.getSpectators(position, false, false, radius, radius, radius, radius)) do
+					ids[#ids + 1] = creature:getId()
+				end
+				return #ids
+			end,
+			batch = function()
+				return #Game.getSpectatorIds(position, false, false, radius, radius, radius, radius)
+			end
+		},
+		{
+			name = "tiles with item " .. itemId,
+			perCall = function()
+				local positions = {}
+				for x = fromPosition.x, toPosition.x do
+					for y = fromPosition.y, toPosition.y do
+						local tile = Tile(x, y, position.z)
+						if tile then
+							local found = false
+							local tileGround = tile:getGround()
+							if tileGround and tileGround:getId() == itemId then
+								found = true
+							else
+								for _, item in ipairs(tile:getItems() or {}) do
+									if item:getId() == itemId then
+										found = true
+										break
+									end
+								end
+							end
+							if found then
+								positions[#positions + 1] = tile:getPosition()
+							end
+						end
+					end
+				end
+				return #positions
+			end,
+			batch = function()
+				return #Game.getAreaPositions(fromPosition, toPosition, {itemId = itemId})
+			end
+		},
+		{
+			name = "tiles with creatures",
+			perCall = function()
+				local positions = {}
+				for x = fromPosition.x, toPosition.x do
+					for y = fromPosition.y, toPosition.y do
+						local tile = Tile(x, y, position.z)
+						if tile and tile:getCreatureCount() > 0 then
+							positions[#positions + 1] = tile:getPosition()
+						end
+					end
+				end
+				return #positions
+			end,
+			batch = function()
+				return #Game.getAreaPositions(fromPosition, toPosition, {creatures = true})
+			end
+		}
+	}
+
+	local lines = {}
+	for _, case in ipairs(cases) do
+		local perCallTime, perCallCount = measure(iterations, case.perCall)
+		local batchTime, batchCount = measure(iterations, case.batch)
+		local line = string.format("%s: per call %d ms, batch %d ms (%d results%s)", case.name, perCallTime, batchTime, batchCount,
+			perCallCount ~= batchCount and string.format(", per call found %d", perCallCount) or "")
+		print(line)
+		lines[#lines + 1] = line
+	end
+	return lines
+end
@@ -1,3 +1,12 @@
 function onUpdateDatabase()
-	return false
+	print("> Updating database to version 34 (compact item storage)")
+	db.query([[
+		CREATE TABLE IF NOT EXISTS `player_itemblobs` (
+			`player_id` int NOT NULL,
+			`items` longblob NOT NULL,
+			PRIMARY KEY (`player_id`),
+			FOREIGN KEY (`player_id`) REFERENCES `players`(`id`) ON DELETE CASCADE
+		) ENGINE=InnoDB DEFAULT CHARACTER SET=utf8;
+	]])
+	return true
 end
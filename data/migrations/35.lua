@@ -0,0 +1,3 @@
+function onUpdateDatabase()
+	return false
+end
@@ -138,6 +138,9 @@ registerMonsterType.flags = function(mtype, mask)
 		if mask.flags.canWalkOnPoison ~= nil then
 			mtype:canWalkOnPoison(mask.flags.canWalkOnPoison)
 		end
+		if mask.flags.asyncPathfinding ~= nil then
+			mtype:asyncPathfinding(mask.flags.asyncPathfinding)
+		end
 	end
 end
 registerMonsterType.light = function(mtype, mask)
@@ -0,0 +1,79 @@
+-- Runs in every script shard, not in the main state, so no game functions are
+-- available here. From any other script:
+--   Game.postShard("encodeJson", {name = player:getName(), level = player:getLevel()}, function(json, err)
+--       if json then print(json) end
+--   end)
+
+local escapes = {
+	['"'] = '\\"', ['\\'] = '\\\\', ['\b'] = '\\b', ['\f'] = '\\f',
+	['\n'] = '\\n', ['\r'] = '\\r', ['\t'] = '\\t'
+}
+
+local function escape(s)
+	return (s:gsub('[%c"\\]', function(c)
+		return escapes[c] or string.format("\\u%04x", c:byte())
+	end))
+end
+
+local function isArray(t)
+	local count = 0
+	for k in pairs(t) do
+		if type(k) ~= "number" or k < 1 or math.floor(k) ~= k then
+			return false
+		end
+		count = count + 1
+	end
+	return count == #t
+end
+
+local function encode(value, out)
+	local valueType = type(value)
+	if valueType == "nil" then
+		out[#out + 1] = "null"
+	elseif valueType == "boolean" then
+		out[#out + 1] = tostring(value)
+	elseif valueType == "number" then
+		if value == math.floor(value) and math.abs(value) < 2^53 then
+			out[#out + 1] = string.format("%d", value)
+		else
+			out[#out + 1] = string.format("%.14g", value)
+		end
+	elseif valueType == "string" then
+		out[#out + 1] = '"' .. escape(value) .. '"'
+	elseif isArray(value) then
+		out[#out + 1] = "["
+		for i, v in ipairs(value) do
+			if i > 1 then
+				out[#out + 1] = ","
+			end
+			encode(v, out)
+		end
+		out[#out + 1] = "]"
+	else
+		local keys = {}
+		for k in pairs(value) do
+			keys[#keys + 1] = tostring(k)
+		end
+		table.sort(keys)
+
+		out[#out + 1] = "{"
+		for i, k in ipairs(keys) do
+			if i > 1 then
+				out[#out + 1] = ","
+			end
+			local v = value[k]
+			if v == nil then
+				v = value[tonumber(k)]
+			end
+			out[#out + 1] = '"' .. escape(k) .. '":'
+			encode(v, out)
+		end
+		out[#out + 1] = "}"
+	end
+end
+
+Shard.on("encodeJson", function(value)
+	local out = {}
+	encode(value, out)
+	return table.concat(out)
+end)
@@ -0,0 +1,62 @@
+function onSay(player, words, param)
+	if not player:isAdmin() then
+		return true
+	end
+
+	logCommand(player, words, param)
+
+	local split = param:splitTrimmed(" ")
+	local action = split[1] and split[1]:lower() or ""
+	if action == "on" then
+		local interval = tonumber(split[2]) or 0
+		Game.setLuaProfiler(true, interval)
+		if interval > 0 then
+			player:sendColorMessage(string.format("Lua profiler started, sampling every %d instructions.", interval), MESSAGE_COLOR_PURPLE)
+		else
+			player:sendColorMessage("Lua profiler started.", MESSAGE_COLOR_PURPLE)
+		end
+	elseif action == "off" then
+		Game.setLuaProfiler(false)
+		player:sendColorMessage("Lua profiler stopped.", MESSAGE_COLOR_PURPLE)
+	elseif action == "dump" then
+		if Game.dumpLuaProfile(split[2]) then
+			player:sendColorMessage("Lua profile written.", MESSAGE_COLOR_PURPLE)
+		else
+			player:sendColorMessage("There is no Lua profile to write.", MESSAGE_COLOR_PURPLE)
+		end
+	elseif action == "timers" then
+		local counts = {}
+		for script, count in pairs(Game.getTimerEventCounts()) do
+			counts[#counts + 1] = {script = script, count = count}
+		end
+		table.sort(counts, function(a, b) return a.count > b.count end)
+
+		local message = "Pending addEvent timers:"
+		for i = 1, math.min(#counts, 10) do
+			message = string.format("%s\n%d %s", message, counts[i].count, counts[i].script)
+		end
+		player:popupFYI(message)
+	elseif action == "gc" then
+		local stats = Game.getLuaGcStats()
+		player:popupFYI(string.format("Lua heap: %d KB, %d KB at most\nCollector: %s%s\n%d steps, last one %d us, %d ms in total\n%d cycles, %d full collections under memory pressure",
+			stats.heap, stats.peakHeap, stats.paced and "paced by the dispatcher" or "run by the allocator", stats.generational and ", generational" or "",
+			stats.steps, stats.lastStepTime, stats.stepTime / 1000, stats.cycles, stats.fullCollections))
+	elseif action == "say" then
+		local iterations = tonumber(split[2]) or 100
+		local result = Game.benchmarkSayDispatch(iterations)
+		player:popupFYI(string.format("Say dispatch, %d texts %d times:\nlinear scan %d us\ntrie %d us\n%d mismatches",
+			result.samples, iterations, result.scanTime, result.trieTime, result.mismatches))
+	elseif action == "stats" then
+		Game.printStats()
+		player:sendColorMessage("Server statistics written to the console.", MESSAGE_COLOR_PURPLE)
+	elseif action == "area" then
+		if not benchmarkAreaApis then
+			dofile('data/lib/debugging/area_benchmark.lua')
+		end
+		local lines = benchmarkAreaApis(player:getPosition(), tonumber(split[2]), tonumber(split[3]))
+		player:popupFYI(table.concat(lines, "\n"))
+	else
+		player:sendColorMessage("Usage: /profiler on [sample interval], off, dump [path], timers, gc, say [iterations], area [radius] [iterations] or stats.", MESSAGE_COLOR_PURPLE)
+	end
+	return false
+end
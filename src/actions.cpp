@@ -44,10 +44,26 @@ void Actions::clear(bool fromLua)
 	clearMap(useItemMap, fromLua);
 	clearMap(uniqueItemMap, fromLua);
 	clearMap(actionItemMap, fromLua);
+	invalidateIndexes();
 
 	reInitState(fromLua);
 }
 
+void Actions::invalidateIndexes()
+{
+	useItemIndex.invalidate();
+	uniqueItemIndex.invalidate();
+	actionItemIndex.invalidate();
+}
+
+void Actions::buildIndexes()
+{
+	auto get = [](Action& action) { return &action; };
+	useItemIndex.build(useItemMap, get);
+	uniqueItemIndex.build(uniqueItemMap, get);
+	actionItemIndex.build(actionItemMap, get);
+}
+
 LuaScriptInterface& Actions::getScriptInterface()
 {
 	return scriptInterface;
@@ -73,7 +89,7 @@ bool Actions::registerEvent(Event_ptr event, const pugi::xml_node& node)
 
 	// event is guaranteed to be an Action
 	Action_ptr action{static_cast<Action*>(event.release())};
-	
+	invalidateIndexes();
 
 	pugi::xml_attribute attr;
 	if ((attr = node.attribute("itemid"))) {
@@ -203,6 +219,7 @@ bool Actions::registerLuaEvent(Action* event)
 	const std::string location = "Actions::registerLuaEvent";
 
 	Action_ptr action{ event };
+	invalidateIndexes();
 	if (!action->getItemIdRange().empty()) {
 		const auto& range = action->getItemIdRange();
 		for (auto id : range) {
@@ -284,23 +301,24 @@ ReturnValue Actions::canUseFar(const Creature* creature, const Position& toPos,
 
 Action* Actions::getAction(const Item* item)
 {
+	if (useItemIndex.isStale()) {
+		buildIndexes();
+	}
+
 	if (item->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID)) {
-		auto it = uniqueItemMap.find(item->getUniqueId());
-		if (it != uniqueItemMap.end()) {
-			return &it->second;
+		if (Action* action = uniqueItemIndex.find(item->getUniqueId())) {
+			return action;
 		}
 	}
 
 	if (item->hasAttribute(ITEM_ATTRIBUTE_ACTIONID)) {
-		auto it = actionItemMap.find(item->getActionId());
-		if (it != actionItemMap.end()) {
-			return &it->second;
+		if (Action* action = actionItemIndex.find(item->getActionId())) {
+			return action;
 		}
 	}
 
-	auto it = useItemMap.find(item->getID());
-	if (it != useItemMap.end()) {
-		return &it->second;
+	if (Action* action = useItemIndex.find(item->getID())) {
+		return action;
 	}
 
 	//rune items
@@ -597,7 +615,7 @@ bool Action::executeUse(Player* player, Item* item, const Position& fromPosition
 	scriptInterface->pushFunction(scriptId);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushThing(L, item);
 	LuaScriptInterface::pushPosition(L, fromPosition);
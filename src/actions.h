@@ -6,6 +6,7 @@
 
 #include "baseevents.h"
 #include "enums.h"
+#include "idlookup.h"
 #include "luascript.h"
 
 class Action;
@@ -127,8 +128,15 @@ class Actions final : public BaseEvents
 		ActionUseMap uniqueItemMap;
 		ActionUseMap actionItemMap;
 
+		// rebuilt from the maps above on the first use after they changed
+		IdLookupTable<Action> useItemIndex{true};
+		IdLookupTable<Action> uniqueItemIndex;
+		IdLookupTable<Action> actionItemIndex;
+
 		Action* getAction(const Item* item);
 		void clearMap(ActionUseMap& map, bool fromLua);
+		void invalidateIndexes();
+		void buildIndexes();
 
 		LuaScriptInterface scriptInterface;
 };
@@ -133,6 +133,7 @@ bool BedItem::sleep(Player* player)
 	BedItem* nextBedItem = getNextBedItem();
 
 	internalSetSleeper(player);
+	house->markDirty();
 
 	if (nextBedItem) {
 		nextBedItem->internalSetSleeper(player);
@@ -186,6 +187,7 @@ void BedItem::wakeUp(Player* player)
 
 	// unset sleep info
 	internalRemoveSleeper();
+	house->markDirty();
 
 	if (nextBedItem) {
 		nextBedItem->internalRemoveSleeper();
@@ -162,7 +162,7 @@ bool ChatChannel::executeCanJoinEvent(const Player& player)
 
 	scriptInterface->pushFunction(canJoinEvent);
 	LuaScriptInterface::pushUserdata(L, &player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -187,7 +187,7 @@ bool ChatChannel::executeOnJoinEvent(const Player& player)
 
 	scriptInterface->pushFunction(onJoinEvent);
 	LuaScriptInterface::pushUserdata(L, &player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -212,7 +212,7 @@ bool ChatChannel::executeOnLeaveEvent(const Player& player)
 
 	scriptInterface->pushFunction(onLeaveEvent);
 	LuaScriptInterface::pushUserdata(L, &player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	return scriptInterface->callFunction(1);
 }
@@ -237,7 +237,7 @@ bool ChatChannel::executeOnSpeakEvent(const Player& player, MessageClasses& type
 
 	scriptInterface->pushFunction(onSpeakEvent);
 	LuaScriptInterface::pushUserdata(L, &player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, type);
 	LuaScriptInterface::pushString(L, message);
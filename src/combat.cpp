@@ -51,49 +51,81 @@ MatrixArea createArea(const std::vector<uint32_t>& vec, uint32_t rows)
 	return area;
 }
 
-std::vector<Tile*> getList(const MatrixArea& area, const Position& targetPos, const Direction dir)
+// area combat can nest through death and script events, each level gets its own buffers
+struct CombatScratch {
+	std::vector<Tile*> tiles;
+	std::vector<Creature*> creatures;
+	SpectatorVec spectators;
+	uint32_t maxX = 0;
+	uint32_t maxY = 0;
+};
+
+std::deque<CombatScratch> scratchPool;
+size_t scratchDepth = 0;
+
+class ScratchLease
 {
-	auto casterPos = getNextPosition(dir, targetPos);
+	public:
+		ScratchLease() {
+			if (scratchDepth == scratchPool.size()) {
+				scratchPool.emplace_back();
+			}
 
-	std::vector<Tile*> vec;
+			scratch = &scratchPool[scratchDepth++];
+			scratch->tiles.clear();
+			scratch->creatures.clear();
+			scratch->spectators.clear();
+			scratch->maxX = 0;
+			scratch->maxY = 0;
+		}
+		~ScratchLease() {
+			--scratchDepth;
+		}
 
-	auto center = area.getCenter();
+		// non-copyable
+		ScratchLease(const ScratchLease&) = delete;
+		ScratchLease& operator=(const ScratchLease&) = delete;
 
-	Position tmpPos(targetPos.x - center.first, targetPos.y - center.second, targetPos.z);
-	for (uint32_t row = 0; row < area.getRows(); ++row, ++tmpPos.y) {
-		for (uint32_t col = 0; col < area.getCols(); ++col, ++tmpPos.x) {
-			if (area(row, col)) {
-				if (g_game.isSightClear(casterPos, tmpPos, true)) {
-					Tile* tile = g_game.map.getTile(tmpPos);
-					if (!tile) {
-						tile = new StaticTile(tmpPos.x, tmpPos.y, tmpPos.z);
-						g_game.map.setTile(tmpPos, tile);
-					}
-					vec.push_back(tile);
-				}
-			}
+		CombatScratch& get() {
+			return *scratch;
 		}
-		tmpPos.x -= area.getCols();
+
+	private:
+		CombatScratch* scratch;
+};
+
+Tile* getOrCreateTile(const Position& pos)
+{
+	Tile* tile = g_game.map.getTile(pos);
+	if (!tile) {
+		tile = new StaticTile(pos.x, pos.y, pos.z);
+		g_game.map.setTile(pos, tile);
 	}
-	return vec;
+	return tile;
 }
 
-std::vector<Tile*> getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area)
+void getCombatArea(const Position& centerPos, const Position& targetPos, const AreaCombat* area, CombatScratch& scratch)
 {
 	if (targetPos.z >= MAP_MAX_LAYERS) {
-		return {};
+		return;
 	}
 
-	if (area) {
-		return getList(area->getArea(centerPos, targetPos), targetPos, getDirectionTo(targetPos, centerPos));
+	if (!area) {
+		scratch.tiles.push_back(getOrCreateTile(targetPos));
+		return;
 	}
 
-	Tile* tile = g_game.map.getTile(targetPos);
-	if (!tile) {
-		tile = new StaticTile(targetPos.x, targetPos.y, targetPos.z);
-		g_game.map.setTile(targetPos, tile);
+	const Position casterPos = getNextPosition(getDirectionTo(targetPos, centerPos), targetPos);
+	for (const auto& offset : area->getTemplate(centerPos, targetPos).offsets) {
+		Position tilePos(targetPos.x + offset.first, targetPos.y + offset.second, targetPos.z);
+		if (!g_game.isSightClear(casterPos, tilePos, true)) {
+			continue;
+		}
+
+		scratch.tiles.push_back(getOrCreateTile(tilePos));
+		scratch.maxX = std::max<uint32_t>(scratch.maxX, std::abs(offset.first));
+		scratch.maxY = std::max<uint32_t>(scratch.maxY, std::abs(offset.second));
 	}
-	return {tile};
 }
 
 }
@@ -630,7 +662,7 @@ void Combat::combatTileEffects(const SpectatorVec& spectators, Creature* caster,
 	}
 
 	if (params.impactEffect != CONST_ME_NONE) {
-		Game::addMagicEffect(spectators, tile->getPosition(), params.impactEffect);
+		g_game.addCombatMagicEffect(spectators, tile->getPosition(), params.impactEffect);
 	}
 }
 
@@ -738,34 +770,21 @@ void Combat::doCombat(Creature* caster, const Position& position) const
 		CombatDamage damage = getCombatDamage(caster, nullptr);
 		doAreaCombat(caster, position, area.get(), damage, params);
 	} else {
-		auto tiles = caster ? getCombatArea(caster->getPosition(), position, area.get()) : getCombatArea(position, position, area.get());
-
-		SpectatorVec spectators;
-		uint32_t maxX = 0;
-		uint32_t maxY = 0;
-
-		//calculate the max viewable range
-		for (Tile* tile : tiles) {
-			const Position& tilePos = tile->getPosition();
-
-			uint32_t diff = Position::getDistanceX(tilePos, position);
-			if (diff > maxX) {
-				maxX = diff;
-			}
+		ScratchLease lease;
+		CombatScratch& scratch = lease.get();
+		getCombatArea(caster ? caster->getPosition() : position, position, area.get(), scratch);
 
-			diff = Position::getDistanceY(tilePos, position);
-			if (diff > maxY) {
-				maxY = diff;
-			}
-		}
+		const int32_t rangeX = scratch.maxX + Map::maxViewportX;
+		const int32_t rangeY = scratch.maxY + Map::maxViewportY;
 
-		const int32_t rangeX = maxX + Map::maxViewportX;
-		const int32_t rangeY = maxY + Map::maxViewportY;
+		SpectatorVec& spectators = scratch.spectators;
 		g_game.map.getSpectators(spectators, position, true, true, rangeX, rangeX, rangeY, rangeY);
 
 		postCombatEffects(caster, position, params);
 
-		for (Tile* tile : tiles) {
+		g_game.beginCombatBatch(position, scratch.maxX, scratch.maxY);
+
+		for (Tile* tile : scratch.tiles) {
 			if (canDoCombat(caster, tile, params.aggressive) != RETURNVALUE_NOERROR) {
 				continue;
 			}
@@ -815,6 +834,8 @@ void Combat::doCombat(Creature* caster, const Position& position) const
 				}
 			}
 		}
+
+		g_game.endCombatBatch();
 	}
 }
 
@@ -931,7 +952,9 @@ void Combat::doTargetCombat(Creature* caster, Creature* target, CombatDamage& da
 
 void Combat::doAreaCombat(Creature* caster, const Position& position, const AreaCombat* area, CombatDamage& damage, const CombatParams& params)
 {
-	auto tiles = caster ? getCombatArea(caster->getPosition(), position, area) : getCombatArea(position, position, area);
+	ScratchLease lease;
+	CombatScratch& scratch = lease.get();
+	getCombatArea(caster ? caster->getPosition() : position, position, area, scratch);
 
 	Player* casterPlayer = caster ? caster->getPlayer() : nullptr;
 	int32_t criticalPrimary = 0;
@@ -963,36 +986,19 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 		}
 	}
 
-	uint32_t maxX = 0;
-	uint32_t maxY = 0;
-
-	//calculate the max viewable range
-	for (Tile* tile : tiles) {
-		const Position& tilePos = tile->getPosition();
-
-		uint32_t diff = Position::getDistanceX(tilePos, position);
-		if (diff > maxX) {
-			maxX = diff;
-		}
-
-		diff = Position::getDistanceY(tilePos, position);
-		if (diff > maxY) {
-			maxY = diff;
-		}
-	}
-
-	const int32_t rangeX = maxX + Map::maxViewportX;
-	const int32_t rangeY = maxY + Map::maxViewportY;
+	const int32_t rangeX = scratch.maxX + Map::maxViewportX;
+	const int32_t rangeY = scratch.maxY + Map::maxViewportY;
 
-	SpectatorVec spectators;
+	SpectatorVec& spectators = scratch.spectators;
 	g_game.map.getSpectators(spectators, position, true, true, rangeX, rangeX, rangeY, rangeY);
 
 	postCombatEffects(caster, position, params);
 
-	std::vector<Creature*> toDamageCreatures;
-	toDamageCreatures.reserve(100);
+	g_game.beginCombatBatch(position, scratch.maxX, scratch.maxY);
 
-	for (Tile* tile : tiles) {
+	std::vector<Creature*>& toDamageCreatures = scratch.creatures;
+
+	for (Tile* tile : scratch.tiles) {
 		if (canDoCombat(caster, tile, params.aggressive) != RETURNVALUE_NOERROR) {
 			continue;
 		}
@@ -1116,6 +1122,8 @@ void Combat::doAreaCombat(Creature* caster, const Position& position, const Area
 			params.targetCallback->onTargetCombat(caster, creature);
 		}
 	}
+
+	g_game.endCombatBatch();
 }
 
 //**********************************************************//
@@ -1139,7 +1147,7 @@ void ValueCallback::getMinMaxValues(Player* player, CombatDamage& damage) const
 	scriptInterface->pushFunction(scriptId);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	int parameters = 1;
 	switch (type) {
@@ -1328,7 +1336,7 @@ MatrixArea MatrixArea::rotate270() const {
 	return {{center.second, cols - center.first - 1}, cols, rows, std::move(newArr)};
 }
 
-const MatrixArea& AreaCombat::getArea(const Position& centerPos, const Position& targetPos) const {
+const AreaTemplate& AreaCombat::getTemplate(const Position& centerPos, const Position& targetPos) const {
 	int32_t dx = Position::getOffsetX(targetPos, centerPos);
 	int32_t dy = Position::getOffsetY(targetPos, centerPos);
 
@@ -1355,12 +1363,31 @@ const MatrixArea& AreaCombat::getArea(const Position& centerPos, const Position&
 		}
 	}
 
-	if (dir >= areas.size()) {
+	if (dir >= templates.size()) {
 		// this should not happen. it means we forgot to call setupArea.
-		static MatrixArea empty;
+		static AreaTemplate empty;
 		return empty;
 	}
-	return areas[dir];
+	return templates[dir];
+}
+
+void AreaCombat::setupTemplates()
+{
+	templates.resize(areas.size());
+	for (size_t dir = 0; dir < areas.size(); ++dir) {
+		const MatrixArea& area = areas[dir];
+		const auto& center = area.getCenter();
+
+		auto& offsets = templates[dir].offsets;
+		offsets.clear();
+		for (uint32_t row = 0; row < area.getRows(); ++row) {
+			for (uint32_t col = 0; col < area.getCols(); ++col) {
+				if (area(row, col)) {
+					offsets.emplace_back(static_cast<int32_t>(col - center.first), static_cast<int32_t>(row - center.second));
+				}
+			}
+		}
+	}
 }
 
 void AreaCombat::setupArea(const std::vector<uint32_t>& vec, uint32_t rows)
@@ -1374,6 +1401,7 @@ void AreaCombat::setupArea(const std::vector<uint32_t>& vec, uint32_t rows)
 	areas[DIRECTION_SOUTH] = area.rotate180();
 	areas[DIRECTION_WEST] = area.rotate270();
 	areas[DIRECTION_NORTH] = std::move(area);
+	setupTemplates();
 }
 
 void AreaCombat::setupArea(int32_t length, int32_t spread)
@@ -1494,6 +1522,7 @@ void AreaCombat::setupExtArea(const std::vector<uint32_t>& vec, uint32_t rows)
 	areas[DIRECTION_SOUTHWEST] = area.flip();
 	areas[DIRECTION_SOUTHEAST] = area.transpose();
 	areas[DIRECTION_NORTHWEST] = std::move(area);
+	setupTemplates();
 }
 
 //**********************************************************//
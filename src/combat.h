@@ -97,6 +97,11 @@ class MatrixArea
 		uint32_t rows = 0, cols = 0;
 };
 
+// tiles of an area relative to its target, resolved once per direction
+struct AreaTemplate {
+	std::vector<std::pair<int32_t, int32_t>> offsets;
+};
+
 class AreaCombat
 {
 	public:
@@ -105,10 +110,13 @@ class AreaCombat
 		void setupArea(int32_t radius);
 		void setupAreaRing(int32_t ring);
 		void setupExtArea(const std::vector<uint32_t>& vec, uint32_t rows);
-		const MatrixArea& getArea(const Position& centerPos, const Position& targetPos) const;
+		const AreaTemplate& getTemplate(const Position& centerPos, const Position& targetPos) const;
 
 	private:
+		void setupTemplates();
+
 		std::vector<MatrixArea> areas;
+		std::vector<AreaTemplate> templates;
 		bool hasExtArea = false;
 };
 
@@ -140,7 +140,7 @@ void Condition::serialize(PropWriteStream& propWriteStream)
 	propWriteStream.write<uint32_t>(id);
 
 	propWriteStream.write<uint8_t>(CONDITIONATTR_TICKS);
-	propWriteStream.write<uint32_t>(ticks);
+	propWriteStream.write<uint32_t>(getTicks());
 
 	propWriteStream.write<uint8_t>(CONDITIONATTR_ISBUFF);
 	propWriteStream.write<uint8_t>(isBuff);
@@ -155,9 +155,16 @@ void Condition::serialize(PropWriteStream& propWriteStream)
 void Condition::setTicks(int32_t newTicks)
 {
 	ticks = newTicks;
+	pendingTicks = 0;
 	endTime = ticks + OTSYS_TIME();
 }
 
+int32_t Condition::getNextTick() const
+{
+	// plain conditions only count down until they expire
+	return ticks == -1 ? std::numeric_limits<int32_t>::max() : ticks;
+}
+
 bool Condition::executeCondition(Creature*, int32_t interval)
 {
 	if (ticks == -1) {
@@ -1009,6 +1016,13 @@ bool ConditionRegeneration::executeCondition(Creature* creature, int32_t interva
 	return ConditionGeneric::executeCondition(creature, interval);
 }
 
+int32_t ConditionRegeneration::getNextTick() const
+{
+	int32_t nextHealthTick = healthTicks - std::min(healthTicks, internalHealthTicks);
+	int32_t nextManaTick = manaTicks - std::min(manaTicks, internalManaTicks);
+	return std::min({ConditionGeneric::getNextTick(), nextHealthTick, nextManaTick});
+}
+
 bool ConditionRegeneration::setParam(ConditionParam_t param, int32_t value)
 {
 	bool ret = ConditionGeneric::setParam(param, value);
@@ -1104,6 +1118,11 @@ bool ConditionSoul::executeCondition(Creature* creature, int32_t interval)
 	return ConditionGeneric::executeCondition(creature, interval);
 }
 
+int32_t ConditionSoul::getNextTick() const
+{
+	return std::min<int32_t>(ConditionGeneric::getNextTick(), soulTicks - std::min(soulTicks, internalSoulTicks));
+}
+
 bool ConditionSoul::setParam(ConditionParam_t param, int32_t value)
 {
 	bool ret = ConditionGeneric::setParam(param, value);
@@ -1383,7 +1402,7 @@ bool ConditionDamage::executeCondition(Creature* creature, int32_t interval)
 			int32_t damage = damageInfo.value;
 
 			if (bRemove) {
-				damageList.pop_front();
+				damageList.erase(damageList.begin());
 			} else {
 				damageInfo.timeLeft = damageInfo.interval;
 			}
@@ -1403,6 +1422,16 @@ bool ConditionDamage::executeCondition(Creature* creature, int32_t interval)
 	return Condition::executeCondition(creature, interval);
 }
 
+int32_t ConditionDamage::getNextTick() const
+{
+	if (periodDamage != 0) {
+		return std::min<int32_t>(Condition::getNextTick(), tickInterval - std::min(tickInterval, periodDamageTick));
+	}
+
+	// standing on a matching field changes how the damage ticks, so that is checked every think
+	return 0;
+}
+
 bool ConditionDamage::getNextDamage(int32_t& damage)
 {
 	if (periodDamage != 0) {
@@ -1412,7 +1441,7 @@ bool ConditionDamage::getNextDamage(int32_t& damage)
 		IntervalInfo& damageInfo = damageList.front();
 		damage = damageInfo.value;
 		if (ticks != -1) {
-			damageList.pop_front();
+			damageList.erase(damageList.begin());
 		}
 		return true;
 	}
@@ -1832,6 +1861,14 @@ bool ConditionLight::startCondition(Creature* creature)
 	return true;
 }
 
+int32_t ConditionLight::getNextTick() const
+{
+	if (lightInfo.level == 0) {
+		return Condition::getNextTick();
+	}
+	return std::min<int32_t>(Condition::getNextTick(), lightChangeInterval - std::min(lightChangeInterval, internalLightTicks));
+}
+
 bool ConditionLight::executeCondition(Creature* creature, int32_t interval)
 {
 	internalLightTicks += interval;
@@ -84,9 +84,21 @@ class Condition
 			return endTime;
 		}
 		int32_t getTicks() const {
-			return ticks;
+			return ticks == -1 ? -1 : std::max<int32_t>(0, ticks - pendingTicks);
 		}
 		void setTicks(int32_t newTicks);
+
+		// the creature skips executeCondition until this much think time has passed
+		virtual int32_t getNextTick() const;
+		bool addPendingTicks(int32_t interval) {
+			pendingTicks += interval;
+			return pendingTicks >= getNextTick();
+		}
+		int32_t takePendingTicks() {
+			int32_t interval = pendingTicks;
+			pendingTicks = 0;
+			return interval;
+		}
 		bool isAggressive() const {
 			return aggressive;
 		}
@@ -110,6 +122,7 @@ class Condition
 		int64_t endTime;
 		uint32_t subId;
 		int32_t ticks;
+		int32_t pendingTicks = 0;
 		ConditionType_t conditionType;
 		uint32_t icons = 0;
 		bool isBuff;
@@ -184,6 +197,7 @@ class ConditionRegeneration final : public ConditionGeneric
 
 		void addCondition(Creature* creature, const Condition* condition) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		int32_t getNextTick() const override;
 
 		bool setParam(ConditionParam_t param, int32_t value) override;
 		int32_t getParam(ConditionParam_t param) override;
@@ -214,6 +228,7 @@ class ConditionSoul final : public ConditionGeneric
 
 		void addCondition(Creature* creature, const Condition* condition) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		int32_t getNextTick() const override;
 
 		bool setParam(ConditionParam_t param, int32_t value) override;
 		int32_t getParam(ConditionParam_t param) override;
@@ -257,6 +272,7 @@ class ConditionDamage final : public Condition
 
 		bool startCondition(Creature* creature) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		int32_t getNextTick() const override;
 		void endCondition(Creature* creature) override;
 		void addCondition(Creature* creature, const Condition* condition) override;
 		uint32_t getIcons() const override;
@@ -298,7 +314,7 @@ class ConditionDamage final : public Condition
 
 		bool init();
 
-		std::list<IntervalInfo> damageList;
+		std::vector<IntervalInfo> damageList;
 
 		bool getNextDamage(int32_t& damage);
 		bool doDamage(Creature* creature, int32_t healthChange);
@@ -374,6 +390,7 @@ class ConditionLight final : public Condition
 
 		bool startCondition(Creature* creature) override;
 		bool executeCondition(Creature* creature, int32_t interval) override;
+		int32_t getNextTick() const override;
 		void endCondition(Creature* creature) override;
 		void addCondition(Creature* creature, const Condition* condition) override;
 
@@ -168,6 +168,7 @@ bool ConfigManager::load(bool isReload)
 	if (!loaded) { //info that must be loaded one time (unless we reset the modules involved)
 		boolean[BIND_ONLY_GLOBAL_ADDRESS] = getGlobalBoolean(L, "bindOnlyGlobalAddress", false);
 		boolean[OPTIMIZE_DATABASE] = getGlobalBoolean(L, "startupDatabaseOptimization", true);
+		boolean[COMPACT_ITEM_STORAGE] = getGlobalBoolean(L, "compactItemStorage", false);
 
 		if (string[IP] == "") {
 			string[IP] = getGlobalString(L, "ip", "127.0.0.1");
@@ -184,6 +185,11 @@ bool ConfigManager::load(bool isReload)
 
 		integer[SQL_PORT] = getGlobalNumber(L, "mysqlPort", 3306);
 
+		string[JOURNAL_FILE] = getGlobalString(L, "journalFile", "");
+		integer[JOURNAL_SYNC_INTERVAL] = getGlobalNumber(L, "journalSyncInterval", 200);
+		integer[WORKER_THREADS] = getGlobalNumber(L, "workerThreads", 0);
+		integer[SCRIPT_SHARDS] = getGlobalNumber(L, "scriptShards", 0);
+
 		if (integer[GAME_PORT] == 0) {
 			integer[GAME_PORT] = getGlobalNumber(L, "gameProtocolPort", 7172);
 		}
@@ -214,6 +220,9 @@ bool ConfigManager::load(bool isReload)
 	boolean[STAMINA_SYSTEM] = getGlobalBoolean(L, "staminaSystem", true);
 	boolean[WARN_UNSAFE_SCRIPTS] = getGlobalBoolean(L, "warnUnsafeScripts", true);
 	boolean[CONVERT_UNSAFE_SCRIPTS] = getGlobalBoolean(L, "convertUnsafeScripts", true);
+	boolean[LUA_USERDATA_CACHE] = getGlobalBoolean(L, "luaUserdataCache", false);
+	boolean[LUA_PROFILER] = getGlobalBoolean(L, "luaProfiler", false);
+	boolean[LUA_GC_GENERATIONAL] = getGlobalBoolean(L, "luaGcGenerational", false);
 	boolean[CLASSIC_EQUIPMENT_SLOTS] = getGlobalBoolean(L, "classicEquipmentSlots", false);
 	boolean[CLASSIC_ATTACK_SPEED] = getGlobalBoolean(L, "classicAttackSpeed", false);
 	boolean[SCRIPTS_CONSOLE_LOGS] = getGlobalBoolean(L, "showScriptsLogInConsole", true);
@@ -248,12 +257,15 @@ bool ConfigManager::load(bool isReload)
 	string[LOCATION] = getGlobalString(L, "location", "");
 	string[MOTD] = getGlobalString(L, "motd", "");
 	string[WORLD_TYPE] = getGlobalString(L, "worldType", "pvp");
+	string[LUA_PROFILER_FILE] = getGlobalString(L, "luaProfilerFile", "data/logs/lua_profile");
+	string[LUA_BYTECODE_CACHE] = getGlobalString(L, "luaBytecodeCache", "");
 
 	integer[MAX_PLAYERS] = getGlobalNumber(L, "maxPlayers");
 	integer[PZ_LOCKED] = getGlobalNumber(L, "pzLocked", 60000);
 	integer[DEFAULT_DESPAWNRANGE] = Monster::despawnRange = getGlobalNumber(L, "deSpawnRange", 2);
 	integer[DEFAULT_DESPAWNRADIUS] = Monster::despawnRadius = getGlobalNumber(L, "deSpawnRadius", 50);
 	integer[DEFAULT_WALKTOSPAWNRADIUS] = getGlobalNumber(L, "walkToSpawnRadius", 15);
+	integer[PATH_SEARCH_BUDGET] = getGlobalNumber(L, "pathSearchBudget", 0);
 	integer[RATE_EXPERIENCE] = getGlobalNumber(L, "rateExp", 5);
 	integer[RATE_SKILL] = getGlobalNumber(L, "rateSkill", 3);
 	integer[RATE_LOOT] = getGlobalNumber(L, "rateLoot", 2);
@@ -288,6 +300,8 @@ bool ConfigManager::load(bool isReload)
 	integer[MIN_MARKET_FEE] = getGlobalNumber(L, "minMarketFee", 20);
 	integer[MAX_MARKET_FEE] = getGlobalNumber(L, "maxMarketFee", 100000);
 	integer[MAX_QUICK_LOOT_LIST_SIZE] = getGlobalNumber(L, "maxQuickLootListSize", 200);
+	integer[LUA_PROFILER_SAMPLE_INTERVAL] = getGlobalNumber(L, "luaProfilerSampleInterval", 0);
+	integer[LUA_GC_STEP_BUDGET] = getGlobalNumber(L, "luaGcStepBudget", 1000);
 
 	// config loaded successfully
 	console::printResult(CONSOLE_LOADING_OK);
@@ -56,6 +56,10 @@ class ConfigManager
 			UNLOCK_ALL_MOUNTS,
 			UNLOCK_ALL_FAMILIARS,
 			ALLOW_SPAWN_BLOCKING,
+			COMPACT_ITEM_STORAGE,
+			LUA_USERDATA_CACHE,
+			LUA_PROFILER,
+			LUA_GC_GENERATIONAL,
 
 			LAST_BOOLEAN_CONFIG /* this must be the last one */
 		};
@@ -76,9 +80,12 @@ class ConfigManager
 			MYSQL_PASS,
 			MYSQL_DB,
 			MYSQL_SOCK,
+			JOURNAL_FILE,
 			DEFAULT_PRIORITY,
 			MAP_AUTHOR,
 			CONFIG_FILE,
+			LUA_PROFILER_FILE,
+			LUA_BYTECODE_CACHE,
 
 			LAST_STRING_CONFIG /* this must be the last one */
 		};
@@ -128,6 +135,12 @@ class ConfigManager
 			MIN_MARKET_FEE,
 			MAX_MARKET_FEE,
 			MAX_QUICK_LOOT_LIST_SIZE,
+			JOURNAL_SYNC_INTERVAL,
+			PATH_SEARCH_BUDGET,
+			WORKER_THREADS,
+			LUA_PROFILER_SAMPLE_INTERVAL,
+			LUA_GC_STEP_BUDGET,
+			SCRIPT_SHARDS,
 
 			LAST_INTEGER_CONFIG /* this must be the last one */
 		};
@@ -23,6 +23,9 @@ extern ConfigManager g_config;
 extern CreatureEvents* g_creatureEvents;
 extern Events* g_events;
 
+// repaired follow paths drift away from the shortest one, search again after this many
+static constexpr uint8_t MAX_FOLLOW_PATH_REPAIRS = 8;
+
 Creature::Creature()
 {
 	onIdleStatus();
@@ -39,6 +42,8 @@ Creature::~Creature()
 		condition->endCondition(this);
 		delete condition;
 	}
+
+	LuaScriptInterface::removeCachedUserdata(this);
 }
 
 bool Creature::canSee(const Position& myPos, const Position& pos, int32_t viewRangeX, int32_t viewRangeY, bool sameFloor)
@@ -166,7 +171,6 @@ void Creature::onThink(uint32_t interval)
 	}
 
 	if (followCreature) {
-		forceUpdateFollowPath = false;
 		isUpdatingPath = true;
 	}
 
@@ -177,7 +181,7 @@ void Creature::onThink(uint32_t interval)
 
 	//scripting event - onThink
 	const CreatureEventList& thinkEvents = getCreatureEvents(CREATURE_EVENT_THINK);
-	for (CreatureEvent* thinkEvent : thinkEvents) {
+	for (CreatureEvent* thinkEvent : CreatureEventDispatch(this, thinkEvents)) {
 		thinkEvent->executeOnThink(this, interval);
 	}
 }
@@ -780,7 +784,7 @@ bool Creature::dropCorpse(Creature* lastHitCreature, Creature* mostDamageCreatur
 		if (master) {
 			//scripting event - onDeath
 			const CreatureEventList& deathEvents = getCreatureEvents(CREATURE_EVENT_DEATH);
-			for (CreatureEvent* deathEvent : deathEvents) {
+			for (CreatureEvent* deathEvent : CreatureEventDispatch(this, deathEvents)) {
 				deathEvent->executeOnDeath(this, nullptr, lastHitCreature, mostDamageCreature, lastHitUnjustified, mostDamageUnjustified);
 			}
 		}
@@ -820,7 +824,8 @@ bool Creature::dropCorpse(Creature* lastHitCreature, Creature* mostDamageCreatur
 		}
 
 		//scripting event - onDeath
-		for (CreatureEvent* deathEvent : getCreatureEvents(CREATURE_EVENT_DEATH)) {
+		const CreatureEventList& deathEvents = getCreatureEvents(CREATURE_EVENT_DEATH);
+		for (CreatureEvent* deathEvent : CreatureEventDispatch(this, deathEvents)) {
 			deathEvent->executeOnDeath(this, corpse, lastHitCreature, mostDamageCreature, lastHitUnjustified, mostDamageUnjustified);
 		}
 
@@ -1006,7 +1011,15 @@ void Creature::goToFollowCreature()
 				monster->getDistanceStep(followCreature->getPosition(), dir, true);
 			} else { // maxTargetDist > 1
 				if (!monster->getDistanceStep(followCreature->getPosition(), dir)) {
+					if (pathRequestPending || !g_game.reservePathSearch()) {
+						return;
+					}
+
 					// if we can't get anything then let the A* calculate
+					if (hasAsyncPathfinding() && requestFollowPath(fpp, false)) {
+						return;
+					}
+
 					listWalkDir.clear();
 					if (getPathTo(followCreature->getPosition(), listWalkDir, fpp)) {
 						hasFollowPath = true;
@@ -1025,22 +1038,148 @@ void Creature::goToFollowCreature()
 				hasFollowPath = true;
 				startAutoWalk();
 			}
+		} else if (repairFollowPath(fpp)) {
+			startAutoWalk();
 		} else {
-			listWalkDir.clear();
-			if (getPathTo(followCreature->getPosition(), listWalkDir, fpp)) {
-				hasFollowPath = true;
-				startAutoWalk();
-			} else {
-				hasFollowPath = false;
+			if (pathRequestPending) {
+				// the pending search completes the follow
+				return;
 			}
+
+			if (!g_game.reservePathSearch()) {
+				// keep walking the old path, the next think tries again
+				onFollowCreatureComplete(followCreature);
+				return;
+			}
+
+			if (hasAsyncPathfinding() && requestFollowPath(fpp, true)) {
+				return;
+			}
+
+			listWalkDir.clear();
+			setFollowPath(getPathTo(followCreature->getPosition(), listWalkDir, fpp));
 		}
 	}
 
 	onFollowCreatureComplete(followCreature);
 }
 
+bool Creature::requestFollowPath(const FindPathParams& fpp, bool completeFollow)
+{
+	const uint32_t generation = ++pathRequestGeneration;
+	auto onResult = [id = getID(), generation, startPos = getPosition(), completeFollow](bool found, std::vector<Direction>& dirList) {
+		Creature* creature = g_game.getCreatureByID(id);
+		if (!creature || creature->isRemoved() || creature->pathRequestGeneration != generation) {
+			return false;
+		}
+
+		creature->pathRequestPending = false;
+		if (!creature->followCreature || creature->getPosition() != startPos) {
+			// moved while the worker searched, the path starts somewhere else now
+			creature->forceUpdateFollowPath = true;
+			return false;
+		}
+
+		creature->listWalkDir = std::move(dirList);
+		creature->setFollowPath(found);
+		if (completeFollow) {
+			creature->onFollowCreatureComplete(creature->followCreature);
+		}
+		return true;
+	};
+
+	if (!g_game.map.getPathMatchingAsync(*this, followCreature->getPosition(), fpp, std::move(onResult))) {
+		return false;
+	}
+
+	pathRequestPending = true;
+	return true;
+}
+
+void Creature::setFollowPath(bool found)
+{
+	if (found) {
+		hasFollowPath = true;
+		followPathEnd = getPosition();
+		for (auto it = listWalkDir.rbegin(), end = listWalkDir.rend(); it != end; ++it) {
+			followPathEnd = getNextPosition(*it, followPathEnd);
+		}
+		startAutoWalk();
+	} else {
+		hasFollowPath = false;
+	}
+
+	forceUpdateFollowPath = false;
+	followPathRepairs = 0;
+}
+
+bool Creature::repairFollowPath(const FindPathParams& fpp)
+{
+	if (!hasFollowPath || forceUpdateFollowPath || fpp.maxTargetDist != 1 || followPathRepairs >= MAX_FOLLOW_PATH_REPAIRS) {
+		return false;
+	}
+
+	const Position& myPos = getPosition();
+	Position endPos = myPos;
+	for (auto it = listWalkDir.rbegin(), end = listWalkDir.rend(); it != end; ++it) {
+		endPos = getNextPosition(*it, endPos);
+	}
+
+	// pushed, teleported or drunk, the rest of the path starts somewhere else now
+	if (endPos != followPathEnd) {
+		return false;
+	}
+
+	const Position& targetPos = followCreature->getPosition();
+	FrozenPathingConditionCall pathCondition(targetPos);
+
+	int32_t bestMatch = 0;
+	if (!pathCondition(myPos, endPos, fpp, bestMatch)) {
+		// the target stepped away from where the path ends, one more step may reach it again
+		if (Position::getDistanceX(endPos, targetPos) > 2 || Position::getDistanceY(endPos, targetPos) > 2) {
+			return false;
+		}
+
+		static constexpr Direction directions[] = {
+			DIRECTION_NORTH, DIRECTION_EAST, DIRECTION_SOUTH, DIRECTION_WEST,
+			DIRECTION_SOUTHWEST, DIRECTION_SOUTHEAST, DIRECTION_NORTHWEST, DIRECTION_NORTHEAST
+		};
+
+		bool repaired = false;
+		for (Direction dir : directions) {
+			if (!fpp.allowDiagonal && (dir & DIRECTION_DIAGONAL_MASK)) {
+				break;
+			}
+
+			Position nextPos = getNextPosition(dir, endPos);
+			if (nextPos == myPos || !pathCondition(myPos, nextPos, fpp, bestMatch) || !g_game.map.canWalkTo(*this, nextPos)) {
+				continue;
+			}
+
+			listWalkDir.insert(listWalkDir.begin(), dir);
+			followPathEnd = nextPos;
+			repaired = true;
+			break;
+		}
+
+		if (!repaired) {
+			return false;
+		}
+	}
+
+	++followPathRepairs;
+	g_game.addFollowPathRepair();
+	return true;
+}
+
 bool Creature::setFollowCreature(Creature* creature)
 {
+	if (creature != followCreature) {
+		// a path searched towards the old target is of no use anymore
+		++pathRequestGeneration;
+		pathRequestPending = false;
+	}
+
 	if (creature) {
 		if (followCreature == creature) {
 			return true;
@@ -1196,7 +1335,7 @@ bool Creature::onKilledCreature(Creature* target, bool)
 
 	//scripting event - onKill
 	const CreatureEventList& killEvents = getCreatureEvents(CREATURE_EVENT_KILL);
-	for (CreatureEvent* killEvent : killEvents) {
+	for (CreatureEvent* killEvent : CreatureEventDispatch(this, killEvents)) {
 		killEvent->executeOnKill(this, target);
 	}
 	return false;
@@ -1287,6 +1426,7 @@ bool Creature::addCondition(Condition* condition, bool force/* = false*/)
 
 	if (condition->startCondition(this)) {
 		conditions.push_back(condition);
+		conditionTypes |= condition->getType();
 		onAddCondition(condition->getType());
 		return true;
 	}
@@ -1310,11 +1450,15 @@ bool Creature::addCombatCondition(Condition* condition)
 
 void Creature::removeCondition(ConditionType_t type, bool force/* = false*/)
 {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
-		Condition* condition = *it;
+	if (!(conditionTypes & type)) {
+		return;
+	}
+
+	size_t i = 0;
+	while (i < conditions.size()) {
+		Condition* condition = conditions[i];
 		if (condition->getType() != type) {
-			++it;
+			++i;
 			continue;
 		}
 
@@ -1326,7 +1470,8 @@ void Creature::removeCondition(ConditionType_t type, bool force/* = false*/)
 			}
 		}
 
-		it = conditions.erase(it);
+		conditions.erase(conditions.begin() + i);
+		updateConditionTypes();
 
 		condition->endCondition(this);
 		delete condition;
@@ -1337,11 +1482,15 @@ void Creature::removeCondition(ConditionType_t type, bool force/* = false*/)
 
 void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId, bool force/* = false*/)
 {
-	auto it = conditions.begin(), end = conditions.end();
-	while (it != end) {
-		Condition* condition = *it;
+	if (!(conditionTypes & type)) {
+		return;
+	}
+
+	size_t i = 0;
+	while (i < conditions.size()) {
+		Condition* condition = conditions[i];
 		if (condition->getType() != type || condition->getId() != conditionId) {
-			++it;
+			++i;
 			continue;
 		}
 
@@ -1353,7 +1502,8 @@ void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId,
 			}
 		}
 
-		it = conditions.erase(it);
+		conditions.erase(conditions.begin() + i);
+		updateConditionTypes();
 
 		condition->endCondition(this);
 		delete condition;
@@ -1392,6 +1542,7 @@ void Creature::removeCondition(Condition* condition, bool force/* = false*/)
 	}
 
 	conditions.erase(it);
+	updateConditionTypes();
 
 	condition->endCondition(this);
 	onEndCondition(condition->getType());
@@ -1400,6 +1551,10 @@ void Creature::removeCondition(Condition* condition, bool force/* = false*/)
 
 Condition* Creature::getCondition(ConditionType_t type) const
 {
+	if (!(conditionTypes & type)) {
+		return nullptr;
+	}
+
 	for (Condition* condition : conditions) {
 		if (condition->getType() == type) {
 			return condition;
@@ -1410,6 +1565,10 @@ Condition* Creature::getCondition(ConditionType_t type) const
 
 Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionId, uint32_t subId/* = 0*/) const
 {
+	if (!(conditionTypes & type)) {
+		return nullptr;
+	}
+
 	for (Condition* condition : conditions) {
 		if (condition->getType() == type && condition->getId() == conditionId && condition->getSubId() == subId) {
 			return condition;
@@ -1420,28 +1579,40 @@ Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionI
 
 void Creature::executeConditions(uint32_t interval)
 {
-	ConditionList tempConditions{ conditions };
-	for (Condition* condition : tempConditions) {
+	// scratch space reused by every creature, conditions executing scripts may get here again for another one
+	thread_local std::vector<Condition*> dueConditions;
+	const size_t first = dueConditions.size();
+	for (Condition* condition : conditions) {
+		if (condition->addPendingTicks(interval)) {
+			dueConditions.push_back(condition);
+		}
+	}
+
+	for (size_t i = first; i < dueConditions.size(); ++i) {
+		Condition* condition = dueConditions[i];
 		auto it = std::find(conditions.begin(), conditions.end(), condition);
 		if (it == conditions.end()) {
 			continue;
 		}
 
-		if (!condition->executeCondition(this, interval)) {
+		if (!condition->executeCondition(this, condition->takePendingTicks())) {
 			it = std::find(conditions.begin(), conditions.end(), condition);
 			if (it != conditions.end()) {
 				conditions.erase(it);
+				updateConditionTypes();
+
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
 			}
 		}
 	}
+	dueConditions.resize(first);
 }
 
 bool Creature::hasCondition(ConditionType_t type, uint32_t subId/* = 0*/) const
 {
-	if (isSuppress(type)) {
+	if (!(conditionTypes & type) || isSuppress(type)) {
 		return false;
 	}
 
@@ -1458,6 +1629,14 @@ bool Creature::hasCondition(ConditionType_t type, uint32_t subId/* = 0*/) const
 	return false;
 }
 
+void Creature::updateConditionTypes()
+{
+	conditionTypes = 0;
+	for (Condition* condition : conditions) {
+		conditionTypes |= condition->getType();
+	}
+}
+
 bool Creature::isImmune(CombatType_t type) const
 {
 	return hasBitSet(static_cast<uint32_t>(type), getDamageImmunities());
@@ -1563,18 +1742,19 @@ bool Creature::registerCreatureEvent(const std::string& name)
 		return false;
 	}
 
+	if (!eventLists) {
+		eventLists.reset(new std::array<CreatureEventList, CREATURE_EVENT_TYPES>());
+		eventListsVersion = g_creatureEvents->getVersion();
+	}
+
 	CreatureEventType_t type = event->getEventType();
-	if (hasEventRegistered(type)) {
-		for (CreatureEvent* creatureEvent : eventsList) {
-			if (creatureEvent == event) {
-				return false;
-			}
-		}
-	} else {
-		scriptEventsBitField |= static_cast<uint32_t>(1) << type;
+	CreatureEventList& events = (*eventLists)[type];
+	if (std::find(events.begin(), events.end(), event) != events.end()) {
+		return false;
 	}
 
-	eventsList.push_back(event);
+	events.push_back(event);
+	scriptEventsBitField |= static_cast<uint32_t>(1) << type;
 	return true;
 }
 
@@ -1590,47 +1770,62 @@ bool Creature::unregisterCreatureEvent(const std::string& name)
 		return false;
 	}
 
-	bool resetTypeBit = true;
-
-	auto it = eventsList.begin(), end = eventsList.end();
-	while (it != end) {
-		CreatureEvent* curEvent = *it;
-		if (curEvent == event) {
-			it = eventsList.erase(it);
-			continue;
-		}
-
-		if (curEvent->getEventType() == type) {
-			resetTypeBit = false;
+	CreatureEventList& events = (*eventLists)[type];
+	auto it = std::find(events.begin(), events.end(), event);
+	if (it != events.end()) {
+		*it = nullptr;
+		hasUnregisteredEvents = true;
+		if (eventDispatchDepth == 0) {
+			removeUnregisteredEvents();
 		}
-		++it;
-	}
-
-	if (resetTypeBit) {
-		scriptEventsBitField &= ~(static_cast<uint32_t>(1) << type);
 	}
 	return true;
 }
 
-CreatureEventList Creature::getCreatureEvents(CreatureEventType_t type)
+const CreatureEventList& Creature::getCreatureEvents(CreatureEventType_t type)
 {
-	CreatureEventList tmpEventList;
-
+	static const CreatureEventList emptyList;
 	if (!hasEventRegistered(type)) {
-		return tmpEventList;
+		return emptyList;
 	}
 
-	for (CreatureEvent* creatureEvent : eventsList) {
-		if (!creatureEvent->isLoaded()) {
-			continue;
+	// a reload left events behind that did not come back
+	if (eventListsVersion != g_creatureEvents->getVersion()) {
+		removeUnloadedEvents();
+		if (!hasEventRegistered(type)) {
+			return emptyList;
 		}
+	}
+	return (*eventLists)[type];
+}
 
-		if (creatureEvent->getEventType() == type) {
-			tmpEventList.push_back(creatureEvent);
+void Creature::removeUnloadedEvents()
+{
+	for (CreatureEventList& events : *eventLists) {
+		for (CreatureEvent*& event : events) {
+			if (event && !event->isLoaded()) {
+				event = nullptr;
+				hasUnregisteredEvents = true;
+			}
 		}
 	}
+	eventListsVersion = g_creatureEvents->getVersion();
 
-	return tmpEventList;
+	if (hasUnregisteredEvents && eventDispatchDepth == 0) {
+		removeUnregisteredEvents();
+	}
+}
+
+void Creature::removeUnregisteredEvents()
+{
+	for (size_t type = 0; type < CREATURE_EVENT_TYPES; ++type) {
+		CreatureEventList& events = (*eventLists)[type];
+		events.erase(std::remove(events.begin(), events.end(), nullptr), events.end());
+		if (events.empty()) {
+			scriptEventsBitField &= ~(static_cast<uint32_t>(1) << type);
+		}
+	}
+	hasUnregisteredEvents = false;
 }
 
 bool FrozenPathingConditionCall::isInRange(const Position& startPos, const Position& testPos,
@@ -1691,6 +1886,11 @@ bool FrozenPathingConditionCall::operator()(const Position& startPos, const Posi
 		return false;
 	}
 
+	return isInDistance(testPos, fpp, bestMatchDist);
+}
+
+bool FrozenPathingConditionCall::isInDistance(const Position& testPos, const FindPathParams& fpp, int32_t& bestMatchDist) const
+{
 	int32_t testDist = !fpp.summonFollowMode ? std::max<int32_t>(Position::getDistanceX(targetPos, testPos), Position::getDistanceY(targetPos, testPos)) : Position::getDistanceX(targetPos, testPos) + Position::getDistanceY(targetPos, testPos);
 	if (fpp.maxTargetDist == 1) {
 		if (testDist < fpp.minTargetDist || testDist > fpp.maxTargetDist) {
@@ -1717,9 +1917,7 @@ bool FrozenPathingConditionCall::operator()(const Position& startPos, const Posi
 
 bool Creature::isInvisible() const
 {
-	return std::find_if(conditions.begin(), conditions.end(), [] (const Condition* condition) {
-		return condition->getType() == CONDITION_INVISIBLE;
-	}) != conditions.end();
+	return (conditionTypes & CONDITION_INVISIBLE) != 0;
 }
 
 bool Creature::getPathTo(const Position& targetPos, std::vector<Direction>& dirList, const FindPathParams& fpp) const
@@ -18,8 +18,8 @@ class Monster;
 class Npc;
 class Player;
 
-using ConditionList = std::list<Condition*>;
-using CreatureEventList = std::list<CreatureEvent*>;
+using ConditionList = std::vector<Condition*>;
+using CreatureEventList = std::vector<CreatureEvent*>;
 
 enum slots_t : uint8_t {
 	CONST_SLOT_WHEREEVER = 0,
@@ -67,6 +67,8 @@ class FrozenPathingConditionCall
 
 		bool isInRange(const Position& startPos, const Position& testPos,
 		               const FindPathParams& fpp) const;
+		// the distance part of operator(), without the sight check
+		bool isInDistance(const Position& testPos, const FindPathParams& fpp, int32_t& bestMatchDist) const;
 
 	private:
 		Position targetPos;
@@ -555,8 +557,10 @@ class Creature : virtual public Thing
 		AssistMap assistMap;
 
 		std::list<Creature*> summons;
-		CreatureEventList eventsList;
+		// registered script events by type, only allocated for creatures that register any
+		std::unique_ptr<std::array<CreatureEventList, CREATURE_EVENT_TYPES>> eventLists;
 		ConditionList conditions;
+		uint32_t conditionTypes = 0;
 
 		std::vector<Direction> listWalkDir;
 		std::map<CreatureIcon_t, uint16_t> creatureIcons;
@@ -572,21 +576,26 @@ class Creature : virtual public Thing
 		uint32_t referenceCounter = 0;
 		uint32_t id = 0;
 		uint32_t scriptEventsBitField = 0;
+		uint32_t eventListsVersion = 0;
+		uint32_t eventDispatchDepth = 0;
 		uint32_t eventWalk = 0;
 		uint32_t lastHitCreatureId = 0;
 		uint32_t blockCount = 0;
 		uint32_t blockTicks = 0;
 		uint32_t lastStepCost = 1;
 		uint32_t baseSpeed = 220;
+		uint32_t pathRequestGeneration = 0;
 		int32_t varSpeed = 0;
 		int32_t health = 1000;
 		int32_t healthMax = 1000;
 		uint8_t drunkenness = 0;
+		uint8_t followPathRepairs = 0;
 
 		Outfit_t currentOutfit;
 		Outfit_t defaultOutfit;
 
 		Position lastPosition;
+		Position followPathEnd;
 		LightInfo internalLight;
 
 		Direction direction = DIRECTION_SOUTH;
@@ -598,26 +607,33 @@ class Creature : virtual public Thing
 		bool isUpdatingPath = false;
 		bool creatureCheck = false;
 		bool inCheckCreaturesVector = false;
+		bool creatureAsleep = false;
 		bool skillLoss = true;
 		bool lootDrop = true;
 		bool cancelNextWalk = false;
 		bool hasFollowPath = false;
 		bool forceUpdateFollowPath = false;
+		bool pathRequestPending = false;
 		bool hiddenHealth = false;
 		bool canUseDefense = true;
 		bool movementBlocked = false;
 		bool phantomMode = false;
+		bool hasUnregisteredEvents = false;
 
 		//creature script events
 		bool hasEventRegistered(CreatureEventType_t event) const {
 			return (0 != (scriptEventsBitField & (static_cast<uint32_t>(1) << event)));
 		}
-		CreatureEventList getCreatureEvents(CreatureEventType_t type);
+		// dispatch through CreatureEventDispatch, unregistered events are left as nullptr until it is done
+		const CreatureEventList& getCreatureEvents(CreatureEventType_t type);
+		void removeUnloadedEvents();
+		void removeUnregisteredEvents();
 
 		void updateMapCache();
 		void updateTileCache(const Tile* tile, int32_t dx, int32_t dy);
 		void updateTileCache(const Tile* tile, const Position& pos);
 		void onCreatureDisappear(const Creature* creature, bool isLogout);
+		void updateConditionTypes();
 		virtual void doAttacking(uint32_t) {}
 		virtual bool hasExtraSwing() {
 			return false;
@@ -631,6 +647,12 @@ class Creature : virtual public Thing
 			return 0;
 		}
 		virtual void getPathSearchParams(const Creature* creature, FindPathParams& fpp) const;
+		virtual bool hasAsyncPathfinding() const {
+			return false;
+		}
+		bool repairFollowPath(const FindPathParams& fpp);
+		bool requestFollowPath(const FindPathParams& fpp, bool completeFollow);
+		void setFollowPath(bool found);
 		virtual void death(Creature*) {}
 		virtual bool dropCorpse(Creature* lastHitCreature, Creature* mostDamageCreature, bool lastHitUnjustified, bool mostDamageUnjustified);
 		virtual Item* getCorpse(Creature* lastHitCreature, Creature* mostDamageCreature);
@@ -638,6 +660,70 @@ class Creature : virtual public Thing
 		friend class Game;
 		friend class Map;
 		friend class LuaScriptInterface;
+		friend class CreatureEventDispatch;
+};
+
+// iterates the events of a list registered when the dispatch started, handlers may (un)register events meanwhile
+class CreatureEventDispatch
+{
+	public:
+		class Iterator
+		{
+			public:
+				Iterator(const CreatureEventList& events, size_t index, size_t end) : events(events), index(index), end(end) {
+					skipUnregistered();
+				}
+
+				CreatureEvent* operator*() const {
+					return events[index];
+				}
+
+				Iterator& operator++() {
+					++index;
+					skipUnregistered();
+					return *this;
+				}
+
+				bool operator!=(const Iterator& other) const {
+					return index != other.index;
+				}
+
+			private:
+				void skipUnregistered() {
+					while (index < end && !events[index]) {
+						++index;
+					}
+				}
+
+				const CreatureEventList& events;
+				size_t index;
+				size_t end;
+		};
+
+		CreatureEventDispatch(Creature* creature, const CreatureEventList& events) : creature(creature), events(events), size(events.size()) {
+			++creature->eventDispatchDepth;
+		}
+		~CreatureEventDispatch() {
+			if (--creature->eventDispatchDepth == 0 && creature->hasUnregisteredEvents) {
+				creature->removeUnregisteredEvents();
+			}
+		}
+
+		// non-copyable
+		CreatureEventDispatch(const CreatureEventDispatch&) = delete;
+		CreatureEventDispatch& operator=(const CreatureEventDispatch&) = delete;
+
+		Iterator begin() const {
+			return Iterator(events, 0, size);
+		}
+		Iterator end() const {
+			return Iterator(events, size, size);
+		}
+
+	private:
+		Creature* creature;
+		const CreatureEventList& events;
+		size_t size;
 };
 
 #endif
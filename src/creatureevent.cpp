@@ -22,16 +22,20 @@ void CreatureEvents::clear(bool fromLua)
 		}
 	}
 
+	++version;
 	reInitState(fromLua);
 }
 
 void CreatureEvents::removeInvalidEvents()
 {
-	for (auto it = creatureEvents.begin(); it != creatureEvents.end(); ++it) {
+	for (auto it = creatureEvents.begin(); it != creatureEvents.end();) {
 		if (it->second.getScriptId() == 0) {
-			creatureEvents.erase(it->second.getName());
+			it = creatureEvents.erase(it);
+		} else {
+			++it;
 		}
 	}
+	++version;
 }
 
 LuaScriptInterface& CreatureEvents::getScriptInterface()
@@ -66,12 +70,14 @@ bool CreatureEvents::registerEvent(Event_ptr event, const pugi::xml_node&)
 		//(happens when reloading), it is reused
 		if (!oldEvent->isLoaded() && oldEvent->getEventType() == creatureEvent->getEventType()) {
 			oldEvent->copyEvent(creatureEvent.get());
+			++version;
 		}
 		return false;
 	}
 
 	// if not, register it normally
 	creatureEvents.emplace(creatureEvent->getName(), std::move(*creatureEvent));
+	++version;
 	return true;
 }
 
@@ -89,12 +95,14 @@ bool CreatureEvents::registerLuaEvent(CreatureEvent* event)
 		//(happens when reloading), it is reused
 		if (!oldEvent->isLoaded() && oldEvent->getEventType() == creatureEvent->getEventType()) {
 			oldEvent->copyEvent(creatureEvent.get());
+			++version;
 		}
 		return false;
 	}
 
 	// if not, register it normally
 	creatureEvents.emplace(creatureEvent->getName(), std::move(*creatureEvent));
+	++version;
 	return true;
 }
 
@@ -109,27 +117,40 @@ CreatureEvent* CreatureEvents::getEventByName(const std::string& name, bool forc
 	return nullptr;
 }
 
-bool CreatureEvents::playerLogin(Player* player) const
+const std::vector<CreatureEvent*>& CreatureEvents::getGlobalEvents(CreatureEventType_t type)
 {
-	//fire global event if is registered
-	for (const auto& it : creatureEvents) {
-		if (it.second.getEventType() == CREATURE_EVENT_LOGIN) {
-			if (!it.second.executeOnLogin(player)) {
-				return false;
+	if (globalEventsVersion != version) {
+		for (auto& events : globalEvents) {
+			events.clear();
+		}
+
+		for (auto& it : creatureEvents) {
+			if (it.second.isLoaded()) {
+				globalEvents[it.second.getEventType()].push_back(&it.second);
 			}
 		}
+		globalEventsVersion = version;
+	}
+	return globalEvents[type];
+}
+
+bool CreatureEvents::playerLogin(Player* player)
+{
+	//fire global event if is registered
+	for (const CreatureEvent* creatureEvent : getGlobalEvents(CREATURE_EVENT_LOGIN)) {
+		if (!creatureEvent->executeOnLogin(player)) {
+			return false;
+		}
 	}
 	return true;
 }
 
-bool CreatureEvents::playerLogout(Player* player) const
+bool CreatureEvents::playerLogout(Player* player)
 {
 	//fire global event if is registered
-	for (const auto& it : creatureEvents) {
-		if (it.second.getEventType() == CREATURE_EVENT_LOGOUT) {
-			if (!it.second.executeOnLogout(player)) {
-				return false;
-			}
+	for (const CreatureEvent* creatureEvent : getGlobalEvents(CREATURE_EVENT_LOGOUT)) {
+		if (!creatureEvent->executeOnLogout(player)) {
+			return false;
 		}
 	}
 	return true;
@@ -138,11 +159,9 @@ bool CreatureEvents::playerLogout(Player* player) const
 bool CreatureEvents::playerAdvance(Player* player, skills_t skill, uint32_t oldLevel,
                                        uint32_t newLevel)
 {
-	for (auto& it : creatureEvents) {
-		if (it.second.getEventType() == CREATURE_EVENT_ADVANCE) {
-			if (!it.second.executeAdvance(player, skill, oldLevel, newLevel)) {
-				return false;
-			}
+	for (CreatureEvent* creatureEvent : getGlobalEvents(CREATURE_EVENT_ADVANCE)) {
+		if (!creatureEvent->executeAdvance(player, skill, oldLevel, newLevel)) {
+			return false;
 		}
 	}
 	return true;
@@ -282,7 +301,7 @@ bool CreatureEvent::executeOnLogin(Player* player) const
 
 	scriptInterface->pushFunction(scriptId);
 	LuaScriptInterface::pushUserdata(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 	return scriptInterface->callFunction(1);
 }
 
@@ -301,7 +320,7 @@ bool CreatureEvent::executeOnLogout(Player* player) const
 
 	scriptInterface->pushFunction(scriptId);
 	LuaScriptInterface::pushUserdata(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 	return scriptInterface->callFunction(1);
 }
 
@@ -409,7 +428,7 @@ bool CreatureEvent::executeAdvance(Player* player, skills_t skill, uint32_t oldL
 
 	scriptInterface->pushFunction(scriptId);
 	LuaScriptInterface::pushUserdata(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 	lua_pushnumber(L, static_cast<uint32_t>(skill));
 	lua_pushnumber(L, oldLevel);
 	lua_pushnumber(L, newLevel);
@@ -453,7 +472,7 @@ void CreatureEvent::executeModalWindow(Player* player, uint32_t modalWindowId, u
 	scriptInterface->pushFunction(scriptId);
 
 	LuaScriptInterface::pushUserdata(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, modalWindowId);
 	lua_pushnumber(L, buttonId);
@@ -477,7 +496,7 @@ bool CreatureEvent::executeTextEdit(Player* player, Item* item, const std::strin
 	scriptInterface->pushFunction(scriptId);
 
 	LuaScriptInterface::pushUserdata(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushThing(L, item);
 	LuaScriptInterface::pushString(L, text);
@@ -578,7 +597,7 @@ void CreatureEvent::executeExtendedOpcode(Player* player, uint8_t opcode, const
 	scriptInterface->pushFunction(scriptId);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, opcode);
 	LuaScriptInterface::pushString(L, buffer);
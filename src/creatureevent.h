@@ -27,6 +27,8 @@ enum CreatureEventType_t {
 	CREATURE_EVENT_EXTENDED_OPCODE, // otclient additional network opcodes
 };
 
+static constexpr size_t CREATURE_EVENT_TYPES = CREATURE_EVENT_EXTENDED_OPCODE + 1;
+
 class CreatureEvent final : public Event
 {
 	public:
@@ -89,8 +91,8 @@ class CreatureEvents final : public BaseEvents
 		CreatureEvents& operator=(const CreatureEvents&) = delete;
 
 		// global events
-		bool playerLogin(Player* player) const;
-		bool playerLogout(Player* player) const;
+		bool playerLogin(Player* player);
+		bool playerLogout(Player* player);
 		bool playerAdvance(Player* player, skills_t, uint32_t, uint32_t);
 
 		CreatureEvent* getEventByName(const std::string& name, bool forceLoaded = true);
@@ -100,16 +102,28 @@ class CreatureEvents final : public BaseEvents
 
 		void removeInvalidEvents();
 
+		// changes whenever an event is added, removed or (re)loaded
+		uint32_t getVersion() const {
+			return version;
+		}
+
 	private:
 		LuaScriptInterface& getScriptInterface() override;
 		std::string getScriptBaseName() const override;
 		Event_ptr getEvent(const std::string& nodeName) override;
 		bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
 
+		// the loaded events of a type in name order, rebuilt once the version changed
+		const std::vector<CreatureEvent*>& getGlobalEvents(CreatureEventType_t type);
+
 		//creature events
 		using CreatureEventMap = std::map<std::string, CreatureEvent>;
 		CreatureEventMap creatureEvents;
 
+		std::array<std::vector<CreatureEvent*>, CREATURE_EVENT_TYPES> globalEvents;
+		uint32_t globalEventsVersion = 0;
+		uint32_t version = 1;
+
 		LuaScriptInterface scriptInterface;
 };
 
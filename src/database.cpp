@@ -48,16 +48,25 @@ bool Database::connect()
 
 bool Database::beginTransaction()
 {
+	databaseLock.lock();
+	if (capture) {
+		return true;
+	}
+
 	if (!executeQuery("BEGIN")) {
+		databaseLock.unlock();
 		return false;
 	}
-
-	databaseLock.lock();
 	return true;
 }
 
 bool Database::rollback()
 {
+	if (capture) {
+		databaseLock.unlock();
+		return true;
+	}
+
 	if (mysql_rollback(handle) != 0) {
 		console::reportError("mysql_rollback", mysql_error(handle));
 		databaseLock.unlock();
@@ -70,6 +79,11 @@ bool Database::rollback()
 
 bool Database::commit()
 {
+	if (capture) {
+		databaseLock.unlock();
+		return true;
+	}
+
 	if (mysql_commit(handle) != 0) {
 		console::reportError("mysql_commit", mysql_error(handle));
 		databaseLock.unlock();
@@ -87,6 +101,12 @@ bool Database::executeQuery(const std::string& query)
 	// executes the query
 	databaseLock.lock();
 
+	if (capture) {
+		capture->push_back(query);
+		databaseLock.unlock();
+		return true;
+	}
+
 	while (mysql_real_query(handle, query.c_str(), query.length()) != 0) {
 		console::reportError("mysql_real_query", fmt::format("Query: {:s}\nMessage: {:s}", query.substr(0, 256), mysql_error(handle)));
 		auto error = mysql_errno(handle);
@@ -107,6 +127,18 @@ bool Database::executeQuery(const std::string& query)
 	return success;
 }
 
+void Database::beginCapture(std::vector<std::string>& queries)
+{
+	databaseLock.lock();
+	capture = &queries;
+}
+
+void Database::endCapture()
+{
+	capture = nullptr;
+	databaseLock.unlock();
+}
+
 DBResult_ptr Database::storeQuery(const std::string& query)
 {
 	databaseLock.lock();
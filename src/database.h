@@ -99,6 +99,20 @@ class Database
 			return maxPacketSize;
 		}
 
+		/**
+		 * Collects the queries passed to executeQuery instead of running them.
+		 *
+		 * The connection stays locked for the calling thread until endCapture,
+		 * transactions begun in between only take part in the locking.
+		 *
+		 * @param queries receives the captured queries
+		 */
+		void beginCapture(std::vector<std::string>& queries);
+		void endCapture();
+		bool isCapturing() const {
+			return capture != nullptr;
+		}
+
 	private:
 		/**
 		 * Transaction related methods.
@@ -113,6 +127,7 @@ class Database
 
 		MYSQL* handle = nullptr;
 		std::recursive_mutex databaseLock;
+		std::vector<std::string>* capture = nullptr;
 		uint64_t maxPacketSize = 1048576;
 
 	friend class DBTransaction;
@@ -19,9 +19,7 @@ void DatabaseTasks::threadMain()
 	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
 	while (getState() != THREAD_STATE_TERMINATED) {
 		taskLockUnique.lock();
-		if (tasks.empty()) {
-			taskSignal.wait(taskLockUnique);
-		}
+		taskSignal.wait(taskLockUnique, [this]() { return !tasks.empty() || getState() == THREAD_STATE_TERMINATED; });
 
 		if (!tasks.empty()) {
 			DatabaseTask task = std::move(tasks.front());
@@ -41,6 +39,25 @@ void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr,
 	if (getState() == THREAD_STATE_RUNNING) {
 		signal = tasks.empty();
 		tasks.emplace_back(std::move(query), std::move(callback), store);
+	} else {
+		console::reportWarning("DatabaseTasks::addTask", fmt::format("The database thread is stopped, dropped query: {:s}", query));
+	}
+	taskLock.unlock();
+
+	if (signal) {
+		taskSignal.notify_one();
+	}
+}
+
+void DatabaseTasks::addJob(std::function<void(Database&)> job)
+{
+	bool signal = false;
+	taskLock.lock();
+	if (getState() == THREAD_STATE_RUNNING) {
+		signal = tasks.empty();
+		tasks.emplace_back(std::move(job));
+	} else {
+		console::reportWarning("DatabaseTasks::addJob", "The database thread is stopped, job dropped.");
 	}
 	taskLock.unlock();
 
@@ -51,6 +68,11 @@ void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr,
 
 void DatabaseTasks::runTask(const DatabaseTask& task)
 {
+	if (task.job) {
+		task.job(db);
+		return;
+	}
+
 	bool success;
 	DBResult_ptr result;
 	if (task.store) {
@@ -83,6 +105,10 @@ void DatabaseTasks::shutdown()
 	taskLock.lock();
 	setState(THREAD_STATE_TERMINATED);
 	taskLock.unlock();
-	flush();
 	taskSignal.notify_one();
+
+	// the task the thread is running must be done before the rest runs here,
+	// both use the same connection
+	join();
+	flush();
 }
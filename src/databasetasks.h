@@ -10,10 +10,12 @@
 struct DatabaseTask {
 	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store) :
 		query(std::move(query)), callback(std::move(callback)), store(store) {}
+	explicit DatabaseTask(std::function<void(Database&)>&& job) : job(std::move(job)) {}
 
 	std::string query;
 	std::function<void(DBResult_ptr, bool)> callback;
-	bool store;
+	std::function<void(Database&)> job;
+	bool store = false;
 };
 
 class DatabaseTasks : public ThreadHolder<DatabaseTasks>
@@ -25,6 +27,9 @@ class DatabaseTasks : public ThreadHolder<DatabaseTasks>
 		void shutdown();
 
 		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+		// runs an arbitrary sequence of queries on the database thread connection,
+		// the job is responsible for handing its results back to the dispatcher
+		void addJob(std::function<void(Database&)> job);
 
 		void threadMain();
 	private:
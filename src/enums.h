@@ -574,6 +574,7 @@ struct MarketOffer {
 
 struct MarketOfferEx {
 	MarketOfferEx() = default;
+	MarketOfferEx(const MarketOfferEx&) = default;
 	MarketOfferEx(MarketOfferEx&& other) :
 		id(other.id), playerId(other.playerId), timestamp(other.timestamp), price(other.price),
 		amount(other.amount), counter(other.counter), itemId(other.itemId), tier(other.tier), type(other.type),
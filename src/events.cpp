@@ -200,7 +200,7 @@ bool Events::eventMonsterOnSpawn(Monster* monster, const Position& position, boo
 	monster->setID();
 
 	LuaScriptInterface::pushUserdata<Monster>(L, monster);
-	LuaScriptInterface::setMetatable(L, -1, "Monster");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Monster);
 	LuaScriptInterface::pushPosition(L, position);
 	LuaScriptInterface::pushBoolean(L, startup);
 	LuaScriptInterface::pushBoolean(L, artificial);
@@ -261,7 +261,7 @@ ReturnValue Events::eventCreatureOnAreaCombat(Creature* creature, Tile* tile, bo
 	}
 
 	LuaScriptInterface::pushUserdata<Tile>(L, tile);
-	LuaScriptInterface::setMetatable(L, -1, "Tile");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Tile);
 
 	LuaScriptInterface::pushBoolean(L, aggressive);
 
@@ -419,7 +419,7 @@ bool Events::eventPartyOnJoin(Party* party, Player* player)
 	LuaScriptInterface::setMetatable(L, -1, "Party");
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	return scriptInterface.callFunction(2);
 }
@@ -446,7 +446,7 @@ bool Events::eventPartyOnLeave(Party* party, Player* player)
 	LuaScriptInterface::setMetatable(L, -1, "Party");
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	return scriptInterface.callFunction(2);
 }
@@ -528,7 +528,7 @@ bool Events::eventPlayerOnBrowseField(Player* player, const Position& position)
 	scriptInterface.pushFunction(info.playerOnBrowseField);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushPosition(L, position);
 
@@ -554,7 +554,7 @@ void Events::eventPlayerOnLook(Player* player, const Position& position, Thing*
 	scriptInterface.pushFunction(info.playerOnLook);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	if (Creature* creature = thing->getCreature()) {
 		LuaScriptInterface::pushUserdata<Creature>(L, creature);
@@ -591,7 +591,7 @@ void Events::eventPlayerOnLookInBattleList(Player* player, Creature* creature, i
 	scriptInterface.pushFunction(info.playerOnLookInBattleList);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Creature>(L, creature);
 	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
@@ -620,10 +620,10 @@ void Events::eventPlayerOnLookInTrade(Player* player, Player* partner, Item* ite
 	scriptInterface.pushFunction(info.playerOnLookInTrade);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Player>(L, partner);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -652,7 +652,7 @@ bool Events::eventPlayerOnLookInShop(Player* player, const ItemType* itemType, u
 	scriptInterface.pushFunction(info.playerOnLookInShop);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<const ItemType>(L, itemType);
 	LuaScriptInterface::setMetatable(L, -1, "ItemType");
@@ -660,7 +660,7 @@ bool Events::eventPlayerOnLookInShop(Player* player, const ItemType* itemType, u
 	lua_pushnumber(L, count);
 
 	LuaScriptInterface::pushUserdata<Npc>(L, npc);
-	LuaScriptInterface::setMetatable(L, -1, "Npc");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Npc);
 
 	return scriptInterface.callFunction(4);
 }
@@ -684,7 +684,7 @@ bool Events::eventPlayerOnLookInMarket(Player* player, const ItemType* itemType,
 	scriptInterface.pushFunction(info.playerOnLookInMarket);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<const ItemType>(L, itemType);
 	LuaScriptInterface::setMetatable(L, -1, "ItemType");
@@ -713,7 +713,7 @@ ReturnValue Events::eventPlayerOnMoveItem(Player* player, Item* item, uint16_t c
 	scriptInterface.pushFunction(info.playerOnMoveItem);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -757,7 +757,7 @@ void Events::eventPlayerOnItemMoved(Player* player, Item* item, uint16_t count,
 	scriptInterface.pushFunction(info.playerOnItemMoved);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	if (item) {
 		LuaScriptInterface::pushUserdata<Item>(L, item);
@@ -795,7 +795,7 @@ bool Events::eventPlayerOnMoveCreature(Player* player, Creature* creature, const
 	scriptInterface.pushFunction(info.playerOnMoveCreature);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Creature>(L, creature);
 	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
@@ -825,7 +825,7 @@ void Events::eventPlayerOnReportRuleViolation(Player* player, const std::string&
 	scriptInterface.pushFunction(info.playerOnReportRuleViolation);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushString(L, targetName);
 
@@ -857,7 +857,7 @@ bool Events::eventPlayerOnReportBug(Player* player, const std::string& message,
 	scriptInterface.pushFunction(info.playerOnReportBug);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushString(L, message);
 	LuaScriptInterface::pushPosition(L, position);
@@ -885,7 +885,7 @@ bool Events::eventPlayerOnTurn(Player* player, Direction direction)
 	scriptInterface.pushFunction(info.playerOnTurn);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, direction);
 
@@ -911,10 +911,10 @@ bool Events::eventPlayerOnTradeRequest(Player* player, Player* target, Item* ite
 	scriptInterface.pushFunction(info.playerOnTradeRequest);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Player>(L, target);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -941,10 +941,10 @@ bool Events::eventPlayerOnTradeAccept(Player* player, Player* target, Item* item
 	scriptInterface.pushFunction(info.playerOnTradeAccept);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Player>(L, target);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -974,10 +974,10 @@ void Events::eventPlayerOnTradeCompleted(Player* player, Player* target, Item* i
 	scriptInterface.pushFunction(info.playerOnTradeCompleted);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Player>(L, target);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -1009,7 +1009,7 @@ void Events::eventPlayerOnPodiumRequest(Player* player, Item* item)
 	scriptInterface.pushFunction(info.playerOnPodiumRequest);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -1036,7 +1036,7 @@ void Events::eventPlayerOnPodiumEdit(Player* player, Item* item, const Outfit_t&
 	scriptInterface.pushFunction(info.playerOnPodiumEdit);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -1069,7 +1069,7 @@ void Events::eventPlayerOnGainExperience(Player* player, Creature* source, uint6
 	scriptInterface.pushFunction(info.playerOnGainExperience);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	if (source) {
 		LuaScriptInterface::pushUserdata<Creature>(L, source);
@@ -1110,7 +1110,7 @@ void Events::eventPlayerOnLoseExperience(Player* player, uint64_t& exp)
 	scriptInterface.pushFunction(info.playerOnLoseExperience);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, exp);
 
@@ -1143,7 +1143,7 @@ void Events::eventPlayerOnGainSkillTries(Player* player, skills_t skill, uint64_
 	scriptInterface.pushFunction(info.playerOnGainSkillTries);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, skill);
 	lua_pushnumber(L, tries);
@@ -1177,7 +1177,7 @@ void Events::eventPlayerOnWrapItem(Player* player, Item* item)
 	scriptInterface.pushFunction(info.playerOnWrapItem);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -1204,7 +1204,7 @@ void Events::eventPlayerOnQuickLoot(Player* player, const Position& position, ui
 	scriptInterface.pushFunction(info.playerOnQuickLoot);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushPosition(L, position);
 	lua_pushnumber(L, stackPos);
@@ -1232,7 +1232,7 @@ void Events::eventPlayerOnInspectItem(Player* player, Item* item)
 	scriptInterface.pushFunction(info.playerOnInspectItem);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -1259,10 +1259,10 @@ void Events::eventPlayerOnInspectTradeItem(Player* player, Player* tradePartner,
 	scriptInterface.pushFunction(info.playerOnInspectTradeItem);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Player>(L, tradePartner);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -1289,10 +1289,10 @@ void Events::eventPlayerOnInspectNpcTradeItem(Player* player, Npc* npc, uint16_t
 	scriptInterface.pushFunction(info.playerOnInspectNpcTradeItem);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Npc>(L, npc);
-	LuaScriptInterface::setMetatable(L, -1, "Npc");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Npc);
 
 	lua_pushnumber(L, itemId);
 
@@ -1318,7 +1318,7 @@ void Events::eventPlayerOnInspectCyclopediaItem(Player* player, uint16_t itemId)
 	scriptInterface.pushFunction(info.playerOnInspectCyclopediaItem);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, itemId);
 
@@ -1344,7 +1344,7 @@ void Events::eventPlayerOnMinimapQuery(Player* player, const Position& position)
 	scriptInterface.pushFunction(info.playerOnMinimapQuery);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushPosition(L, position);
 
@@ -1370,7 +1370,7 @@ void Events::eventPlayerOnInventoryUpdate(Player* player, Item* item, slots_t sl
 	scriptInterface.pushFunction(info.playerOnInventoryUpdate);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushUserdata<Item>(L, item);
 	LuaScriptInterface::setItemMetatable(L, -1, item);
@@ -1400,7 +1400,7 @@ const std::string Events::eventPlayerOnGuildMotdEdit(Player* player, const std::
 	scriptInterface.pushFunction(info.playerOnGuildMotdEdit);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushString(L, message);
 
@@ -1435,7 +1435,7 @@ void Events::eventPlayerOnSetLootList(Player* player, const std::vector<uint16_t
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// lootList
 	lua_createtable(L, lootList.size(), 0);
@@ -1471,16 +1471,16 @@ void Events::eventPlayerOnManageLootContainer(Player* player, Item* item, uint8_
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// item
 	if (item) {
 		if (Container* container = item->getContainer()) {
 			LuaScriptInterface::pushUserdata<Container>(L, container);
-			LuaScriptInterface::setMetatable(L, -1, "Container");
+			LuaScriptInterface::setMetatable(L, -1, LuaData_Container);
 		} else {
 			LuaScriptInterface::pushUserdata<Item>(L, item);
-			LuaScriptInterface::setMetatable(L, -1, "Item");
+			LuaScriptInterface::setMetatable(L, -1, LuaData_Item);
 		}
 	} else {
 		lua_pushnil(L);
@@ -1515,7 +1515,7 @@ void Events::eventPlayerOnFuseItems(Player* player, const ItemType* fromItemType
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// fromItemType
 	LuaScriptInterface::pushUserdata<const ItemType>(L, fromItemType);
@@ -1557,7 +1557,7 @@ void Events::eventPlayerOnTransferTier(Player* player, const ItemType* fromItemT
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// fromItemType
 	LuaScriptInterface::pushUserdata<const ItemType>(L, fromItemType);
@@ -1593,7 +1593,7 @@ void Events::eventPlayerOnForgeConversion(Player* player, ForgeConversionTypes_t
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// conversionType
 	lua_pushnumber(L, conversionType);
@@ -1621,7 +1621,7 @@ void Events::eventPlayerOnForgeHistoryBrowse(Player* player, uint8_t page)
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// conversionType
 	lua_pushnumber(L, page);
@@ -1649,11 +1649,11 @@ void Events::eventPlayerOnRequestPlayerTab(Player* player, Player* targetPlayer,
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// target
 	LuaScriptInterface::pushUserdata<Player>(L, targetPlayer);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// infoType
 	lua_pushnumber(L, infoType);
@@ -1687,7 +1687,7 @@ void Events::eventPlayerOnBestiaryInit(Player* player)
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	scriptInterface.callVoidFunction(1);
 }
@@ -1712,7 +1712,7 @@ void Events::eventPlayerOnBestiaryBrowse(Player* player, const std::string& cate
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// category
 	lua_pushstring(L, category.c_str());
@@ -1748,7 +1748,7 @@ void Events::eventPlayerOnBestiaryRaceView(Player* player, uint16_t raceId)
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// raceId
 	lua_pushnumber(L, raceId);
@@ -1778,7 +1778,7 @@ uint8_t Events::eventPlayerOnFrameView(Player* player, const Creature* target)
 
 	// player
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	// target
 	lua_pushnumber(L, target->getID());
@@ -1813,7 +1813,7 @@ void Events::eventPlayerOnConnect(Player* player, bool isLogin)
 	scriptInterface.pushFunction(info.playerOnConnect);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushboolean(L, isLogin);
 	scriptInterface.callVoidFunction(2);
@@ -1839,7 +1839,7 @@ void Events::eventPlayerOnExtendedProtocol(Player* player, uint8_t recvbyte, std
 	scriptInterface.pushFunction(info.playerOnExtendedProtocol);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	lua_pushnumber(L, recvbyte);
 
@@ -1869,10 +1869,10 @@ void Events::eventMonsterOnDropLoot(Monster* monster, Container* corpse)
 	scriptInterface.pushFunction(info.monsterOnDropLoot);
 
 	LuaScriptInterface::pushUserdata<Monster>(L, monster);
-	LuaScriptInterface::setMetatable(L, -1, "Monster");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Monster);
 
 	LuaScriptInterface::pushUserdata<Container>(L, corpse);
-	LuaScriptInterface::setMetatable(L, -1, "Container");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Container);
 
 	return scriptInterface.callVoidFunction(2);
 }
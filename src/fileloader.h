@@ -140,6 +140,10 @@ class PropWriteStream
 			std::copy(str.begin(), str.end(), std::back_inserter(buffer));
 		}
 
+		void writeBytes(const char* data, size_t size) {
+			std::copy(data, data + size, std::back_inserter(buffer));
+		}
+
 	private:
 		std::vector<char> buffer;
 };
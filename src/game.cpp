@@ -19,6 +19,10 @@
 #include "inbox.h"
 #include "iologindata.h"
 #include "iomarket.h"
+#include "journal.h"
+#include "luacache.h"
+#include "luacollector.h"
+#include "luaprofiler.h"
 #include "items.h"
 #include "monster.h"
 #include "movement.h"
@@ -26,14 +30,17 @@
 #include "outfit.h"
 #include "party.h"
 #include "podium.h"
+#include "protocolstatus.h"
 #include "scheduler.h"
 #include "script.h"
+#include "scriptshards.h"
 #include "server.h"
 #include "spectators.h"
 #include "spells.h"
 #include "storeinbox.h"
 #include "talkaction.h"
 #include "weapons.h"
+#include "workerpool.h"
 
 extern ConfigManager g_config;
 extern Actions* g_actions;
@@ -48,6 +55,11 @@ extern Monsters g_monsters;
 extern MoveEvents* g_moveEvents;
 extern Weapons* g_weapons;
 extern Scripts* g_scripts;
+extern LuaEnvironment g_luaEnvironment;
+extern LuaBytecodeCache g_luaBytecodeCache;
+extern LuaGarbageCollector g_luaGarbageCollector;
+extern ScriptShards g_scriptShards;
+extern LuaProfiler g_luaProfiler;
 
 Game::Game()
 {
@@ -140,6 +152,7 @@ void Game::setGameState(GameState_t newState)
 				createTask([this]() { shutdown(); }));
 
 			g_scheduler.stop();
+			g_journal.stop();
 			g_databaseTasks.stop();
 			g_dispatcher.stop();
 			break;
@@ -2532,7 +2545,8 @@ void Game::playerWriteItem(uint32_t playerId, uint32_t windowTextId, const std::
 		return;
 	}
 
-	for (auto creatureEvent : player->getCreatureEvents(CREATURE_EVENT_TEXTEDIT)) {
+	const CreatureEventList& events = player->getCreatureEvents(CREATURE_EVENT_TEXTEDIT);
+	for (CreatureEvent* creatureEvent : CreatureEventDispatch(player, events)) {
 		if (!creatureEvent->executeTextEdit(player, writeItem, text)) {
 			player->setWriteItem(nullptr);
 			return;
@@ -2551,6 +2565,8 @@ void Game::playerWriteItem(uint32_t playerId, uint32_t windowTextId, const std::
 		writeItem->resetDate();
 	}
 
+	House::markItemDirty(writeItem);
+
 	uint16_t newId = Item::items[writeItem->getID()].writeOnceItemId;
 	if (newId != 0) {
 		transformItem(writeItem, newId);
@@ -4184,7 +4200,15 @@ void Game::checkCreatureAttack(uint32_t creatureId)
 
 void Game::addCreatureCheck(Creature* creature)
 {
-	creature->creatureCheck = true;
+	if (creature->creatureAsleep) {
+		creature->creatureAsleep = false;
+		--sleepingCreatures;
+	}
+
+	if (!creature->creatureCheck) {
+		creature->creatureCheck = true;
+		++activeCreatures;
+	}
 
 	if (creature->inCheckCreaturesVector) {
 		// already in a vector
@@ -4198,36 +4222,93 @@ void Game::addCreatureCheck(Creature* creature)
 
 void Game::removeCreatureCheck(Creature* creature)
 {
-	if (creature->inCheckCreaturesVector) {
+	if (creature->creatureAsleep) {
+		creature->creatureAsleep = false;
+		--sleepingCreatures;
+	}
+
+	if (creature->creatureCheck) {
 		creature->creatureCheck = false;
+		--activeCreatures;
 	}
 }
 
+void Game::sleepCreature(Creature* creature)
+{
+	if (creature->creatureAsleep) {
+		return;
+	}
+
+	// nothing to think about until a spectator wakes it up again through addCreatureCheck
+	removeCreatureCheck(creature);
+	creature->creatureAsleep = true;
+	++sleepingCreatures;
+}
+
 void Game::checkCreatures(size_t index)
 {
 	g_scheduler.addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL, [=]() { checkCreatures((index + 1) % EVENT_CREATURECOUNT); }));
 
+	pathSearchesThisCheck = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
 	auto& checkCreatureList = checkCreatureLists[index];
-	auto it = checkCreatureList.begin(), end = checkCreatureList.end();
-	while (it != end) {
-		Creature* creature = *it;
+	if (g_workerPool.getThreadCount() != 0) {
+		// monsters decide in parallel against the unchanged world, onThink checks and applies the decisions in order
+		thinkingMonsters.clear();
+		for (Creature* creature : checkCreatureList) {
+			Monster* monster = creature->getMonster();
+			if (monster && monster->creatureCheck && monster->getHealth() > 0) {
+				thinkingMonsters.push_back(monster);
+			}
+		}
+
+		g_workerPool.parallelFor(thinkingMonsters.size(), [this](size_t i) { thinkingMonsters[i]->prepareThink(); });
+		monsterDecisions += thinkingMonsters.size();
+		monsterDecisionTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	}
+
+	// creatures may be added to this bucket while it is walked, so index instead of iterating
+	size_t i = 0;
+	while (i < checkCreatureList.size()) {
+		Creature* creature = checkCreatureList[i];
 		if (creature->creatureCheck) {
 			if (creature->getHealth() > 0) {
 				creature->onThink(EVENT_CREATURE_THINK_INTERVAL);
 				creature->onAttacking(EVENT_CREATURE_THINK_INTERVAL);
 				creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
 			}
-			++it;
+			++i;
 		} else {
 			creature->inCheckCreaturesVector = false;
-			it = checkCreatureList.erase(it);
+			checkCreatureList[i] = checkCreatureList.back();
+			checkCreatureList.pop_back();
 			ReleaseCreature(creature);
 		}
 	}
 
+	creatureCheckTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
 	cleanup();
 }
 
+bool Game::reservePathSearch()
+{
+	int32_t budget = g_config.getNumber(ConfigManager::PATH_SEARCH_BUDGET);
+	if (budget <= 0) {
+		return true;
+	}
+
+	if (pathSearchesThisCheck >= budget) {
+		++deferredPathSearches;
+		return false;
+	}
+
+	++pathSearchesThisCheck;
+	return true;
+}
+
 void Game::changeSpeed(Creature* creature, int32_t varSpeedDelta)
 {
 	int32_t varSpeed = creature->getSpeed() - creature->getBaseSpeed();
@@ -4510,9 +4591,9 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		}
 
 		if (damage.origin != ORIGIN_NONE) {
-			const auto& events = target->getCreatureEvents(CREATURE_EVENT_HEALTHCHANGE);
+			const CreatureEventList& events = target->getCreatureEvents(CREATURE_EVENT_HEALTHCHANGE);
 			if (!events.empty()) {
-				for (CreatureEvent* creatureEvent : events) {
+				for (CreatureEvent* creatureEvent : CreatureEventDispatch(target, events)) {
 					// healing
 					creatureEvent->executeHealthChange(target, attacker, damage, isBeforeManaShield);
 				}
@@ -4569,7 +4650,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 					}
 					message.text = spectatorMessage;
 				}
-				tmpPlayer->sendTextMessage(message);
+				addCombatTextMessage(tmpPlayer, message);
 			}
 		}
 	} else {
@@ -4608,9 +4689,9 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 			int32_t manaDamage = std::min<int32_t>(targetPlayer->getMana(), healthChange);
 			if (manaDamage != 0) {
 				if (damage.origin != ORIGIN_NONE) {
-					const auto& events = target->getCreatureEvents(CREATURE_EVENT_MANACHANGE);
+					const CreatureEventList& events = target->getCreatureEvents(CREATURE_EVENT_MANACHANGE);
 					if (!events.empty()) {
-						for (CreatureEvent* creatureEvent : events) {
+						for (CreatureEvent* creatureEvent : CreatureEventDispatch(target, events)) {
 							// damage that would be taken if mana shield was not active
 							creatureEvent->executeHealthChange(target, attacker, damage, isBeforeManaShield);
 							isBeforeManaShield = false;
@@ -4628,7 +4709,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 
 				targetPlayer->drainMana(attacker, manaDamage);
 				map.getSpectators(spectators, targetPos, true, true);
-				addMagicEffect(spectators, targetPos, CONST_ME_LOSEENERGY);
+				addCombatMagicEffect(spectators, targetPos, CONST_ME_LOSEENERGY);
 
 				std::string spectatorMessage;
 
@@ -4668,7 +4749,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 						}
 						message.text = spectatorMessage;
 					}
-					tmpPlayer->sendTextMessage(message);
+					addCombatTextMessage(tmpPlayer, message);
 				}
 
 				damage.primary.value -= manaDamage;
@@ -4685,9 +4766,9 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		}
 
 		if (damage.origin != ORIGIN_NONE) {
-			const auto& events = target->getCreatureEvents(CREATURE_EVENT_HEALTHCHANGE);
+			const CreatureEventList& events = target->getCreatureEvents(CREATURE_EVENT_HEALTHCHANGE);
 			if (!events.empty()) {
-				for (CreatureEvent* creatureEvent : events) {
+				for (CreatureEvent* creatureEvent : CreatureEventDispatch(target, events)) {
 					// real damage taken
 					creatureEvent->executeHealthChange(target, attacker, damage, isBeforeManaShield);
 				}
@@ -4720,14 +4801,14 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		if (message.primary.value) {
 			combatGetTypeInfo(damage.primary.type, target, message.primary.color, hitEffect);
 			if (hitEffect != CONST_ME_NONE) {
-				addMagicEffect(spectators, targetPos, hitEffect);
+				addCombatMagicEffect(spectators, targetPos, hitEffect);
 			}
 		}
 
 		if (message.secondary.value) {
 			combatGetTypeInfo(damage.secondary.type, target, message.secondary.color, hitEffect);
 			if (hitEffect != CONST_ME_NONE) {
-				addMagicEffect(spectators, targetPos, hitEffect);
+				addCombatMagicEffect(spectators, targetPos, hitEffect);
 			}
 		}
 
@@ -4769,12 +4850,13 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 					}
 					message.text = spectatorMessage;
 				}
-				tmpPlayer->sendTextMessage(message);
+				addCombatTextMessage(tmpPlayer, message);
 			}
 		}
 
 		if (realDamage >= targetHealth) {
-			for (CreatureEvent* creatureEvent : target->getCreatureEvents(CREATURE_EVENT_PREPAREDEATH)) {
+			const CreatureEventList& events = target->getCreatureEvents(CREATURE_EVENT_PREPAREDEATH);
+			for (CreatureEvent* creatureEvent : CreatureEventDispatch(target, events)) {
 				if (!creatureEvent->executeOnPrepareDeath(target, attacker)) {
 					return false;
 				}
@@ -4782,7 +4864,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 		}
 
 		target->drainHealth(attacker, realDamage);
-		addCreatureHealth(spectators, target);
+		addCombatCreatureHealth(spectators, target);
 	}
 
 	return true;
@@ -4805,9 +4887,9 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 		}
 
 		if (damage.origin != ORIGIN_NONE) {
-			const auto& events = target->getCreatureEvents(CREATURE_EVENT_MANACHANGE);
+			const CreatureEventList& events = target->getCreatureEvents(CREATURE_EVENT_MANACHANGE);
 			if (!events.empty()) {
-				for (CreatureEvent* creatureEvent : events) {
+				for (CreatureEvent* creatureEvent : CreatureEventDispatch(target, events)) {
 					creatureEvent->executeManaChange(target, attacker, damage);
 				}
 				damage.origin = ORIGIN_NONE;
@@ -4858,9 +4940,9 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 		}
 
 		if (damage.origin != ORIGIN_NONE) {
-			const auto& events = target->getCreatureEvents(CREATURE_EVENT_MANACHANGE);
+			const CreatureEventList& events = target->getCreatureEvents(CREATURE_EVENT_MANACHANGE);
 			if (!events.empty()) {
-				for (CreatureEvent* creatureEvent : events) {
+				for (CreatureEvent* creatureEvent : CreatureEventDispatch(target, events)) {
 					creatureEvent->executeManaChange(target, attacker, damage);
 				}
 				damage.origin = ORIGIN_NONE;
@@ -4908,7 +4990,7 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 				}
 				message.text = spectatorMessage;
 			}
-			tmpPlayer->sendTextMessage(message);
+			addCombatTextMessage(tmpPlayer, message);
 		}
 	}
 
@@ -4917,6 +4999,10 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 
 void Game::addCreatureHealth(const Creature* target)
 {
+	if (batchCreatureHealth(target)) {
+		return;
+	}
+
 	SpectatorVec spectators;
 	map.getSpectators(spectators, target->getPosition(), true, true);
 	addCreatureHealth(spectators, target);
@@ -4933,6 +5019,11 @@ void Game::addCreatureHealth(const SpectatorVec& spectators, const Creature* tar
 
 void Game::addMagicEffect(const Position& pos, uint8_t effect)
 {
+	if (CombatBatch* batch = getCombatBatch(pos)) {
+		batch->magicEffects.emplace_back(pos, effect);
+		return;
+	}
+
 	SpectatorVec spectators;
 	map.getSpectators(spectators, pos, true, true);
 	addMagicEffect(spectators, pos, effect);
@@ -4947,6 +5038,96 @@ void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, u
 	}
 }
 
+void Game::addCombatMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect)
+{
+	if (CombatBatch* batch = getCombatBatch(pos)) {
+		batch->magicEffects.emplace_back(pos, effect);
+		return;
+	}
+	addMagicEffect(spectators, pos, effect);
+}
+
+void Game::addCombatCreatureHealth(const SpectatorVec& spectators, const Creature* target)
+{
+	if (!batchCreatureHealth(target)) {
+		addCreatureHealth(spectators, target);
+	}
+}
+
+void Game::addCombatTextMessage(Player* player, const TextMessage& message)
+{
+	if (CombatBatch* batch = getCombatBatch(message.position)) {
+		batch->textMessages.emplace_back(player->getID(), message);
+		return;
+	}
+	player->sendTextMessage(message);
+}
+
+bool Game::batchCreatureHealth(const Creature* target)
+{
+	CombatBatch* batch = getCombatBatch(target->getPosition());
+	if (!batch) {
+		return false;
+	}
+
+	// only the health at the end of the cast is sent
+	if (std::find(batch->healthUpdates.begin(), batch->healthUpdates.end(), target->getID()) == batch->healthUpdates.end()) {
+		batch->healthUpdates.push_back(target->getID());
+	}
+	return true;
+}
+
+CombatBatch* Game::getCombatBatch(const Position& pos)
+{
+	// everyone who sees a position inside the area is a spectator of the cast
+	for (size_t i = combatBatchDepth; i-- > 0;) {
+		CombatBatch& batch = combatBatches[i];
+		if (pos.z == batch.position.z && Position::getDistanceX(pos, batch.position) <= static_cast<int32_t>(batch.maxX) && Position::getDistanceY(pos, batch.position) <= static_cast<int32_t>(batch.maxY)) {
+			return &batch;
+		}
+	}
+	return nullptr;
+}
+
+void Game::beginCombatBatch(const Position& centerPos, uint32_t maxX, uint32_t maxY)
+{
+	if (combatBatchDepth == combatBatches.size()) {
+		combatBatches.emplace_back();
+	}
+
+	CombatBatch& batch = combatBatches[combatBatchDepth++];
+	batch.position = centerPos;
+	batch.maxX = maxX;
+	batch.maxY = maxY;
+}
+
+void Game::endCombatBatch()
+{
+	CombatBatch& batch = combatBatches[--combatBatchDepth];
+	if (!batch.magicEffects.empty() || !batch.textMessages.empty() || !batch.healthUpdates.empty()) {
+		for (uint32_t creatureId : batch.healthUpdates) {
+			if (const Creature* creature = getCreatureByID(creatureId)) {
+				batch.creatures.push_back(creature);
+			}
+		}
+
+		// scripts may have moved or removed players during the cast
+		const int32_t rangeX = batch.maxX + Map::maxViewportX;
+		const int32_t rangeY = batch.maxY + Map::maxViewportY;
+
+		SpectatorVec spectators;
+		map.getSpectators(spectators, batch.position, true, true, rangeX, rangeX, rangeY, rangeY);
+		for (Creature* spectator : spectators) {
+			spectator->getPlayer()->sendCombatBatch(batch);
+		}
+	}
+
+	batch.magicEffects.clear();
+	batch.textMessages.clear();
+	batch.healthUpdates.clear();
+	batch.creatures.clear();
+}
+
 void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect)
 {
 	SpectatorVec spectators, toPosSpectators;
@@ -5119,6 +5300,7 @@ void Game::checkDecay()
 
 		duration -= decreaseTime;
 		item->decreaseDuration(decreaseTime);
+		House::markItemDirty(item);
 
 		if (duration <= 0) {
 			it = decayItems[bucket].erase(it);
@@ -5190,7 +5372,16 @@ void Game::shutdown()
 {
 	console::print(CONSOLEMESSAGE_TYPE_INFO, "Shutting down ... ");
 
+	// the profile of a session is kept, the other counters are shown by printStats
+	if (!g_luaProfiler.empty()) {
+		g_luaProfiler.dump(g_config.getString(ConfigManager::LUA_PROFILER_FILE));
+	}
+
+	// jobs still running finish on the workers before their states are closed
+	g_scriptShards.shutdown();
+	g_workerPool.shutdown();
 	g_scheduler.shutdown();
+	g_journal.shutdown();
 	g_databaseTasks.shutdown();
 	g_dispatcher.shutdown();
 	map.spawns.clear();
@@ -5207,6 +5398,35 @@ void Game::shutdown()
 	console::print(CONSOLEMESSAGE_TYPE_INFO, "Shutdown complete!");
 }
 
+void Game::printStats()
+{
+	uint64_t uptime = std::max<uint64_t>(1, (OTSYS_TIME() - ProtocolStatus::start) / 1000);
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Spectator queries: {:d} map scans ({:d}/s), {:d} served from cache ({:d}/s).", map.getSpectatorScans(), map.getSpectatorScans() / uptime, map.getSpectatorCacheHits(), map.getSpectatorCacheHits() / uptime));
+	if (uint64_t pathSearches = map.getPathSearches()) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Path searches: {:d} ({:d}/s), {:d} nodes on average, {:d} follow paths repaired, {:d} searches deferred.", pathSearches, pathSearches / uptime, map.getPathSearchNodes() / pathSearches, followPathRepairs, deferredPathSearches));
+	}
+	Npcs::printScriptStats();
+	if (lua_State* L = g_luaEnvironment.getLuaState()) {
+		uint64_t userdataCreated = LuaScriptInterface::getUserdataCreated();
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Lua userdata: {:d} created ({:d}/s), {:d} reused from cache, {:d} KB Lua heap.", userdataCreated, userdataCreated / uptime, LuaScriptInterface::getUserdataReused(), lua_gc(L, LUA_GCCOUNT, 0)));
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Lua timers: {:d} created ({:d}/s), at most {:d} pending at once.", g_luaEnvironment.getTimersCreated(), g_luaEnvironment.getTimersCreated() / uptime, g_luaEnvironment.getPeakTimers()));
+	}
+	g_luaGarbageCollector.printStats();
+	g_scriptShards.printStats();
+	if (!g_luaProfiler.empty()) {
+		g_luaProfiler.printSummary();
+	}
+	const AsyncPathStats& asyncPathStats = map.getAsyncPathStats();
+	if (asyncPathStats.searches != 0) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Async path searches: {:d}, {:d} us average latency, {:d} us at most, peak queue depth {:d}, {:d} stale results discarded.", asyncPathStats.searches, asyncPathStats.latency.count() / asyncPathStats.searches, asyncPathStats.maxLatency.count(), asyncPathStats.peakPending, asyncPathStats.discarded));
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Async path snapshots: {:d} us on the dispatcher on average, {:d} searches with nothing in the way left on the dispatcher.", asyncPathStats.snapshotTime.count() / asyncPathStats.searches, asyncPathStats.direct));
+	}
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Creature checks: {:d} ms in total, {:d} monster decisions on {:d} worker threads took {:d} ms of it.", creatureCheckTime.count() / 1000, monsterDecisions, g_workerPool.getThreadCount(), monsterDecisionTime.count() / 1000));
+	if (combatBatchWrites != 0) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Area combat: {:d} updates sent in {:d} writes ({:d} KB).", combatBatchEntries, combatBatchWrites, combatBatchBytes / 1024));
+	}
+}
+
 void Game::cleanup()
 {
 	//free memory
@@ -6287,7 +6507,8 @@ void Game::parsePlayerExtendedOpcode(uint32_t playerId, uint8_t opcode, const st
 		return;
 	}
 
-	for (CreatureEvent* creatureEvent : player->getCreatureEvents(CREATURE_EVENT_EXTENDED_OPCODE)) {
+	const CreatureEventList& events = player->getCreatureEvents(CREATURE_EVENT_EXTENDED_OPCODE);
+	for (CreatureEvent* creatureEvent : CreatureEventDispatch(player, events)) {
 		creatureEvent->executeExtendedOpcode(player, opcode, buffer);
 	}
 }
@@ -6404,7 +6625,8 @@ void Game::playerAnswerModalWindow(uint32_t playerId, uint32_t modalWindowId, ui
 
 		player->setBedItem(nullptr);
 	} else {
-		for (auto creatureEvent : player->getCreatureEvents(CREATURE_EVENT_MODALWINDOW)) {
+		const CreatureEventList& events = player->getCreatureEvents(CREATURE_EVENT_MODALWINDOW);
+		for (CreatureEvent* creatureEvent : CreatureEventDispatch(player, events)) {
 			creatureEvent->executeModalWindow(player, modalWindowId, button, choice);
 		}
 	}
@@ -6565,12 +6787,47 @@ void Game::removeUniqueItem(uint16_t uniqueId)
 	}
 }
 
+namespace {
+
+// where the scripts a reload type loads live, nullptr if it loads none
+const char* getReloadScriptPath(ReloadTypes_t reloadType)
+{
+	switch (reloadType) {
+		case RELOAD_TYPE_ALL: return "data";
+		case RELOAD_TYPE_ACTIONS: return "data/actions";
+		case RELOAD_TYPE_CREATURESCRIPTS: return "data/creaturescripts";
+		case RELOAD_TYPE_GLOBALEVENTS: return "data/globalevents";
+		case RELOAD_TYPE_MOVEMENTS: return "data/movements";
+		case RELOAD_TYPE_NPCS: return "data/npc";
+		case RELOAD_TYPE_SCRIPTS: return "data/scripts";
+		case RELOAD_TYPE_SPELLS: return "data/spells";
+		case RELOAD_TYPE_TALKACTIONS: return "data/talkactions";
+		case RELOAD_TYPE_WEAPONS: return "data/weapons";
+		default: return nullptr;
+	}
+}
+
+}
+
 bool Game::reload(ReloadTypes_t reloadType)
 {
+	// the reload below finds its changed scripts compiled already
+	if (const char* path = getReloadScriptPath(reloadType)) {
+		g_luaBytecodeCache.precompile(path);
+	}
+
 	switch (reloadType) {
 		case RELOAD_TYPE_ACTIONS: return g_actions->reload();
 		case RELOAD_TYPE_CHAT: return g_chat->load();
-		case RELOAD_TYPE_CONFIG: return g_config.reload();
+		case RELOAD_TYPE_CONFIG: {
+			if (!g_config.reload()) {
+				return false;
+			}
+			g_luaProfiler.configure();
+			g_luaGarbageCollector.configure();
+			g_luaBytecodeCache.configure();
+			return true;
+		}
 		case RELOAD_TYPE_CREATURESCRIPTS: {
 			g_creatureEvents->reload();
 			g_creatureEvents->removeInvalidEvents();
@@ -6645,6 +6902,9 @@ bool Game::reload(ReloadTypes_t reloadType)
 
 			g_actions->reload();
 			g_config.reload();
+			g_luaProfiler.configure();
+			g_luaGarbageCollector.configure();
+			g_luaBytecodeCache.configure();
 			g_creatureEvents->reload();
 			g_monsters.reload();
 			g_moveEvents->reload();
@@ -62,6 +62,18 @@ static constexpr int32_t RANGE_LOOT_ITEM_INTERVAL = 400;
 static constexpr int32_t RANGE_REQUEST_TRADE_INTERVAL = 400;
 static constexpr int32_t RANGE_INSPECT_ITEM_INTERVAL = 400;
 
+// visual updates of an area combat cast, sent to each spectator in one write
+struct CombatBatch {
+	Position position;
+	uint32_t maxX = 0;
+	uint32_t maxY = 0;
+
+	std::vector<std::pair<Position, uint8_t>> magicEffects;
+	std::vector<std::pair<uint32_t, TextMessage>> textMessages;
+	std::vector<uint32_t> healthUpdates;
+	std::vector<const Creature*> creatures;
+};
+
 /**
   * Main Game class.
   * This class is responsible to control everything that happens
@@ -204,7 +216,28 @@ class Game
 		void executeDeath(uint32_t creatureId);
 
 		void addCreatureCheck(Creature* creature);
-		static void removeCreatureCheck(Creature* creature);
+		void removeCreatureCheck(Creature* creature);
+		void sleepCreature(Creature* creature);
+
+		size_t getActiveCreatureCount() const {
+			return activeCreatures;
+		}
+		size_t getSleepingCreatureCount() const {
+			return sleepingCreatures;
+		}
+
+		bool reservePathSearch();
+		void addFollowPathRepair() {
+			++followPathRepairs;
+		}
+
+		void beginCombatBatch(const Position& centerPos, uint32_t maxX, uint32_t maxY);
+		void endCombatBatch();
+		void addCombatBatchWrite(uint32_t entries, uint32_t bytes) {
+			++combatBatchWrites;
+			combatBatchEntries += entries;
+			combatBatchBytes += bytes;
+		}
 
 		size_t getPlayersOnline() const {
 			return players.size();
@@ -440,6 +473,8 @@ class Game
 
 		void cleanup();
 		void shutdown();
+		// prints the performance counters collected since startup
+		void printStats();
 		void ReleaseCreature(Creature* creature);
 		void ReleaseItem(Item* item);
 
@@ -480,6 +515,7 @@ class Game
 		static void addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect);
 		void addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect);
 		static void addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos, uint8_t effect);
+		void addCombatMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect);
 
 		void setAccountStorageValue(const uint32_t accountId, const uint32_t key, const int32_t value);
 		int32_t getAccountStorageValue(const uint32_t accountId, const uint32_t key) const;
@@ -567,6 +603,11 @@ class Game
 		void checkDecay();
 		void internalDecayItem(Item* item);
 
+		CombatBatch* getCombatBatch(const Position& pos);
+		bool batchCreatureHealth(const Creature* target);
+		void addCombatCreatureHealth(const SpectatorVec& spectators, const Creature* target);
+		void addCombatTextMessage(Player* player, const TextMessage& message);
+
 		std::unordered_map<uint32_t, Player*> players;
 		std::unordered_map<std::string, Player*> mappedPlayerNames;
 		std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
@@ -576,7 +617,24 @@ class Game
 		std::unordered_map<uint32_t, std::unordered_map<uint32_t, int32_t>> accountStorageMap;
 
 		std::list<Item*> decayItems[EVENT_DECAY_BUCKETS];
-		std::list<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
+		std::vector<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
+		size_t activeCreatures = 0;
+		size_t sleepingCreatures = 0;
+
+		int32_t pathSearchesThisCheck = 0;
+		uint64_t followPathRepairs = 0;
+		uint64_t deferredPathSearches = 0;
+
+		std::vector<Monster*> thinkingMonsters;
+		uint64_t monsterDecisions = 0;
+		std::chrono::microseconds monsterDecisionTime{0};
+		std::chrono::microseconds creatureCheckTime{0};
+
+		std::deque<CombatBatch> combatBatches;
+		size_t combatBatchDepth = 0;
+		uint64_t combatBatchWrites = 0;
+		uint64_t combatBatchEntries = 0;
+		uint64_t combatBatchBytes = 0;
 
 		std::vector<Creature*> ToReleaseCreatures;
 		std::vector<Item*> ToReleaseItems;
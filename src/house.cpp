@@ -10,6 +10,7 @@
 #include "housetile.h"
 #include "inbox.h"
 #include "iologindata.h"
+#include "journal.h"
 #include "pugicast.h"
 
 extern ConfigManager g_config;
@@ -17,6 +18,13 @@ extern Game g_game;
 
 House::House(uint32_t houseId) : id(houseId) {}
 
+void House::markItemDirty(const Item* item)
+{
+	if (const HouseTile* houseTile = dynamic_cast<const HouseTile*>(item->getTile())) {
+		houseTile->getHouse()->markDirty();
+	}
+}
+
 void House::addTile(HouseTile* tile)
 {
 	tile->setFlag(TILESTATE_PROTECTIONZONE);
@@ -26,8 +34,10 @@ void House::addTile(HouseTile* tile)
 void House::setOwner(uint32_t guid, bool updateDatabase/* = true*/, Player* player/* = nullptr*/)
 {
 	if (updateDatabase && owner != guid) {
-		Database& db = Database::getInstance();
-		db.executeQuery(fmt::format("UPDATE `houses` SET `owner` = {:d}, `bid` = 0, `bid_end` = 0, `last_bid` = 0, `highest_bidder` = 0  WHERE `id` = {:d}", guid, id));
+		g_journal.record([=]() {
+			Database& db = Database::getInstance();
+			return db.executeQuery(fmt::format("UPDATE `houses` SET `owner` = {:d}, `bid` = 0, `bid_end` = 0, `last_bid` = 0, `highest_bidder` = 0  WHERE `id` = {:d}", guid, id));
+		});
 	}
 
 	if (isLoaded && owner == guid) {
@@ -212,6 +212,19 @@ class House
 			return static_cast<uint32_t>(std::ceil(bedsList.size() / 2.)); //each bed takes 2 sqms of space, ceil is just for bad maps
 		}
 
+		// items on the house tiles changed since they were last saved to tile_store
+		void markDirty() {
+			dirty = true;
+		}
+		void clearDirty() {
+			dirty = false;
+		}
+		bool isDirty() const {
+			return dirty;
+		}
+
+		static void markItemDirty(const Item* item);
+
 	private:
 		bool transferToDepot() const;
 		bool transferToDepot(Player* player) const;
@@ -242,6 +255,7 @@ class House
 		Position posEntry = {};
 
 		bool isLoaded = false;
+		bool dirty = true;
 };
 
 using HouseMap = std::map<uint32_t, House*>;
@@ -0,0 +1,108 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_IDLOOKUP_H
+#define FS_IDLOOKUP_H
+
+// index from item, action or unique ids to the events of a map, rebuilt on the first lookup after a change
+template<typename T>
+class IdLookupTable
+{
+	public:
+		// dense tables always use the array, up to the highest id
+		explicit IdLookupTable(bool dense = false) : dense(dense) {}
+
+		void invalidate() {
+			stale = true;
+		}
+		bool isStale() const {
+			return stale;
+		}
+
+		// get turns a map value into the indexed pointer, entries it returns nullptr for are skipped
+		template<typename Map, typename Get>
+		void build(Map& map, Get&& get) {
+			direct.clear();
+			keys.clear();
+			values.clear();
+			stale = false;
+
+			std::vector<std::pair<uint32_t, T*>> entries;
+			entries.reserve(map.size());
+
+			uint32_t maxId = 0;
+			for (auto& it : map) {
+				if (T* value = get(it.second)) {
+					entries.emplace_back(it.first, value);
+					maxId = std::max<uint32_t>(maxId, it.first);
+				}
+			}
+
+			if (entries.empty()) {
+				return;
+			}
+
+			if (dense || maxId < entries.size() * 4 + 1024) {
+				direct.assign(maxId + 1, nullptr);
+				for (const auto& entry : entries) {
+					direct[entry.first] = entry.second;
+				}
+				return;
+			}
+
+			size_t capacity = 16;
+			shift = 28;
+			while (capacity < entries.size() * 2) {
+				capacity <<= 1;
+				--shift;
+			}
+
+			keys.assign(capacity, EMPTY_KEY);
+			values.assign(capacity, nullptr);
+			mask = capacity - 1;
+
+			for (const auto& entry : entries) {
+				size_t index = hash(entry.first);
+				while (keys[index] != EMPTY_KEY) {
+					index = (index + 1) & mask;
+				}
+				keys[index] = entry.first;
+				values[index] = entry.second;
+			}
+		}
+
+		T* find(uint32_t id) const {
+			if (id < direct.size()) {
+				return direct[id];
+			}
+
+			if (keys.empty()) {
+				return nullptr;
+			}
+
+			for (size_t index = hash(id); keys[index] != EMPTY_KEY; index = (index + 1) & mask) {
+				if (keys[index] == id) {
+					return values[index];
+				}
+			}
+			return nullptr;
+		}
+
+	private:
+		static constexpr uint32_t EMPTY_KEY = std::numeric_limits<uint32_t>::max();
+
+		// Fibonacci hashing, the top bits of the product index the table so neighbouring ids end up apart
+		size_t hash(uint32_t id) const {
+			return (id * 2654435769u) >> shift;
+		}
+
+		std::vector<T*> direct;
+		std::vector<uint32_t> keys;
+		std::vector<T*> values;
+		size_t mask = 0;
+		uint32_t shift = 32;
+		bool dense;
+		bool stale = true;
+};
+
+#endif // FS_IDLOOKUP_H
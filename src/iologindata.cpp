@@ -7,9 +7,11 @@
 
 #include "condition.h"
 #include "configmanager.h"
+#include "databasemanager.h"
 #include "depotchest.h"
 #include "game.h"
 #include "inbox.h"
+#include "journal.h"
 #include "storeinbox.h"
 
 extern ConfigManager g_config;
@@ -197,21 +199,45 @@ bool IOLoginData::preloadPlayer(Player* player, const std::string& name)
 	return true;
 }
 
-bool IOLoginData::loadPlayerById(Player* player, uint32_t id)
+namespace {
+
+constexpr auto playerQuery = "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction`";
+
+constexpr std::array<const char*, ITEM_SECTION_LAST + 1> itemTables = {"player_items", "player_depotitems", "player_inboxitems", "player_storeinboxitems"};
+
+constexpr uint8_t ITEM_BLOB_VERSION = 1;
+
+void updateOpenContainerId(const Player* player, Container* container)
 {
-	Database& db = Database::getInstance();
-	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = {:d}", id)));
+	if (container->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
+		container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
+	}
+
+	for (const auto& it : player->getOpenContainers()) {
+		if (it.second.container == container) {
+			container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, static_cast<int64_t>(it.first) + 1);
+			break;
+		}
+	}
 }
 
-bool IOLoginData::loadPlayerByName(Player* player, const std::string& name)
+void releaseItemSections(PlayerItemSections& sections)
 {
-	Database& db = Database::getInstance();
-	return loadPlayer(player, db.storeQuery(fmt::format("SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = {:s}", db.escapeString(name))));
+	for (ItemBlockList& itemList : sections) {
+		for (const auto& it : itemList) {
+			it.second->decrementReferenceCounter();
+		}
+		itemList.clear();
+	}
+}
+
+bool hasItemData(const PlayerLoadData& data)
+{
+	return data.itemBlob || std::any_of(data.items.begin(), data.items.end(), [](const DBResult_ptr& result) { return result != nullptr; });
 }
 
-static GuildWarVector getWarList(uint32_t guildId)
+GuildWarVector getWarList(uint32_t guildId, DBResult_ptr result)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = {:d} OR `guild2` = {:d}) AND `ended` = 0 AND `status` = 1", guildId, guildId));
 	if (!result) {
 		return {};
 	}
@@ -228,24 +254,85 @@ static GuildWarVector getWarList(uint32_t guildId)
 	return guildWarVector;
 }
 
-bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
+}
+
+bool IOLoginData::loadPlayerById(Player* player, uint32_t id)
+{
+	g_journal.waitForPlayer(id);
+
+	PlayerLoadData data;
+	return loadPlayerDataById(Database::getInstance(), data, id) && loadPlayer(player, data);
+}
+
+bool IOLoginData::loadPlayerByName(Player* player, const std::string& name)
+{
+	Database& db = Database::getInstance();
+	const std::string query = fmt::format("{:s} FROM `players` WHERE `name` = {:s}", playerQuery, db.escapeString(name));
+
+	DBResult_ptr result = db.storeQuery(query);
+	if (result && g_journal.waitForPlayer(result->getNumber<uint32_t>("id"))) {
+		// read before the last save of this player reached the database
+		result = db.storeQuery(query);
+	}
+	return loadPlayer(player, std::move(result));
+}
+
+bool IOLoginData::loadPlayerDataById(Database& db, PlayerLoadData& data, uint32_t id)
+{
+	return loadPlayerData(db, data, db.storeQuery(fmt::format("{:s} FROM `players` WHERE `id` = {:d}", playerQuery, id)));
+}
+
+bool IOLoginData::loadPlayerData(Database& db, PlayerLoadData& data, DBResult_ptr result)
 {
 	if (!result) {
 		return false;
 	}
 
-	Database& db = Database::getInstance();
+	data.player = std::move(result);
 
-	uint32_t accno = result->getNumber<uint32_t>("account_id");
-	Account acc = loadAccount(accno);
+	uint32_t guid = data.player->getNumber<uint32_t>("id");
+	uint32_t accountId = data.player->getNumber<uint32_t>("account_id");
+
+	data.account = db.storeQuery(fmt::format("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = {:d}", accountId));
+
+	if ((data.guildMembership = db.storeQuery(fmt::format("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = {:d}", guid)))) {
+		uint32_t guildId = data.guildMembership->getNumber<uint32_t>("guild_id");
+		data.guildRank = db.storeQuery(fmt::format("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = {:d}", data.guildMembership->getNumber<uint32_t>("rank_id")));
+		data.guildWars = db.storeQuery(fmt::format("SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = {:d} OR `guild2` = {:d}) AND `ended` = 0 AND `status` = 1", guildId, guildId));
+		data.guildMembers = db.storeQuery(fmt::format("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId));
+	}
+
+	data.spells = db.storeQuery(fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {:d}", guid));
+	loadItemData(db, data, guid, g_config.getBoolean(ConfigManager::COMPACT_ITEM_STORAGE));
+	data.storage = db.storeQuery(fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {:d}", guid));
+	data.vipList = db.storeQuery(fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {:d}", accountId));
+	return true;
+}
+
+bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
+{
+	PlayerLoadData data;
+	return loadPlayerData(Database::getInstance(), data, std::move(result)) && loadPlayer(player, data);
+}
+
+bool IOLoginData::loadPlayer(Player* player, const PlayerLoadData& data)
+{
+	DBResult_ptr result = data.player;
+	if (!result) {
+		return false;
+	}
 
 	player->setGUID(result->getNumber<uint32_t>("id"));
 	player->name = result->getString("name");
-	player->accountNumber = accno;
-
-	player->accountType = acc.accountType;
+	player->accountNumber = result->getNumber<uint32_t>("account_id");
 
-	player->premiumEndsAt = acc.premiumEndsAt;
+	if (data.account) {
+		player->accountType = static_cast<AccountType_t>(data.account->getNumber<int32_t>("type"));
+		player->premiumEndsAt = data.account->getNumber<time_t>("premium_ends_at");
+	} else {
+		player->accountType = ACCOUNT_TYPE_NORMAL;
+		player->premiumEndsAt = 0;
+	}
 
 	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
 	if (!group) {
@@ -385,7 +472,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		player->skills[i].percent = Player::getPercentLevel(skillTries, nextSkillTries);
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.guildMembership)) {
 		uint32_t guildId = result->getNumber<uint32_t>("guild_id");
 		uint32_t playerRankId = result->getNumber<uint32_t>("rank_id");
 		player->guildNick = result->getString("nick");
@@ -404,7 +491,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 			player->guild = guild;
 			GuildRank_ptr rank = guild->getRankById(playerRankId);
 			if (!rank) {
-				if ((result = db.storeQuery(fmt::format("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = {:d}", playerRankId)))) {
+				if ((result = data.guildRank)) {
 					guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"), result->getNumber<uint16_t>("level"));
 				}
 
@@ -415,151 +502,34 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 			}
 
 			player->guildRank = rank;
-			player->guildWarVector = getWarList(guildId);
+			player->guildWarVector = getWarList(guildId, data.guildWars);
 
-			if ((result = db.storeQuery(fmt::format("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId)))) {
+			if ((result = data.guildMembers)) {
 				guild->setMemberCount(result->getNumber<uint32_t>("members"));
 			}
 		}
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.spells)) {
 		do {
 			player->learnedInstantSpellList.emplace_front(result->getString("name"));
 		} while (result->next());
 	}
 
-	//load inventory items
-	ItemMap itemMap;
-	std::map<uint8_t, Container*> openContainersList;
-
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
-
-			Container* itemContainer = item->getContainer();
-			if (itemContainer) {
-				uint8_t cid = item->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER);
-				if (cid > 0) {
-					openContainersList.emplace(cid, itemContainer);
-				}
-			}
-
-			if (pid >= CONST_SLOT_FIRST && pid <= CONST_SLOT_LAST) {
-				player->internalAddThing(pid, item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
-
-	//load depot items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-
-			int32_t pid = pair.second;
-			if (pid >= 0 && pid < 100) {
-				DepotChest* depotChest = player->getDepotChest(pid, true);
-				if (depotChest) {
-					depotChest->internalAddThing(item);
-				}
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
-
-	//load inbox items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
-
-			if (pid >= 0 && pid < 100) {
-				player->getInbox()->internalAddThing(item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
-
-	//load store inbox items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC", player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
-
-			if (pid >= 0 && pid < 100) {
-				player->getStoreInbox()->internalAddThing(item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
+	//load items
+	PlayerItemSections itemSections;
+	loadItemSections(data, itemSections);
+	addItemSections(player, itemSections);
 
 	//load storage map
-	if ((result = db.storeQuery(fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = data.storage)) {
 		do {
 			player->addStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
 		} while (result->next());
 	}
 
 	//load vip list
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {:d}", player->getAccount())))) {
+	if ((result = data.vipList)) {
 		do {
 			player->addVIPInternal(result->getNumber<uint32_t>("player_id"));
 		} while (result->next());
@@ -579,7 +549,6 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 	containers.reserve(32);
 
 	int32_t runningId = 100;
-	const auto& openContainers = player->getOpenContainers();
 
 	Database& db = Database::getInstance();
 	for (const auto& it : itemList) {
@@ -588,22 +557,7 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 		++runningId;
 
 		if (Container* container = item->getContainer()) {
-			if (container->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
-				container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
-			}
-
-			if (!openContainers.empty()) {
-				for (const auto& its : openContainers) {
-					auto openContainer = its.second;
-					auto opcontainer = openContainer.container;
-
-					if (opcontainer == container) {
-						container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, static_cast<int64_t>(its.first) + 1);
-						break;
-					}
-				}
-			}
-
+			updateOpenContainerId(player, container);
 			containers.emplace_back(container, runningId);
 		}
 
@@ -629,22 +583,7 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 			Container* subContainer = item->getContainer();
 			if (subContainer) {
 				containers.emplace_back(subContainer, runningId);
-
-				if (subContainer->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
-					subContainer->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
-				}
-
-				if (!openContainers.empty()) {
-					for (const auto& it : openContainers) {
-						auto openContainer = it.second;
-						auto opcontainer = openContainer.container;
-
-						if (opcontainer == subContainer) {
-							subContainer->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, it.first + 1);
-							break;
-						}
-					}
-				}
+				updateOpenContainerId(player, subContainer);
 			}
 
 			propWriteStream.clear();
@@ -661,7 +600,249 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 	return query_insert.execute();
 }
 
+void IOLoginData::loadItemData(Database& db, PlayerLoadData& data, uint32_t guid, bool compact)
+{
+	if (compact) {
+		data.itemBlob = db.storeQuery(fmt::format("SELECT `items` FROM `player_itemblobs` WHERE `player_id` = {:d}", guid));
+		return;
+	}
+
+	for (uint8_t section = ITEM_SECTION_INVENTORY; section <= ITEM_SECTION_LAST; ++section) {
+		data.items[section] = db.storeQuery(fmt::format("SELECT `player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `{:s}` WHERE `player_id` = {:d} ORDER BY `sid` DESC", itemTables[section], guid));
+	}
+}
+
+void IOLoginData::loadItemSections(const PlayerLoadData& data, PlayerItemSections& sections)
+{
+	if (data.itemBlob) {
+		unsigned long blobSize;
+		const char* blob = data.itemBlob->getStream("items", blobSize);
+		if (!unserializeItemBlob(blob, blobSize, sections)) {
+			console::reportWarning("IOLoginData::loadItemSections", fmt::format("Item blob of player {:s} is damaged, some items may be missing.", data.player ? data.player->getString("name") : std::string()));
+		}
+		return;
+	}
+
+	ItemMap itemMap;
+	for (uint8_t section = ITEM_SECTION_INVENTORY; section <= ITEM_SECTION_LAST; ++section) {
+		if (DBResult_ptr result = data.items[section]) {
+			itemMap.clear();
+			loadItems(itemMap, result);
+			loadItemTree(itemMap, sections[section]);
+		}
+	}
+}
+
+void IOLoginData::addItemSections(Player* player, const PlayerItemSections& sections)
+{
+	for (const auto& it : sections[ITEM_SECTION_INVENTORY]) {
+		if (it.first >= CONST_SLOT_FIRST && it.first <= CONST_SLOT_LAST) {
+			player->internalAddThing(it.first, it.second);
+		} else {
+			it.second->decrementReferenceCounter();
+		}
+	}
+
+	// containers prepend, so walk the lists backwards to keep the saved order
+	const ItemBlockList& depotItems = sections[ITEM_SECTION_DEPOT];
+	for (auto it = depotItems.rbegin(), end = depotItems.rend(); it != end; ++it) {
+		DepotChest* depotChest = player->getDepotChest(it->first, true);
+		if (depotChest) {
+			depotChest->internalAddThing(it->second);
+		} else {
+			it->second->decrementReferenceCounter();
+		}
+	}
+
+	const ItemBlockList& inboxItems = sections[ITEM_SECTION_INBOX];
+	for (auto it = inboxItems.rbegin(), end = inboxItems.rend(); it != end; ++it) {
+		player->getInbox()->internalAddThing(it->second);
+	}
+
+	const ItemBlockList& storeInboxItems = sections[ITEM_SECTION_STOREINBOX];
+	for (auto it = storeInboxItems.rbegin(), end = storeInboxItems.rend(); it != end; ++it) {
+		player->getStoreInbox()->internalAddThing(it->second);
+	}
+}
+
+void IOLoginData::getItemSections(const Player* player, PlayerItemSections& sections)
+{
+	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
+		Item* item = player->inventory[slotId];
+		if (item) {
+			sections[ITEM_SECTION_INVENTORY].emplace_back(slotId, item);
+		}
+	}
+
+	for (const auto& it : player->depotChests) {
+		for (Item* item : it.second->getItemList()) {
+			sections[ITEM_SECTION_DEPOT].emplace_back(it.first, item);
+		}
+	}
+
+	for (Item* item : player->getInbox()->getItemList()) {
+		sections[ITEM_SECTION_INBOX].emplace_back(0, item);
+	}
+
+	for (Item* item : player->getStoreInbox()->getItemList()) {
+		sections[ITEM_SECTION_STOREINBOX].emplace_back(0, item);
+	}
+}
+
+bool IOLoginData::saveItemSections(const Player* player, const PlayerItemSections& sections, PropWriteStream& propWriteStream, bool compact)
+{
+	Database& db = Database::getInstance();
+
+	if (compact) {
+		propWriteStream.clear();
+		serializeItemBlob(player, sections, propWriteStream);
+
+		size_t blobSize;
+		const char* blob = propWriteStream.getStream(blobSize);
+		return db.executeQuery(fmt::format("INSERT INTO `player_itemblobs` (`player_id`, `items`) VALUES ({:d}, {:s}) ON DUPLICATE KEY UPDATE `items` = VALUES(`items`)", player->getGUID(), db.escapeBlob(blob, blobSize)));
+	}
+
+	for (uint8_t section = ITEM_SECTION_INVENTORY; section <= ITEM_SECTION_LAST; ++section) {
+		if (!db.executeQuery(fmt::format("DELETE FROM `{:s}` WHERE `player_id` = {:d}", itemTables[section], player->getGUID()))) {
+			return false;
+		}
+
+		DBInsert itemsQuery(fmt::format("INSERT INTO `{:s}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ", itemTables[section]));
+		if (!saveItems(player, sections[section], itemsQuery, propWriteStream)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void IOLoginData::serializeItemBlob(const Player* player, const PlayerItemSections& sections, PropWriteStream& propWriteStream)
+{
+	// version, then for every section: tree count, and per tree its parent id
+	// and byte length so that a damaged tree can be skipped on load
+	propWriteStream.write<uint8_t>(ITEM_BLOB_VERSION);
+
+	PropWriteStream treeStream;
+	for (const ItemBlockList& itemList : sections) {
+		propWriteStream.write<uint32_t>(itemList.size());
+		for (const auto& it : itemList) {
+			treeStream.clear();
+			serializeItem(player, it.second, treeStream);
+
+			size_t treeSize;
+			const char* tree = treeStream.getStream(treeSize);
+
+			propWriteStream.write<int32_t>(it.first);
+			propWriteStream.write<uint32_t>(treeSize);
+			propWriteStream.writeBytes(tree, treeSize);
+		}
+	}
+}
+
+bool IOLoginData::unserializeItemBlob(const char* blob, size_t size, PlayerItemSections& sections)
+{
+	PropStream propStream;
+	propStream.init(blob, size);
+
+	uint8_t version;
+	if (!propStream.read<uint8_t>(version) || version != ITEM_BLOB_VERSION) {
+		return false;
+	}
+
+	bool success = true;
+	for (ItemBlockList& itemList : sections) {
+		uint32_t treeCount;
+		if (!propStream.read<uint32_t>(treeCount)) {
+			return false;
+		}
+
+		while (treeCount--) {
+			int32_t parentId;
+			uint32_t treeSize;
+			if (!propStream.read<int32_t>(parentId) || !propStream.read<uint32_t>(treeSize) || propStream.size() < treeSize) {
+				return false;
+			}
+
+			PropStream treeStream;
+			treeStream.init(blob + (size - propStream.size()), treeSize);
+			propStream.skip(treeSize);
+
+			if (Item* item = unserializeItem(treeStream)) {
+				itemList.emplace_back(parentId, item);
+			} else {
+				success = false;
+			}
+		}
+	}
+	return success;
+}
+
+void IOLoginData::serializeItem(const Player* player, Item* item, PropWriteStream& propWriteStream)
+{
+	Container* container = item->getContainer();
+	if (container) {
+		updateOpenContainerId(player, container);
+	}
+
+	propWriteStream.write<uint16_t>(item->getID());
+	propWriteStream.write<uint16_t>(item->getSubType());
+	item->serializeAttr(propWriteStream);
+	propWriteStream.write<uint8_t>(0x00); // attr end
+
+	if (!container) {
+		propWriteStream.write<uint32_t>(0);
+		return;
+	}
+
+	// reversed, since Container::internalAddThing prepends on load
+	propWriteStream.write<uint32_t>(container->size());
+	for (auto it = container->getReversedItems(), end = container->getReversedEnd(); it != end; ++it) {
+		serializeItem(player, *it, propWriteStream);
+	}
+}
+
+Item* IOLoginData::unserializeItem(PropStream& propStream)
+{
+	uint16_t type, count;
+	if (!propStream.read<uint16_t>(type) || !propStream.read<uint16_t>(count)) {
+		return nullptr;
+	}
+
+	Item* item = Item::CreateItem(type, count);
+	if (!item) {
+		console::reportWarning("IOLoginData::unserializeItem", fmt::format("Unknown item id {:d} in item blob.", type));
+		return nullptr;
+	}
+
+	uint32_t childCount;
+	if (!item->unserializeAttr(propStream) || !propStream.read<uint32_t>(childCount)) {
+		console::reportWarning("IOLoginData::unserializeItem", fmt::format("Failed to unserialize item id {:d}.", type));
+		item->decrementReferenceCounter();
+		return nullptr;
+	}
+
+	Container* container = item->getContainer();
+	while (childCount--) {
+		Item* child = unserializeItem(propStream);
+		if (!child) {
+			item->decrementReferenceCounter();
+			return nullptr;
+		}
+
+		if (container) {
+			container->internalAddThing(child);
+		} else {
+			child->decrementReferenceCounter();
+		}
+	}
+	return item;
+}
+
 bool IOLoginData::savePlayer(Player* player)
+{
+	return g_journal.record([player]() { return savePlayerState(player); }, player->getGUID());
+}
+
+bool IOLoginData::savePlayerState(Player* player)
 {
 	g_game.saveLatestLootContainerId();
 
@@ -808,71 +989,10 @@ bool IOLoginData::savePlayer(Player* player)
 	}
 
 	//item saving
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	PlayerItemSections itemSections;
+	getItemSections(player, itemSections);
 
-	DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
-	ItemBlockList itemList;
-	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
-		Item* item = player->inventory[slotId];
-		if (item) {
-			itemList.emplace_back(slotId, item);
-		}
-	}
-
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
-		return false;
-	}
-
-	//save depot items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
-
-	for (const auto& it : player->depotChests) {
-		for (Item* item : it.second->getItemList()) {
-			itemList.emplace_back(it.first, item);
-		}
-	}
-
-	if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
-		return false;
-	}
-
-	//save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
-
-	for (Item* item : player->getInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
-	}
-
-	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
-		return false;
-	}
-
-	//save store inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert storeInboxQuery("INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
-
-	for (Item* item : player->getStoreInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
-	}
-
-	if (!saveItems(player, itemList, storeInboxQuery, propWriteStream)) {
+	if (!saveItemSections(player, itemSections, propWriteStream, g_config.getBoolean(ConfigManager::COMPACT_ITEM_STORAGE))) {
 		return false;
 	}
 
@@ -981,9 +1101,34 @@ void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
 	} while (result->next());
 }
 
+void IOLoginData::loadItemTree(ItemMap& itemMap, ItemBlockList& itemList)
+{
+	for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
+		const std::pair<Item*, int32_t>& pair = it->second;
+		Item* item = pair.first;
+		int32_t pid = pair.second;
+
+		if (pid >= 0 && pid < 100) {
+			itemList.emplace_front(pid, item);
+		} else {
+			ItemMap::const_iterator it2 = itemMap.find(pid);
+			if (it2 == itemMap.end()) {
+				continue;
+			}
+
+			Container* container = it2->second.first->getContainer();
+			if (container) {
+				container->internalAddThing(item);
+			}
+		}
+	}
+}
+
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance)
 {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `players` SET `balance` = `balance` + {:d} WHERE `id` = {:d}", bankBalance, guid));
+	g_journal.record([=]() {
+		return Database::getInstance().executeQuery(fmt::format("UPDATE `players` SET `balance` = `balance` + {:d} WHERE `id` = {:d}", bankBalance, guid));
+	}, guid);
 }
 
 bool IOLoginData::hasBiddedOnHouse(uint32_t guid)
@@ -1032,3 +1177,76 @@ void IOLoginData::updatePremiumTime(uint32_t accountId, time_t endTime)
 {
 	Database::getInstance().executeQuery(fmt::format("UPDATE `accounts` SET `premium_ends_at` = {:d} WHERE `id` = {:d}", endTime, accountId));
 }
+
+bool IOLoginData::convertItemStorage()
+{
+	bool compact = g_config.getBoolean(ConfigManager::COMPACT_ITEM_STORAGE);
+
+	int32_t storedCompact = 0;
+	DatabaseManager::getDatabaseConfig("compact_item_storage", storedCompact);
+	if ((storedCompact != 0) == compact) {
+		return true;
+	}
+
+	console::print(CONSOLEMESSAGE_TYPE_STARTUP, fmt::format("Converting player items to {:s} storage ... ", compact ? "compact" : "row"), false);
+
+	Database& db = Database::getInstance();
+
+	uint32_t playerCount = 0;
+	int64_t loadTime = 0, saveTime = 0;
+	if (DBResult_ptr result = db.storeQuery("SELECT `id` FROM `players`")) {
+		PropWriteStream propWriteStream;
+		do {
+			Player player(nullptr);
+			player.setGUID(result->getNumber<uint32_t>("id"));
+
+			int64_t start = OTSYS_TIME();
+
+			PlayerLoadData data;
+			loadItemData(db, data, player.getGUID(), !compact);
+
+			// converted before an interrupted conversion, the empty source would wipe the converted items
+			if (!hasItemData(data)) {
+				PlayerLoadData converted;
+				loadItemData(db, converted, player.getGUID(), compact);
+				if (hasItemData(converted)) {
+					continue;
+				}
+			}
+
+			PlayerItemSections sections;
+			loadItemSections(data, sections);
+
+			int64_t loaded = OTSYS_TIME();
+			loadTime += loaded - start;
+
+			DBTransaction transaction;
+			bool success = transaction.begin() && saveItemSections(&player, sections, propWriteStream, compact);
+			if (success) {
+				if (compact) {
+					for (const char* table : itemTables) {
+						success = success && db.executeQuery(fmt::format("DELETE FROM `{:s}` WHERE `player_id` = {:d}", table, player.getGUID()));
+					}
+				} else {
+					success = db.executeQuery(fmt::format("DELETE FROM `player_itemblobs` WHERE `player_id` = {:d}", player.getGUID()));
+				}
+			}
+
+			releaseItemSections(sections);
+
+			if (!success || !transaction.commit()) {
+				console::printResult(CONSOLE_LOADING_ERROR);
+				console::reportError("IOLoginData::convertItemStorage", fmt::format("Unable to convert items of player id {:d}.", player.getGUID()));
+				return false;
+			}
+
+			saveTime += OTSYS_TIME() - loaded;
+			++playerCount;
+		} while (result->next());
+	}
+
+	DatabaseManager::registerDatabaseConfig("compact_item_storage", compact ? 1 : 0);
+	console::printResult(CONSOLE_LOADING_OK);
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Converted items of {:d} players (load: {:d} ms, save: {:d} ms).", playerCount, loadTime, saveTime));
+	return true;
+}
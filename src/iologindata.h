@@ -9,11 +9,40 @@
 
 class Item;
 class Player;
+class PropStream;
 class PropWriteStream;
 struct VIPEntry;
 
 using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
 
+enum PlayerItemSection_t : uint8_t {
+	ITEM_SECTION_INVENTORY,
+	ITEM_SECTION_DEPOT,
+	ITEM_SECTION_INBOX,
+	ITEM_SECTION_STOREINBOX,
+
+	ITEM_SECTION_LAST = ITEM_SECTION_STOREINBOX
+};
+
+// top level items of each section, keyed by slot or depot id
+using PlayerItemSections = std::array<ItemBlockList, ITEM_SECTION_LAST + 1>;
+
+// raw query results needed to build a player, fetched ahead of time so the
+// database round trips can run off the dispatcher thread
+struct PlayerLoadData {
+	DBResult_ptr player;
+	DBResult_ptr account;
+	DBResult_ptr guildMembership;
+	DBResult_ptr guildRank;
+	DBResult_ptr guildWars;
+	DBResult_ptr guildMembers;
+	DBResult_ptr spells;
+	std::array<DBResult_ptr, ITEM_SECTION_LAST + 1> items;
+	DBResult_ptr itemBlob;
+	DBResult_ptr storage;
+	DBResult_ptr vipList;
+};
+
 class IOLoginData
 {
 	public:
@@ -32,6 +61,9 @@ class IOLoginData
 		static bool loadPlayerById(Player* player, uint32_t id);
 		static bool loadPlayerByName(Player* player, const std::string& name);
 		static bool loadPlayer(Player* player, DBResult_ptr result);
+		static bool loadPlayer(Player* player, const PlayerLoadData& data);
+		static bool loadPlayerData(Database& db, PlayerLoadData& data, DBResult_ptr result);
+		static bool loadPlayerDataById(Database& db, PlayerLoadData& data, uint32_t id);
 		static bool savePlayer(Player* player);
 		static uint32_t getGuidByName(const std::string& name);
 		static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
@@ -47,11 +79,27 @@ class IOLoginData
 
 		static void updatePremiumTime(uint32_t accountId, time_t endTime);
 
+		static bool convertItemStorage();
+
 	private:
 		using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
 
 		static void loadItems(ItemMap& itemMap, DBResult_ptr result);
+		static void loadItemTree(ItemMap& itemMap, ItemBlockList& itemList);
+		static bool savePlayerState(Player* player);
 		static bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream);
+
+		static void loadItemData(Database& db, PlayerLoadData& data, uint32_t guid, bool compact);
+		static void loadItemSections(const PlayerLoadData& data, PlayerItemSections& sections);
+		static void addItemSections(Player* player, const PlayerItemSections& sections);
+		static void getItemSections(const Player* player, PlayerItemSections& sections);
+		static bool saveItemSections(const Player* player, const PlayerItemSections& sections, PropWriteStream& propWriteStream, bool compact);
+
+		// compact storage, one versioned blob holding every item tree of a player
+		static void serializeItemBlob(const Player* player, const PlayerItemSections& sections, PropWriteStream& propWriteStream);
+		static bool unserializeItemBlob(const char* blob, size_t size, PlayerItemSections& sections);
+		static void serializeItem(const Player* player, Item* item, PropWriteStream& propWriteStream);
+		static Item* unserializeItem(PropStream& propStream);
 };
 
 #endif
@@ -7,57 +7,253 @@
 #include "bed.h"
 #include "game.h"
 #include "housetile.h"
+#include "workerpool.h"
 
 extern Game g_game;
 
+struct HouseTileData
+{
+	std::string data;
+	uint32_t houseId = 0;
+
+	uint16_t x = 0, y = 0;
+	uint8_t z = 0;
+	bool valid = false;
+
+	// leading items unserialized off the dispatcher, the rest (from offset on)
+	// needs the tile and is loaded afterwards
+	std::vector<Item*> items;
+	// items with a unique id and broken items, both are dealt with on the loading thread
+	std::vector<Item*> uniqueItems;
+	std::vector<Item*> discarded;
+	uint32_t remaining = 0;
+	size_t offset = 0;
+};
+
+Item* IOMapSerialize::parseItem(PropStream& propStream, std::vector<Item*>& discarded)
+{
+	uint16_t id;
+	if (!propStream.read<uint16_t>(id)) {
+		return nullptr;
+	}
+
+	Item* item = Item::CreateItem(id);
+	if (!item) {
+		return nullptr;
+	}
+
+	if (!item->unserializeAttr(propStream)) {
+		console::reportWarning("IOMapSerialize::loadHouseItems", fmt::format("Failed to unserialize item id {:d}!", id));
+		discarded.push_back(item);
+		return nullptr;
+	}
+
+	if (Container* container = item->getContainer()) {
+		while (container->serializationCount > 0) {
+			Item* child = parseItem(propStream, discarded);
+			if (!child) {
+				console::reportWarning("IOMapSerialize::loadHouseItems", fmt::format("Unserialization error for container item {:d}!", id));
+				discarded.push_back(item);
+				return nullptr;
+			}
+
+			container->internalAddThing(child);
+			container->serializationCount--;
+		}
+
+		uint8_t endAttr;
+		if (!propStream.read<uint8_t>(endAttr) || endAttr != 0) {
+			console::reportWarning("IOMapSerialize::loadHouseItems", fmt::format("Unserialization error for container item {:d}!", id));
+			discarded.push_back(item);
+			return nullptr;
+		}
+	}
+	return item;
+}
+
+void IOMapSerialize::parseHouseTile(HouseTileData& tileData)
+{
+	PropStream propStream;
+	propStream.init(tileData.data.data(), tileData.data.size());
+
+	if (!propStream.read<uint16_t>(tileData.x) || !propStream.read<uint16_t>(tileData.y) || !propStream.read<uint8_t>(tileData.z)) {
+		return;
+	}
+
+	uint32_t itemCount;
+	if (!propStream.read<uint32_t>(itemCount)) {
+		return;
+	}
+
+	tileData.valid = true;
+
+	for (; itemCount > 0; --itemCount) {
+		// stationary items (doors, beds, ...) are matched against the map's tile
+		// items, which has to happen on the dispatcher
+		PropStream peekStream = propStream;
+		uint16_t id;
+		if (!peekStream.read<uint16_t>(id)) {
+			itemCount = 0;
+			break;
+		}
+
+		const ItemType& iType = Item::items[id];
+		if (!(iType.moveable || iType.forceSerialize) || iType.isBed()) {
+			break;
+		}
+
+		Item* item = parseItem(propStream, tileData.discarded);
+		if (!item) {
+			itemCount = 0;
+			break;
+		}
+		tileData.items.push_back(item);
+	}
+
+	tileData.remaining = itemCount;
+	tileData.offset = tileData.data.size() - propStream.size();
+}
+
+void IOMapSerialize::registerUniqueItems(HouseTileData& tileData)
+{
+	// items dropped while parsing never reach the game, neither do their unique ids
+	std::unordered_set<const Item*> dropped;
+	for (Item* item : tileData.discarded) {
+		dropped.insert(item);
+		if (const Container* container = item->getContainer()) {
+			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
+				dropped.insert(*it);
+			}
+		}
+	}
+
+	for (Item* item : tileData.uniqueItems) {
+		if (dropped.find(item) == dropped.end() && !g_game.addUniqueItem(item->getUniqueId(), item)) {
+			item->removeAttribute(ITEM_ATTRIBUTE_UNIQUEID);
+		}
+	}
+
+	for (Item* item : tileData.discarded) {
+		item->decrementReferenceCounter();
+	}
+}
+
 void IOMapSerialize::loadHouseItems(Map* map)
 {
-	//int64_t start = OTSYS_TIME();
+	int64_t start = OTSYS_TIME();
 
-	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `data` FROM `tile_store`");
+	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `house_id`, `data` FROM `tile_store`");
 	if (!result) {
 		return;
 	}
 
-	uint64_t houseItemCount = 0;
+	std::vector<HouseTileData> tiles;
 	do {
 		unsigned long attrSize;
 		const char* attr = result->getStream("data", attrSize);
 
-		PropStream propStream;
-		propStream.init(attr, attrSize);
+		HouseTileData& tileData = tiles.emplace_back();
+		tileData.data.assign(attr, attrSize);
+		tileData.houseId = result->getNumber<uint32_t>("house_id");
+	} while (result->next());
+	result.reset();
 
-		uint16_t x, y;
-		uint8_t z;
-		if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
-			continue;
-		}
+	// unserialize the rows on the worker pool, the items are only placed afterwards
+	g_workerPool.parallelFor(tiles.size(), [&tiles](size_t i) {
+		Item::deferredUniqueItems = &tiles[i].uniqueItems;
+		parseHouseTile(tiles[i]);
+		Item::deferredUniqueItems = nullptr;
+	});
 
-		Tile* tile = map->getTile(x, y, z);
+	uint64_t houseItemCount = 0;
+	std::set<uint32_t> staleHouseIds;
+	for (HouseTileData& tileData : tiles) {
+		Tile* tile = tileData.valid ? map->getTile(tileData.x, tileData.y, tileData.z) : nullptr;
 		if (!tile) {
+			for (Item* item : tileData.items) {
+				item->decrementReferenceCounter();
+			}
+			for (Item* item : tileData.discarded) {
+				item->decrementReferenceCounter();
+			}
 			continue;
 		}
 
-		uint32_t item_count;
-		if (!propStream.read<uint32_t>(item_count)) {
-			continue;
+		registerUniqueItems(tileData);
+
+		HouseTile* houseTile = dynamic_cast<HouseTile*>(tile);
+		if (!houseTile || houseTile->getHouse()->getId() != tileData.houseId) {
+			// the map changed since the last save, rewrite the house the items are on now
+			if (houseTile) {
+				staleHouseIds.insert(houseTile->getHouse()->getId());
+			}
+			staleHouseIds.insert(tileData.houseId);
 		}
 
-		houseItemCount += item_count;
+		for (Item* item : tileData.items) {
+			tile->internalAddThing(item);
+			item->startDecaying();
+		}
 
-		while (item_count--) {
+		PropStream propStream;
+		propStream.init(tileData.data.data() + tileData.offset, tileData.data.size() - tileData.offset);
+		for (uint32_t i = 0; i < tileData.remaining; ++i) {
 			loadItem(propStream, tile);
 		}
-	} while (result->next());
-	//std::cout << "> Loaded house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
+
+		houseItemCount += tileData.items.size() + tileData.remaining;
+	}
+
+	// tile_store is in sync now, except for houses the map moved items to
+	for (const auto& it : map->houses.getHouses()) {
+		if (staleHouseIds.find(it.first) == staleHouseIds.end()) {
+			it.second->clearDirty();
+		} else {
+			it.second->markDirty();
+		}
+	}
+
+	// rows of houses that no longer exist would never be rewritten
+	std::string removedHouseIds;
+	for (uint32_t houseId : staleHouseIds) {
+		if (!map->houses.getHouse(houseId)) {
+			if (!removedHouseIds.empty()) {
+				removedHouseIds.push_back(',');
+			}
+			removedHouseIds += std::to_string(houseId);
+		}
+	}
+
+	if (!removedHouseIds.empty()) {
+		Database::getInstance().executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` IN ({:s})", removedHouseIds));
+	}
 
 	console::print(CONSOLEMESSAGE_TYPE_STARTUP, "");
 	console::printWorldInfo("House items", std::to_string(houseItemCount));
+	console::printWorldInfo("House items loaded in", fmt::format("{:d} ms ({:d} threads)", OTSYS_TIME() - start, g_workerPool.getThreadCount() + 1));
 }
 
 bool IOMapSerialize::saveHouseItems()
 {
-	//int64_t start = OTSYS_TIME();
+	std::vector<House*> dirtyHouses;
+	std::string dirtyHouseIds;
+	for (const auto& it : g_game.map.houses.getHouses()) {
+		House* house = it.second;
+		if (!house->isDirty()) {
+			continue;
+		}
+
+		if (!dirtyHouseIds.empty()) {
+			dirtyHouseIds.push_back(',');
+		}
+		dirtyHouseIds += std::to_string(house->getId());
+		dirtyHouses.push_back(house);
+	}
+
+	if (dirtyHouses.empty()) {
+		return true;
+	}
+
 	Database& db = Database::getInstance();
 
 	//Start the transaction
@@ -66,28 +262,17 @@ bool IOMapSerialize::saveHouseItems()
 		return false;
 	}
 
-	//clear old tile data
-	if (!db.executeQuery("DELETE FROM `tile_store`")) {
+	//clear old tile data of the changed houses only
+	if (!db.executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` IN ({:s})", dirtyHouseIds))) {
 		return false;
 	}
 
 	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
 
 	PropWriteStream stream;
-	for (const auto& it : g_game.map.houses.getHouses()) {
-		//save house items
-		House* house = it.second;
-		for (HouseTile* tile : house->getTiles()) {
-			saveTile(stream, tile);
-
-			size_t attributesSize;
-			const char* attributes = stream.getStream(attributesSize);
-			if (attributesSize > 0) {
-				if (!stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeBlob(attributes, attributesSize)))) {
-					return false;
-				}
-				stream.clear();
-			}
+	for (House* house : dirtyHouses) {
+		if (!saveHouseTiles(stmt, stream, house)) {
+			return false;
 		}
 	}
 
@@ -96,9 +281,32 @@ bool IOMapSerialize::saveHouseItems()
 	}
 
 	//End the transaction
-	bool success = transaction.commit();
-	//std::cout << "> Saved house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
-	return success;
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	for (House* house : dirtyHouses) {
+		house->clearDirty();
+	}
+	return true;
+}
+
+bool IOMapSerialize::saveHouseTiles(DBInsert& stmt, PropWriteStream& stream, const House* house)
+{
+	Database& db = Database::getInstance();
+	for (HouseTile* tile : house->getTiles()) {
+		saveTile(stream, tile);
+
+		size_t attributesSize;
+		const char* attributes = stream.getStream(attributesSize);
+		if (attributesSize > 0) {
+			if (!stmt.addRow(fmt::format("{:d}, {:s}", house->getId(), db.escapeBlob(attributes, attributesSize)))) {
+				return false;
+			}
+			stream.clear();
+		}
+	}
+	return true;
 }
 
 bool IOMapSerialize::loadContainer(PropStream& propStream, Container* container)
@@ -369,17 +577,8 @@ bool IOMapSerialize::saveHouse(House* house)
 	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
 
 	PropWriteStream stream;
-	for (HouseTile* tile : house->getTiles()) {
-		saveTile(stream, tile);
-
-		size_t attributesSize;
-		const char* attributes = stream.getStream(attributesSize);
-		if (attributesSize > 0) {
-			if (!stmt.addRow(fmt::format("{:d}, {:s}", houseId, db.escapeBlob(attributes, attributesSize)))) {
-				return false;
-			}
-			stream.clear();
-		}
+	if (!saveHouseTiles(stmt, stream, house)) {
+		return false;
 	}
 
 	if (!stmt.execute()) {
@@ -387,5 +586,10 @@ bool IOMapSerialize::saveHouse(House* house)
 	}
 
 	//End the transaction
-	return transaction.commit();
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	house->clearDirty();
+	return true;
 }
@@ -6,6 +6,7 @@
 
 class Container;
 class Cylinder;
+class DBInsert;
 class House;
 class Item;
 class Map;
@@ -13,6 +14,8 @@ class PropStream;
 class PropWriteStream;
 class Tile;
 
+struct HouseTileData;
+
 class IOMapSerialize
 {
 	public:
@@ -26,9 +29,15 @@ class IOMapSerialize
 	private:
 		static void saveItem(PropWriteStream& stream, const Item* item);
 		static void saveTile(PropWriteStream& stream, const Tile* tile);
+		static bool saveHouseTiles(DBInsert& stmt, PropWriteStream& stream, const House* house);
 
 		static bool loadContainer(PropStream& propStream, Container* container);
 		static bool loadItem(PropStream& propStream, Cylinder* parent);
+
+		// thread-safe parsing of tile_store rows, see loadHouseItems
+		static Item* parseItem(PropStream& propStream, std::vector<Item*>& discarded);
+		static void parseHouseTile(HouseTileData& tileData);
+		static void registerUniqueItems(HouseTileData& tileData);
 };
 
 #endif
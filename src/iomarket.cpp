@@ -19,27 +19,38 @@ MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId
 {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `tier`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d} AND `tier` = {:d}", action, itemId, tier));
-	if (!result) {
+	const IOMarket& market = getInstance();
+	auto it = market.books[action].find({itemId, tier});
+	if (it == market.books[action].end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	do {
+	auto addOffer = [&](uint32_t offerId) {
+		const MarketOfferEx& offerEx = market.offers.at(offerId);
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
-		} else {
-			offer.playerName = "Anonymous";
-		}
-		offer.tier = static_cast<uint8_t>(result->getNumber<uint16_t>("tier"));
+		offer.amount = offerEx.amount;
+		offer.price = offerEx.price;
+		offer.timestamp = offerEx.timestamp + marketOfferDuration;
+		offer.counter = offerEx.counter;
+		offer.itemId = offerEx.itemId;
+		offer.playerName = offerEx.playerName;
+		offer.tier = offerEx.tier;
 		offerList.push_back(offer);
-	} while (result->next());
+	};
+
+	// best price first
+	if (action == MARKETACTION_BUY) {
+		for (auto offerIt = it->second.rbegin(), offerEnd = it->second.rend(); offerIt != offerEnd; ++offerIt) {
+			addOffer(offerIt->second);
+		}
+	} else {
+		for (const auto& offer : it->second) {
+			addOffer(offer.second);
+		}
+	}
 	return offerList;
 }
 
@@ -47,23 +58,29 @@ MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId)
 {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `amount`, `price`, `tier`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d} ORDER BY ID DESC", playerId, action));
-	if (!result) {
+	const IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return offerList;
 	}
 
-	do {
+	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+
+	for (auto offerIt = it->second.rbegin(), offerEnd = it->second.rend(); offerIt != offerEnd; ++offerIt) {
+		const MarketOfferEx& offerEx = market.offers.at(*offerIt);
+		if (offerEx.type != action) {
+			continue;
+		}
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.tier = static_cast<uint8_t>(result->getNumber<uint16_t>("tier"));
+		offer.amount = offerEx.amount;
+		offer.price = offerEx.price;
+		offer.timestamp = offerEx.timestamp + marketOfferDuration;
+		offer.counter = offerEx.counter;
+		offer.itemId = offerEx.itemId;
+		offer.tier = offerEx.tier;
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
@@ -96,109 +113,114 @@ HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t p
 	return offerList;
 }
 
-void IOMarket::processExpiredOffers(DBResult_ptr result, bool)
+void IOMarket::processExpiredOffer(uint32_t offerId)
 {
-	if (!result) {
+	MarketOfferEx offer = getInstance().offers.at(offerId);
+	if (!IOMarket::moveOfferToHistory(offerId, OFFERSTATE_EXPIRED)) {
 		return;
 	}
 
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
-			continue;
+	const uint32_t playerId = offer.playerId;
+	const uint16_t amount = offer.amount;
+	const uint8_t tier = offer.tier;
+	if (offer.type == MARKETACTION_SELL) {
+		const ItemType& itemType = Item::items[offer.itemId];
+		if (itemType.id == 0) {
+			return;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		const uint8_t tier = static_cast<uint8_t>(result->getNumber<uint16_t>("tier"));
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
-			if (itemType.id == 0) {
-				continue;
+		Player* player = g_game.getPlayerByGUID(playerId);
+		if (!player) {
+			player = new Player(nullptr);
+			if (!IOLoginData::loadPlayerById(player, playerId)) {
+				delete player;
+				return;
 			}
+		}
 
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (!player) {
-				player = new Player(nullptr);
-				if (!IOLoginData::loadPlayerById(player, playerId)) {
-					delete player;
-					continue;
-				}
-			}
+		if (itemType.id != ITEM_STORE_COIN) {
+			// normal offer
+			if (itemType.stackable) {
+				uint16_t tmpAmount = amount;
+				while (tmpAmount > 0) {
+					uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
+					Item* item = Item::CreateItem(itemType.id, stackCount);
+					if (tier != 0) {
+						item->setIntAttr(ITEM_ATTRIBUTE_TIER, tier);
+					}
 
-			if (itemType.id != ITEM_STORE_COIN) {
-				// normal offer
-				if (itemType.stackable) {
-					uint16_t tmpAmount = amount;
-					while (tmpAmount > 0) {
-						uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
-						Item* item = Item::CreateItem(itemType.id, stackCount);
-						if (tier != 0) {
-							item->setIntAttr(ITEM_ATTRIBUTE_TIER, tier);
-						}
-
-						if (g_game.internalAddItem(player->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-							delete item;
-							break;
-						}
-
-						tmpAmount -= stackCount;
+					if (g_game.internalAddItem(player->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+						delete item;
+						break;
 					}
+
+					tmpAmount -= stackCount;
+				}
+			} else {
+				int32_t subType;
+				if (itemType.charges != 0) {
+					subType = itemType.charges;
 				} else {
-					int32_t subType;
-					if (itemType.charges != 0) {
-						subType = itemType.charges;
-					} else {
-						subType = -1;
-					}
+					subType = -1;
+				}
 
-					for (uint16_t i = 0; i < amount; ++i) {
-						Item* item = Item::CreateItem(itemType.id, subType);
-						if (tier != 0) {
-							item->setIntAttr(ITEM_ATTRIBUTE_TIER, tier);
-						}
+				for (uint16_t i = 0; i < amount; ++i) {
+					Item* item = Item::CreateItem(itemType.id, subType);
+					if (tier != 0) {
+						item->setIntAttr(ITEM_ATTRIBUTE_TIER, tier);
+					}
 
-						if (g_game.internalAddItem(player->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-							delete item;
-							break;
-						}
+					if (g_game.internalAddItem(player->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+						delete item;
+						break;
 					}
 				}
-			} else {
-				// store coin offer
-				if (IOLoginData::getAccountIdByPlayerId(playerId) != 0) {
-					// re-add coins
-					player->addAccountResource(ACCOUNTRESOURCE_STORE_COINS, amount);
-					player->saveAccountResource(ACCOUNTRESOURCE_STORE_COINS);
-
-					// save
-					if (!player->isOffline()) {
-						IOLoginData::savePlayer(player);
-					}
+			}
+		} else {
+			// store coin offer
+			if (IOLoginData::getAccountIdByPlayerId(playerId) != 0) {
+				// re-add coins
+				player->addAccountResource(ACCOUNTRESOURCE_STORE_COINS, amount);
+				player->saveAccountResource(ACCOUNTRESOURCE_STORE_COINS);
+
+				// save
+				if (!player->isOffline()) {
+					IOLoginData::savePlayer(player);
 				}
 			}
+		}
 
-			if (player->isOffline()) {
-				IOLoginData::savePlayer(player);
-				delete player;
-			}
-		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
+		if (player->isOffline()) {
+			IOLoginData::savePlayer(player);
+			delete player;
+		}
+	} else {
+		uint64_t totalPrice = offer.price * amount;
 
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (player) {
-				player->setBankBalance(player->getBankBalance() + totalPrice);
-			} else {
-				IOLoginData::increaseBankBalance(playerId, totalPrice);
-			}
+		Player* player = g_game.getPlayerByGUID(playerId);
+		if (player) {
+			player->setBankBalance(player->getBankBalance() + totalPrice);
+		} else {
+			IOLoginData::increaseBankBalance(playerId, totalPrice);
 		}
-	} while (result->next());
+	}
 }
 
 void IOMarket::checkExpiredOffers()
 {
 	const time_t lastExpireDate = time(nullptr) - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	g_databaseTasks.addTask(fmt::format("SELECT `id`, `amount`, `price`, `tier`, `itemtype`, `player_id`, `sale` FROM `market_offers` WHERE `created` <= {:d}", lastExpireDate), IOMarket::processExpiredOffers, true);
+	std::vector<uint32_t> expiredOffers;
+	for (const auto& it : getInstance().offersByCreation) {
+		if (it.first > lastExpireDate) {
+			break;
+		}
+		expiredOffers.push_back(it.second);
+	}
+
+	for (uint32_t offerId : expiredOffers) {
+		processExpiredOffer(offerId);
+	}
 
 	int32_t checkExpiredMarketOffersEachMinutes = g_config.getNumber(ConfigManager::CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
 	if (checkExpiredMarketOffersEachMinutes <= 0) {
@@ -210,60 +232,81 @@ void IOMarket::checkExpiredOffers()
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
-	if (!result) {
+	const IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return it->second.size();
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
 {
-	MarketOfferEx offer;
+	const uint32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	const int32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format("SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `tier`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1", created, counter));
-	if (!result) {
-		offer.id = 0;
-		offer.playerId = 0;
-		return offer;
+	const IOMarket& market = getInstance();
+	for (auto it = market.offersByCreation.lower_bound({created, 0}), end = market.offersByCreation.end(); it != end && it->first == created; ++it) {
+		if ((it->second & 0xFFFF) == counter) {
+			return market.offers.at(it->second);
+		}
 	}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint64_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	offer.tier = static_cast<uint8_t>(result->getNumber<uint16_t>("tier"));
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
-	} else {
-		offer.playerName = "Anonymous";
-	}
+	MarketOfferEx offer;
+	offer.id = 0;
+	offer.playerId = 0;
 	return offer;
 }
 
 void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint8_t tier, uint64_t price, bool anonymous)
 {
-	Database::getInstance().executeQuery(fmt::format("INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `tier`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, action, itemId, amount, tier, price, time(nullptr), anonymous));
+	IOMarket& market = getInstance();
+
+	MarketOfferEx offer;
+	offer.id = market.nextOfferId++;
+	offer.playerId = playerId;
+	offer.timestamp = time(nullptr);
+	offer.price = price;
+	offer.amount = amount;
+	offer.counter = offer.id & 0xFFFF;
+	offer.itemId = itemId;
+	offer.tier = tier;
+	offer.type = action;
+	if (anonymous) {
+		offer.playerName = "Anonymous";
+	} else if (Player* player = g_game.getPlayerByGUID(playerId)) {
+		offer.playerName = player->getName();
+	} else {
+		offer.playerName = IOLoginData::getNameByGuid(playerId);
+	}
+
+	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `tier`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", offer.id, playerId, action, itemId, amount, tier, price, offer.timestamp, anonymous));
+	market.addOffer(std::move(offer));
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount)
 {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	it->second.amount -= amount;
+	g_databaseTasks.addTask(fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
 }
 
 void IOMarket::deleteOffer(uint32_t offerId)
 {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	getInstance().removeOffer(offerId);
+	g_databaseTasks.addTask(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint8_t tier, uint64_t price, time_t timestamp, MarketOfferState_t state)
 {
+	if (state == OFFERSTATE_ACCEPTED) {
+		getInstance().addStatistics(type, itemId, tier, price);
+	}
+
 	g_databaseTasks.addTask(fmt::format("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `tier`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})", playerId, type, itemId, amount, tier, price, timestamp, time(nullptr), state));
 }
 
@@ -271,19 +314,84 @@ bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 {
 	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	Database& db = Database::getInstance();
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return false;
+	}
+
+	const MarketOfferEx offer = it->second;
+	deleteOffer(offerId);
+
+	appendHistory(offer.playerId, offer.type, offer.itemId, offer.amount, offer.tier, offer.price, offer.timestamp + marketOfferDuration, state);
+	return true;
+}
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `player_id`, `sale`, `itemtype`, `amount`, `tier`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}", offerId));
+void IOMarket::loadOffers()
+{
+	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `id`, `player_id`, `sale`, `itemtype`, `amount`, `created`, `price`, `tier`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers`");
 	if (!result) {
-		return false;
+		return;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
-		return false;
+	do {
+		MarketOfferEx offer;
+		offer.id = result->getNumber<uint32_t>("id");
+		offer.playerId = result->getNumber<uint32_t>("player_id");
+		offer.timestamp = result->getNumber<uint32_t>("created");
+		offer.price = result->getNumber<uint64_t>("price");
+		offer.amount = result->getNumber<uint16_t>("amount");
+		offer.counter = offer.id & 0xFFFF;
+		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.tier = static_cast<uint8_t>(result->getNumber<uint16_t>("tier"));
+		offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
+		if (result->getNumber<uint16_t>("anonymous") == 0) {
+			offer.playerName = result->getString("player_name");
+		} else {
+			offer.playerName = "Anonymous";
+		}
+
+		nextOfferId = std::max(nextOfferId, offer.id + 1);
+		addOffer(std::move(offer));
+	} while (result->next());
+}
+
+void IOMarket::addOffer(MarketOfferEx&& offer)
+{
+	books[offer.type][{offer.itemId, offer.tier}].emplace(offer.price, offer.id);
+	playerOffers[offer.playerId].insert(offer.id);
+	offersByCreation.emplace(offer.timestamp, offer.id);
+	offers.emplace(offer.id, std::move(offer));
+}
+
+void IOMarket::removeOffer(uint32_t offerId)
+{
+	auto it = offers.find(offerId);
+	if (it == offers.end()) {
+		return;
 	}
 
-	appendHistory(result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")), result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"), result->getNumber<uint16_t>("tier"), result->getNumber<uint64_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
-	return true;
+	const MarketOfferEx& offer = it->second;
+
+	MarketBook& book = books[offer.type];
+	auto bookIt = book.find({offer.itemId, offer.tier});
+	if (bookIt != book.end()) {
+		bookIt->second.erase({offer.price, offer.id});
+		if (bookIt->second.empty()) {
+			book.erase(bookIt);
+		}
+	}
+
+	auto playerIt = playerOffers.find(offer.playerId);
+	if (playerIt != playerOffers.end()) {
+		playerIt->second.erase(offer.id);
+		if (playerIt->second.empty()) {
+			playerOffers.erase(playerIt);
+		}
+	}
+
+	offersByCreation.erase({offer.timestamp, offer.id});
+	offers.erase(it);
 }
 
 void IOMarket::updateStatistics()
@@ -308,6 +416,21 @@ void IOMarket::updateStatistics()
 	} while (result->next());
 }
 
+void IOMarket::addStatistics(MarketAction_t type, uint16_t itemId, uint8_t tier, uint64_t price)
+{
+	MarketStatistics& statistics = type == MARKETACTION_BUY ? purchaseStatistics[{itemId, tier}] : saleStatistics[{itemId, tier}];
+	if (statistics.numTransactions == 0 || price < statistics.lowestPrice) {
+		statistics.lowestPrice = price;
+	}
+
+	if (price > statistics.highestPrice) {
+		statistics.highestPrice = price;
+	}
+
+	statistics.totalPrice += price;
+	++statistics.numTransactions;
+}
+
 MarketStatistics* IOMarket::getPurchaseStatistics(uint16_t itemId, uint8_t tier)
 {
 	return &purchaseStatistics[{itemId, tier}];
@@ -19,7 +19,6 @@ class IOMarket
 		static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
 		static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
 
-		static void processExpiredOffers(DBResult_ptr result, bool);
 		static void checkExpiredOffers();
 
 		static uint32_t getPlayerOfferCount(uint32_t playerId);
@@ -32,6 +31,7 @@ class IOMarket
 		static void appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint8_t tier, uint64_t price, time_t timestamp, MarketOfferState_t state);
 		static bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state);
 
+		void loadOffers();
 		void updateStatistics();
 
 		MarketStatistics* getPurchaseStatistics(uint16_t itemId, uint8_t tier);
@@ -40,6 +40,23 @@ class IOMarket
 	private:
 		IOMarket() = default;
 
+		static void processExpiredOffer(uint32_t offerId);
+
+		void addOffer(MarketOfferEx&& offer);
+		void removeOffer(uint32_t offerId);
+		void addStatistics(MarketAction_t type, uint16_t itemId, uint8_t tier, uint64_t price);
+
+		// (price, offer id) of the active offers of an item and tier
+		using MarketBook = std::unordered_map<std::pair<uint16_t, uint8_t>, std::set<std::pair<uint64_t, uint32_t>>, ItemTypeTierHash>;
+
+		// active offers are kept in memory, the database is written behind on the database thread
+		std::unordered_map<uint32_t, MarketOfferEx> offers;
+		std::array<MarketBook, MARKETACTION_SELL + 1> books;
+		std::unordered_map<uint32_t, std::set<uint32_t>> playerOffers;
+		// (created, offer id), oldest first
+		std::set<std::pair<uint32_t, uint32_t>> offersByCreation;
+		uint32_t nextOfferId = 1;
+
 		std::unordered_map<std::pair<uint16_t, uint8_t>, MarketStatistics, ItemTypeTierHash> purchaseStatistics;
 		std::unordered_map<std::pair<uint16_t, uint8_t>, MarketStatistics, ItemTypeTierHash> saleStatistics;
 };
@@ -22,6 +22,7 @@ extern Spells* g_spells;
 extern Vocations g_vocations;
 
 Items Item::items;
+thread_local std::vector<Item*>* Item::deferredUniqueItems = nullptr;
 
 Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
 {
@@ -156,6 +157,11 @@ Item::Item(const uint16_t type, uint16_t count /*= 0*/) :
 	setDefaultDuration();
 }
 
+Item::~Item()
+{
+	LuaScriptInterface::removeCachedUserdata(this);
+}
+
 Item::Item(const Item& i) :
 	Thing(), id(i.id), count(i.count), loadedFromMap(i.loadedFromMap)
 {
@@ -178,6 +184,15 @@ Item* Item::clone() const
 	return item;
 }
 
+void Item::update()
+{
+	Cylinder* parent = getParent();
+	if (parent) {
+		parent->updateThing(this, getID(), getSubType());
+		House::markItemDirty(this);
+	}
+}
+
 bool Item::equals(const Item* otherItem) const
 {
 	if (!otherItem || id != otherItem->id) {
@@ -1081,6 +1096,12 @@ void Item::setUniqueId(uint16_t n)
 		return;
 	}
 
+	if (deferredUniqueItems) {
+		getAttributes()->setUniqueId(n);
+		deferredUniqueItems->push_back(this);
+		return;
+	}
+
 	if (g_game.addUniqueItem(n, this)) {
 		getAttributes()->setUniqueId(n);
 	}
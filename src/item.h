@@ -547,24 +547,23 @@ class Item : virtual public Thing
 		static Item* CreateItem(PropStream& propStream);
 		static Items items;
 
+		// set while items are unserialized off the dispatcher, unique ids read on this
+		// thread are collected here and registered with the game by the caller
+		static thread_local std::vector<Item*>* deferredUniqueItems;
+
 		// Constructor for items
 		Item(const uint16_t type, uint16_t count = 0);
 		Item(const Item& i);
 		virtual Item* clone() const;
 
-		virtual ~Item() = default;
+		virtual ~Item();
 
 		// non-assignable
 		Item& operator=(const Item&) = delete;
 
 		bool equals(const Item* otherItem) const;
 
-		void update() {
-			Cylinder* parent = getParent();
-			if (parent) {
-				parent->updateThing(this, getID(), getSubType());
-			}
-		}
+		void update();
 
 		Item* getItem() override final {
 			return this;
@@ -0,0 +1,348 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "journal.h"
+#include "configmanager.h"
+#include "databasetasks.h"
+#include "fileloader.h"
+
+#include <boost/crc.hpp>
+#include <fstream>
+
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+extern ConfigManager g_config;
+
+namespace {
+
+// records are only dropped from the file once all of them reached the database
+constexpr size_t JOURNAL_TRUNCATE_SIZE = 4 * 1024 * 1024;
+// wake the journal thread early once this much is waiting to be written
+constexpr size_t JOURNAL_BUFFER_SIZE = 1024 * 1024;
+
+uint32_t checksum(const char* data, size_t size)
+{
+	boost::crc_32_type crc;
+	crc.process_bytes(data, size);
+	return crc.checksum();
+}
+
+std::string sequenceQuery(uint64_t sequence)
+{
+	return fmt::format("INSERT INTO `server_config` (`config`, `value`) VALUES ('journal_sequence', '{:d}') ON DUPLICATE KEY UPDATE `value` = VALUES(`value`)", sequence);
+}
+
+}
+
+bool Journal::open()
+{
+	fileName = g_config.getString(ConfigManager::JOURNAL_FILE);
+	if (fileName.empty()) {
+		return true;
+	}
+
+	syncInterval = std::chrono::milliseconds(std::max<int32_t>(1, g_config.getNumber(ConfigManager::JOURNAL_SYNC_INTERVAL)));
+
+	uint64_t applied = 0;
+	if (DBResult_ptr result = Database::getInstance().storeQuery("SELECT `value` FROM `server_config` WHERE `config` = 'journal_sequence'")) {
+		applied = result->getNumber<uint64_t>("value");
+	}
+
+	if (!replay(applied)) {
+		return false;
+	}
+
+	// everything in the old file is in the database now
+	file = std::fopen(fileName.c_str(), "wb");
+	if (!file) {
+		console::reportError("Journal::open", fmt::format("Unable to open journal file {:s}.", fileName));
+		return false;
+	}
+
+	enabled = true;
+	start();
+	return true;
+}
+
+bool Journal::replay(uint64_t applied)
+{
+	nextSequence = applied + 1;
+	lastSequence = applied;
+	appliedSequence = applied;
+	processedSequence = applied;
+
+	std::ifstream journalFile(fileName, std::ios::binary);
+	if (!journalFile) {
+		return true;
+	}
+
+	std::string contents((std::istreambuf_iterator<char>(journalFile)), std::istreambuf_iterator<char>());
+	if (journalFile.bad()) {
+		console::reportError("Journal::replay", fmt::format("Unable to read journal file {:s}.", fileName));
+		return false;
+	}
+
+	PropStream propStream;
+	propStream.init(contents.data(), contents.size());
+
+	Database& db = Database::getInstance();
+
+	uint32_t replayed = 0;
+	std::vector<std::string> queries;
+	while (propStream.size() > 0) {
+		const char* record = contents.data() + (contents.size() - propStream.size());
+
+		uint32_t size, crc;
+		if (!propStream.read<uint32_t>(size) || !propStream.read<uint32_t>(crc) || propStream.size() < size || checksum(record + 8, size) != crc) {
+			// a crash while the last batch was written leaves a torn record behind
+			console::reportWarning("Journal::replay", fmt::format("Ignoring incomplete record at the end of {:s}.", fileName));
+			break;
+		}
+
+		PropStream recordStream;
+		recordStream.init(record + 8, size);
+		propStream.skip(size);
+
+		uint64_t sequence;
+		uint32_t count;
+		if (!recordStream.read<uint64_t>(sequence) || !recordStream.read<uint32_t>(count)) {
+			continue;
+		}
+
+		lastSequence = std::max(lastSequence, sequence);
+		if (sequence <= applied) {
+			continue;
+		}
+
+		queries.clear();
+		while (count--) {
+			uint32_t length;
+			if (!recordStream.read<uint32_t>(length) || recordStream.size() < length) {
+				break;
+			}
+
+			const char* query = record + 8 + (size - recordStream.size());
+			queries.emplace_back(query, length);
+			recordStream.skip(length);
+		}
+
+		apply(db, sequence, queries);
+		if (failedSequence != 0) {
+			break;
+		}
+		++replayed;
+	}
+
+	// reopening would truncate the records that are not in the database yet
+	if (failedSequence != 0) {
+		console::reportError("Journal::replay", fmt::format("Journal record {:d} could not be applied, {:s} is kept for the next start.", failedSequence, fileName));
+		return false;
+	}
+
+	nextSequence = lastSequence + 1;
+	appliedSequence = lastSequence;
+	processedSequence = lastSequence;
+
+	if (replayed != 0) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Replayed {:d} journal records.", replayed));
+	}
+	return true;
+}
+
+bool Journal::record(const std::function<bool()>& save, uint32_t playerId/* = 0*/)
+{
+	Database& db = Database::getInstance();
+	if (!enabled || db.isCapturing()) {
+		return save();
+	}
+
+	std::vector<std::string> queries;
+	db.beginCapture(queries);
+	bool success = save();
+	db.endCapture();
+
+	if (!success || queries.empty()) {
+		return success;
+	}
+
+	uint64_t sequence = nextSequence++;
+
+	PropWriteStream payload;
+	payload.write<uint64_t>(sequence);
+	payload.write<uint32_t>(queries.size());
+	for (const std::string& query : queries) {
+		payload.write<uint32_t>(query.size());
+		payload.writeBytes(query.data(), query.size());
+	}
+
+	size_t size;
+	const char* data = payload.getStream(size);
+
+	PropWriteStream header;
+	header.write<uint32_t>(size);
+	header.write<uint32_t>(checksum(data, size));
+
+	size_t headerSize;
+	const char* headerData = header.getStream(headerSize);
+
+	bool signal;
+	{
+		std::lock_guard<std::mutex> lockGuard(journalLock);
+		buffer.append(headerData, headerSize);
+		buffer.append(data, size);
+		lastSequence = sequence;
+		++recordCount;
+		recordBytes += headerSize + size;
+		signal = buffer.size() >= JOURNAL_BUFFER_SIZE;
+	}
+
+	if (signal) {
+		journalSignal.notify_one();
+	}
+
+	if (getState() != THREAD_STATE_RUNNING) {
+		console::reportWarning("Journal::record", fmt::format("The journal thread is stopped, record {:d} is only applied to the database.", sequence));
+	}
+
+	if (playerId != 0) {
+		// forget the players whose records are all in the database
+		if (playerSequences.size() >= 1024) {
+			uint64_t processed = processedSequence;
+			for (auto it = playerSequences.begin(); it != playerSequences.end();) {
+				if (it->second <= processed) {
+					it = playerSequences.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+		playerSequences[playerId] = sequence;
+	}
+
+	// the database thread runs jobs in order, so loads on its connection see these writes,
+	// loads on the main connection have to wait for them
+	g_databaseTasks.addJob([this, sequence, queries = std::move(queries)](Database& db) { apply(db, sequence, queries); });
+	return true;
+}
+
+bool Journal::waitForPlayer(uint32_t playerId)
+{
+	auto it = playerSequences.find(playerId);
+	if (it == playerSequences.end()) {
+		return false;
+	}
+
+	uint64_t sequence = it->second;
+	playerSequences.erase(it);
+	if (processedSequence >= sequence) {
+		return false;
+	}
+
+	std::unique_lock<std::mutex> processedLockUnique(processedLock);
+	processedSignal.wait(processedLockUnique, [this, sequence]() { return processedSequence >= sequence; });
+	return true;
+}
+
+void Journal::apply(Database& db, uint64_t sequence, const std::vector<std::string>& queries)
+{
+	// records are not idempotent, the ones after a failed record are left for the next start
+	// so they are applied exactly once, in order, after it
+	if (failedSequence == 0) {
+		bool success = db.executeQuery("BEGIN");
+		for (auto it = queries.begin(), end = queries.end(); success && it != end; ++it) {
+			success = db.executeQuery(*it);
+		}
+
+		if (!success || !db.executeQuery(sequenceQuery(sequence)) || !db.executeQuery("COMMIT")) {
+			db.executeQuery("ROLLBACK");
+
+			console::reportError("Journal::apply", fmt::format("Failed to apply journal record {:d}, it and the records after it stay in the journal.", sequence));
+			failedSequence = sequence;
+		} else {
+			appliedSequence = sequence;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(processedLock);
+		processedSequence = sequence;
+	}
+	processedSignal.notify_all();
+}
+
+void Journal::threadMain()
+{
+	std::unique_lock<std::mutex> journalLockUnique(journalLock);
+	while (getState() != THREAD_STATE_TERMINATED) {
+		journalSignal.wait_for(journalLockUnique, syncInterval);
+		sync(journalLockUnique);
+	}
+
+	// records added while the last sync was running
+	sync(journalLockUnique);
+
+	if (file) {
+		std::fclose(file);
+		file = nullptr;
+	}
+
+	if (recordCount != 0) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Journal: {:d} records ({:d} KB) in {:d} syncs, {:d} us per sync.", recordCount, recordBytes / 1024, syncCount, syncCount != 0 ? syncTime.count() / syncCount : 0));
+	}
+}
+
+void Journal::sync(std::unique_lock<std::mutex>& journalLockUnique)
+{
+	if (buffer.empty()) {
+		if (file && fileSize >= JOURNAL_TRUNCATE_SIZE && appliedSequence >= lastSequence) {
+			file = std::freopen(fileName.c_str(), "wb", file);
+			if (!file) {
+				console::reportError("Journal::sync", fmt::format("Unable to reopen journal file {:s}, journaling stopped.", fileName));
+			}
+			fileSize = 0;
+		}
+		return;
+	}
+
+	std::string pending;
+	pending.swap(buffer);
+	if (!file) {
+		return;
+	}
+
+	journalLockUnique.unlock();
+
+	auto start = std::chrono::steady_clock::now();
+
+	bool success = std::fwrite(pending.data(), 1, pending.size(), file) == pending.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+	success = success && _commit(_fileno(file)) == 0;
+#else
+	success = success && fsync(fileno(file)) == 0;
+#endif
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	journalLockUnique.lock();
+	if (!success) {
+		console::reportError("Journal::sync", fmt::format("Failed to write {:d} bytes to {:s}.", pending.size(), fileName));
+	}
+
+	fileSize += pending.size();
+	syncTime += elapsed;
+	++syncCount;
+}
+
+void Journal::shutdown()
+{
+	journalLock.lock();
+	setState(THREAD_STATE_TERMINATED);
+	journalLock.unlock();
+	journalSignal.notify_one();
+}
@@ -0,0 +1,83 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_JOURNAL_H
+#define FS_JOURNAL_H
+
+#include "thread_holder_base.h"
+
+class Database;
+
+// local write-ahead journal, records are synced to disk in batches and applied to MySQL on the database thread
+class Journal : public ThreadHolder<Journal>
+{
+	public:
+		Journal() = default;
+
+		// replays pending records and starts the journal thread, does nothing
+		// without a journal file configured
+		bool open();
+		void shutdown();
+
+		/**
+		 * Runs save with the queries it executes on the main connection
+		 * diverted into the journal. Without a journal save is simply run.
+		 *
+		 * @param playerId the player whose row save writes, if any
+		 * @return the result of save
+		 */
+		bool record(const std::function<bool()>& save, uint32_t playerId = 0);
+
+		/**
+		 * Blocks until the records saved for a player reached the database,
+		 * so a load on the main connection doesn't read the rows they replace.
+		 *
+		 * @return whether there was a record to wait for
+		 */
+		bool waitForPlayer(uint32_t playerId);
+
+		void threadMain();
+
+	private:
+		bool replay(uint64_t appliedSequence);
+		void sync(std::unique_lock<std::mutex>& journalLockUnique);
+		void apply(Database& db, uint64_t sequence, const std::vector<std::string>& queries);
+
+		std::string fileName;
+		std::FILE* file = nullptr;
+		bool enabled = false;
+		size_t fileSize = 0;
+
+		// encoded records waiting for the next sync
+		std::string buffer;
+		std::chrono::milliseconds syncInterval{200};
+
+		uint64_t nextSequence = 1;
+		uint64_t lastSequence = 0;
+		std::atomic<uint64_t> appliedSequence{0};
+
+		// first record that failed to apply, the records after it are not applied
+		// either and wait in the journal for the next start
+		uint64_t failedSequence = 0;
+
+		// last record the database thread is done with, applied or not
+		std::atomic<uint64_t> processedSequence{0};
+		std::mutex processedLock;
+		std::condition_variable processedSignal;
+
+		// last record of every player saved through the journal, dispatcher only
+		std::map<uint32_t, uint64_t> playerSequences;
+
+		std::mutex journalLock;
+		std::condition_variable journalSignal;
+
+		// write path statistics, printed on shutdown
+		uint64_t recordCount = 0;
+		uint64_t recordBytes = 0;
+		uint64_t syncCount = 0;
+		std::chrono::microseconds syncTime{0};
+};
+
+extern Journal g_journal;
+
+#endif
@@ -0,0 +1,308 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luacache.h"
+#include "configmanager.h"
+#include "fileloader.h"
+#include "workerpool.h"
+
+#include <filesystem>
+#include <fstream>
+
+extern ConfigManager g_config;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// bump when the entry layout changes
+constexpr uint32_t ENTRY_VERSION = 1;
+constexpr uint32_t ENTRY_MAGIC = 0x43425346; // "FSBC"
+
+struct Entry {
+	int64_t mtime = 0;
+	uint64_t size = 0;
+	uint64_t hash = 0;
+	std::string name;
+	std::string bytecode;
+};
+
+uint64_t hashBytes(const char* data, size_t size)
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+uint64_t getBuildTag()
+{
+	// bytecode is specific to the Lua release and its pointer size
+#if defined(LUAJIT_VERSION)
+	static const std::string tag = fmt::format("{:s} {:d} {:d}", LUAJIT_VERSION, sizeof(void*), ENTRY_VERSION);
+#else
+	static const std::string tag = fmt::format("{:s} {:d} {:d}", LUA_RELEASE, sizeof(void*), ENTRY_VERSION);
+#endif
+	static const uint64_t hash = hashBytes(tag.data(), tag.size());
+	return hash;
+}
+
+bool readFile(const std::string& fileName, std::string& contents)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !file.bad();
+}
+
+bool readEntry(const std::string& entryPath, const std::string& name, Entry& entry)
+{
+	std::string contents;
+	if (!readFile(entryPath, contents)) {
+		return false;
+	}
+
+	PropStream propStream;
+	propStream.init(contents.data(), contents.size());
+
+	uint32_t magic;
+	uint64_t tag;
+	if (!propStream.read<uint32_t>(magic) || magic != ENTRY_MAGIC || !propStream.read<uint64_t>(tag) || tag != getBuildTag()) {
+		return false;
+	}
+
+	if (!propStream.read<int64_t>(entry.mtime) || !propStream.read<uint64_t>(entry.size) || !propStream.read<uint64_t>(entry.hash) || !propStream.readString(entry.name)) {
+		return false;
+	}
+
+	// another script with the same path hash
+	if (entry.name != name) {
+		return false;
+	}
+
+	entry.bytecode.assign(contents.data() + (contents.size() - propStream.size()), propStream.size());
+	return !entry.bytecode.empty();
+}
+
+void writeEntry(const std::string& entryPath, const Entry& entry)
+{
+	PropWriteStream propWriteStream;
+	propWriteStream.write<uint32_t>(ENTRY_MAGIC);
+	propWriteStream.write<uint64_t>(getBuildTag());
+	propWriteStream.write<int64_t>(entry.mtime);
+	propWriteStream.write<uint64_t>(entry.size);
+	propWriteStream.write<uint64_t>(entry.hash);
+	propWriteStream.writeString(entry.name);
+	propWriteStream.writeBytes(entry.bytecode.data(), entry.bytecode.size());
+
+	size_t size;
+	const char* data = propWriteStream.getStream(size);
+
+	// written aside and renamed so a reader never sees half an entry
+	std::string tmpPath = entryPath + ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!file || !file.write(data, size)) {
+			console::reportWarning("LuaBytecodeCache::writeEntry", fmt::format("Unable to write {:s}.", tmpPath));
+			return;
+		}
+	}
+
+	std::error_code ec;
+	fs::rename(tmpPath, entryPath, ec);
+	if (ec) {
+		console::reportWarning("LuaBytecodeCache::writeEntry", fmt::format("Unable to replace {:s}: {:s}.", entryPath, ec.message()));
+		fs::remove(tmpPath, ec);
+	}
+}
+
+int writeBytecode(lua_State*, const void* p, size_t size, void* ud)
+{
+	static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+	return 0;
+}
+
+}
+
+void LuaBytecodeCache::configure()
+{
+	directory = g_config.getString(ConfigManager::LUA_BYTECODE_CACHE);
+	if (directory.empty()) {
+		return;
+	}
+
+	std::error_code ec;
+	fs::create_directories(directory, ec);
+	if (ec) {
+		console::reportError("LuaBytecodeCache::configure", fmt::format("Unable to create {:s}: {:s}, scripts are compiled from source.", directory, ec.message()));
+		directory.clear();
+		return;
+	}
+
+	root = fs::current_path(ec).string();
+}
+
+int LuaBytecodeCache::load(lua_State* L, const std::string& file)
+{
+	if (directory.empty()) {
+		return luaL_loadfile(L, file.c_str());
+	}
+	return load(L, file, true);
+}
+
+void LuaBytecodeCache::precompile(const std::string& path)
+{
+	if (directory.empty()) {
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::string> files;
+	std::error_code ec;
+	for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+		if (it->is_regular_file(ec) && it->path().extension() == ".lua") {
+			files.push_back(it->path().generic_string());
+		}
+	}
+
+	uint32_t compiledBefore = compiled;
+	g_workerPool.parallelFor(files.size(), [this, &files](size_t i) {
+		// compiling needs no libraries, every call gets a state of its own
+		lua_State* L = luaL_newstate();
+		if (L) {
+			load(L, files[i], false);
+			lua_close(L);
+		}
+	});
+
+	uint32_t count = compiled - compiledBefore;
+	if (count != 0) {
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Compiled {:d} of {:d} scripts into the bytecode cache in {:d} ms.", count, files.size(), elapsed.count()));
+	}
+}
+
+void LuaBytecodeCache::printStats() const
+{
+	if (!directory.empty()) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Bytecode cache: {:d} scripts loaded from cache, {:d} compiled.", hits.load(), compiled.load()));
+	}
+}
+
+std::string LuaBytecodeCache::getChunkName(const std::string& file) const
+{
+	// scripts/ and monster/ are loaded by absolute path, the rest relative to the working directory
+	fs::path path = fs::path(file).lexically_normal();
+	if (path.is_absolute() && !root.empty()) {
+		fs::path relative = path.lexically_relative(root);
+		if (!relative.empty() && *relative.begin() != "..") {
+			path = std::move(relative);
+		}
+	}
+	return path.generic_string();
+}
+
+std::string LuaBytecodeCache::getEntryPath(const std::string& chunkName) const
+{
+	return fmt::format("{:s}/{:016x}.luac", directory, hashBytes(chunkName.data(), chunkName.size()));
+}
+
+int LuaBytecodeCache::load(lua_State* L, const std::string& file, bool push)
+{
+	std::error_code ec;
+	auto mtime = fs::last_write_time(file, ec);
+	uint64_t size = ec ? 0 : fs::file_size(file, ec);
+	if (ec) {
+		// let Lua tell why the file can't be read
+		return push ? luaL_loadfile(L, file.c_str()) : LUA_ERRFILE;
+	}
+
+	const std::string name = getChunkName(file);
+	const std::string chunkName = '@' + name;
+	const std::string entryPath = getEntryPath(name);
+
+	Entry entry;
+	bool valid = readEntry(entryPath, name, entry);
+
+	int64_t modified = mtime.time_since_epoch().count();
+	if (valid && entry.mtime == modified && entry.size == size) {
+		if (!push) {
+			return 0;
+		}
+
+		if (luaL_loadbuffer(L, entry.bytecode.data(), entry.bytecode.size(), chunkName.c_str()) == 0) {
+			++hits;
+			return 0;
+		}
+
+		// rejected by Lua, compile it again
+		lua_pop(L, 1);
+		valid = false;
+	}
+
+	std::string source;
+	if (!readFile(file, source)) {
+		return push ? luaL_loadfile(L, file.c_str()) : LUA_ERRFILE;
+	}
+
+	// touched but unchanged, only the modification time is stale
+	uint64_t hash = hashBytes(source.data(), source.size());
+	if (valid && entry.hash == hash && entry.size == size) {
+		entry.mtime = modified;
+		if (!push) {
+			writeEntry(entryPath, entry);
+			return 0;
+		}
+
+		if (luaL_loadbuffer(L, entry.bytecode.data(), entry.bytecode.size(), chunkName.c_str()) == 0) {
+			writeEntry(entryPath, entry);
+			++hits;
+			return 0;
+		}
+		lua_pop(L, 1);
+	}
+
+	// skip a leading #! line like luaL_loadfile does, keeping the line numbers
+	if (!source.empty() && source.front() == '#') {
+		source.erase(0, source.find('\n'));
+	}
+
+	int ret = luaL_loadbuffer(L, source.data(), source.size(), chunkName.c_str());
+	if (ret != 0) {
+		// the error is reported once the file is actually loaded
+		if (!push) {
+			lua_pop(L, 1);
+		}
+		return ret;
+	}
+
+	entry.mtime = modified;
+	entry.size = size;
+	entry.hash = hash;
+	entry.name = name;
+	entry.bytecode.clear();
+
+#if LUA_VERSION_NUM >= 503
+	lua_dump(L, writeBytecode, &entry.bytecode, 0);
+#else
+	lua_dump(L, writeBytecode, &entry.bytecode);
+#endif
+
+	if (!entry.bytecode.empty()) {
+		writeEntry(entryPath, entry);
+		++compiled;
+	}
+
+	if (!push) {
+		lua_pop(L, 1);
+	}
+	return 0;
+}
@@ -0,0 +1,47 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUACACHE_H
+#define FS_LUACACHE_H
+
+struct lua_State;
+
+// on-disk cache of compiled script chunks, keyed by path and validated against the source
+class LuaBytecodeCache
+{
+	public:
+		LuaBytecodeCache() = default;
+
+		// non-copyable
+		LuaBytecodeCache(const LuaBytecodeCache&) = delete;
+		LuaBytecodeCache& operator=(const LuaBytecodeCache&) = delete;
+
+		// picks up the cache directory from config.lua
+		void configure();
+		bool isEnabled() const {
+			return !directory.empty();
+		}
+
+		// loads file as a chunk at stack top like luaL_loadfile
+		int load(lua_State* L, const std::string& file);
+
+		// compiles the stale entries of all scripts below path on the worker pool
+		void precompile(const std::string& path);
+
+		void printStats() const;
+
+	private:
+		std::string getChunkName(const std::string& file) const;
+		std::string getEntryPath(const std::string& chunkName) const;
+
+		// loads through the entry, keeping the chunk on the stack only when push is set
+		int load(lua_State* L, const std::string& file, bool push);
+
+		std::string directory;
+		std::string root;
+
+		std::atomic<uint32_t> hits{0};
+		std::atomic<uint32_t> compiled{0};
+};
+
+#endif // FS_LUACACHE_H
@@ -0,0 +1,140 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luacollector.h"
+#include "configmanager.h"
+
+extern ConfigManager g_config;
+
+namespace {
+
+// a cycle starts once the heap doubled since the last one, like Lua's default pause
+constexpr int LUA_GC_PAUSE = 200;
+// the generational collector does a young collection every 20% of growth
+constexpr int LUA_GC_MINOR_MULTIPLIER = 20;
+// twice the pause and the steps are not keeping up with the allocations
+constexpr int LUA_GC_PRESSURE = 2 * LUA_GC_PAUSE;
+// below this the heap is not worth a cycle
+constexpr int LUA_GC_MIN_HEAP = 1024;
+
+// progress is made even when the dispatcher is never idle
+constexpr auto LUA_GC_MIN_BUDGET = std::chrono::microseconds(100);
+
+}
+
+void LuaGarbageCollector::configure()
+{
+	budget = std::chrono::microseconds(std::max<int32_t>(0, g_config.getNumber(ConfigManager::LUA_GC_STEP_BUDGET)));
+#if LUA_VERSION_NUM >= 504
+	generational = g_config.getBoolean(ConfigManager::LUA_GC_GENERATIONAL);
+#else
+	generational = false;
+#endif
+	attach(luaState);
+}
+
+void LuaGarbageCollector::attach(lua_State* L)
+{
+	luaState = L;
+	collecting = false;
+	if (!L) {
+		return;
+	}
+
+#if LUA_VERSION_NUM >= 504
+	if (generational) {
+		lua_gc(L, LUA_GCGEN, 0, 0);
+	} else {
+		lua_gc(L, LUA_GCINC, 0, 0, 0);
+	}
+#endif
+
+	if (isEnabled()) {
+		lua_gc(L, LUA_GCSTOP, 0);
+	} else {
+		lua_gc(L, LUA_GCRESTART, 0);
+	}
+	baseline = lua_gc(L, LUA_GCCOUNT, 0);
+}
+
+void LuaGarbageCollector::idle(std::chrono::nanoseconds duration)
+{
+	averageIdle = (averageIdle * 7 + duration) / 8;
+}
+
+void LuaGarbageCollector::step()
+{
+	if (!luaState || !isEnabled()) {
+		return;
+	}
+
+	int heap = lua_gc(luaState, LUA_GCCOUNT, 0);
+	peakHeap = std::max(peakHeap, heap);
+
+	int base = std::max(baseline, LUA_GC_MIN_HEAP);
+	auto start = std::chrono::steady_clock::now();
+
+	if (heap >= base / 100 * LUA_GC_PRESSURE) {
+		// the memory is needed more than a smooth dispatcher cycle
+		lua_gc(luaState, LUA_GCCOLLECT, 0);
+		++fullCollections;
+		collecting = false;
+	} else if (generational) {
+		if (heap < base / 100 * (100 + LUA_GC_MINOR_MULTIPLIER)) {
+			return;
+		}
+
+		// a young collection, or a full one once the old objects grew too much
+		lua_gc(luaState, LUA_GCSTEP, 0);
+		++cycles;
+	} else {
+		if (!collecting) {
+			if (heap < base / 100 * LUA_GC_PAUSE) {
+				return;
+			}
+			collecting = true;
+		}
+
+		auto deadline = start + getStepBudget();
+		do {
+			if (lua_gc(luaState, LUA_GCSTEP, 0) != 0) {
+				collecting = false;
+				++cycles;
+				break;
+			}
+		} while (std::chrono::steady_clock::now() < deadline);
+	}
+
+	// older releases hand the collector back to the allocator after a step
+	lua_gc(luaState, LUA_GCSTOP, 0);
+
+	if (!collecting) {
+		baseline = lua_gc(luaState, LUA_GCCOUNT, 0);
+	}
+
+	lastStepTime = std::chrono::steady_clock::now() - start;
+	stepTime += lastStepTime;
+	++steps;
+}
+
+int LuaGarbageCollector::getHeapSize() const
+{
+	return luaState ? lua_gc(luaState, LUA_GCCOUNT, 0) : 0;
+}
+
+void LuaGarbageCollector::printStats() const
+{
+	if (steps == 0) {
+		return;
+	}
+
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Lua collector: {:d} steps, {:d} us per step, {:d} cycles, {:d} full collections under memory pressure, {:d} KB peak heap.", steps, std::chrono::duration_cast<std::chrono::microseconds>(stepTime).count() / steps, cycles, fullCollections, peakHeap));
+}
+
+std::chrono::nanoseconds LuaGarbageCollector::getStepBudget() const
+{
+	// half of the time the dispatcher usually waits for work
+	return std::min<std::chrono::nanoseconds>(budget, std::max<std::chrono::nanoseconds>(averageIdle / 2, LUA_GC_MIN_BUDGET));
+}
@@ -0,0 +1,79 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUACOLLECTOR_H
+#define FS_LUACOLLECTOR_H
+
+struct lua_State;
+
+// runs the Lua garbage collector in steps from the dispatcher when it is idle, instead of from the allocator
+class LuaGarbageCollector
+{
+	public:
+		LuaGarbageCollector() = default;
+
+		// non-copyable
+		LuaGarbageCollector(const LuaGarbageCollector&) = delete;
+		LuaGarbageCollector& operator=(const LuaGarbageCollector&) = delete;
+
+		// picks up the budget and mode from config.lua
+		void configure();
+		bool isEnabled() const {
+			return budget.count() != 0;
+		}
+
+		// takes over the collector of a (new) state
+		void attach(lua_State* L);
+
+		// the dispatcher waited this long for its next tasks
+		void idle(std::chrono::nanoseconds duration);
+		// runs the steps due at the end of a dispatcher cycle
+		void step();
+
+		bool isGenerational() const {
+			return generational;
+		}
+		int getHeapSize() const;
+		int getPeakHeapSize() const {
+			return peakHeap;
+		}
+		std::chrono::nanoseconds getLastStepTime() const {
+			return lastStepTime;
+		}
+		std::chrono::nanoseconds getStepTime() const {
+			return stepTime;
+		}
+		uint64_t getSteps() const {
+			return steps;
+		}
+		uint64_t getCycles() const {
+			return cycles;
+		}
+		uint64_t getFullCollections() const {
+			return fullCollections;
+		}
+
+		void printStats() const;
+
+	private:
+		std::chrono::nanoseconds getStepBudget() const;
+
+		lua_State* luaState = nullptr;
+
+		std::chrono::microseconds budget{0};
+		std::chrono::nanoseconds averageIdle{0};
+		bool generational = false;
+
+		// heap size in KB once the last cycle was done
+		int baseline = 0;
+		int peakHeap = 0;
+		bool collecting = false;
+
+		std::chrono::nanoseconds lastStepTime{0};
+		std::chrono::nanoseconds stepTime{0};
+		uint64_t steps = 0;
+		uint64_t cycles = 0;
+		uint64_t fullCollections = 0;
+};
+
+#endif // FS_LUACOLLECTOR_H
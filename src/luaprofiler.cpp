@@ -0,0 +1,162 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luaprofiler.h"
+#include "configmanager.h"
+
+#include <fstream>
+
+extern ConfigManager g_config;
+extern LuaProfiler g_luaProfiler;
+
+namespace {
+
+bool writeFolded(const std::string& fileName, const std::map<std::string, uint64_t>& stacks, uint64_t divisor)
+{
+	std::ofstream file(fileName, std::ios::trunc);
+	if (!file) {
+		console::reportError("LuaProfiler::dump", fmt::format("Unable to open {:s} for writing.", fileName));
+		return false;
+	}
+
+	for (const auto& it : stacks) {
+		if (uint64_t value = it.second / divisor) {
+			file << it.first << ' ' << value << '\n';
+		}
+	}
+	return true;
+}
+
+}
+
+void LuaProfiler::configure()
+{
+	if (!g_config.getBoolean(ConfigManager::LUA_PROFILER)) {
+		if (enabled) {
+			stop();
+		}
+		return;
+	}
+
+	int32_t interval = std::max<int32_t>(0, g_config.getNumber(ConfigManager::LUA_PROFILER_SAMPLE_INTERVAL));
+	if (!enabled || interval != sampleInterval) {
+		start(interval);
+	}
+}
+
+void LuaProfiler::start(int32_t sampleInterval)
+{
+	reset();
+	this->sampleInterval = sampleInterval;
+	enabled = true;
+	attach(luaState);
+}
+
+void LuaProfiler::stop()
+{
+	enabled = false;
+	frames.clear();
+	attach(luaState);
+}
+
+void LuaProfiler::attach(lua_State* L)
+{
+	luaState = L;
+	if (!L) {
+		return;
+	}
+
+	if (enabled && sampleInterval > 0) {
+		lua_sethook(L, sampleHook, LUA_MASKCOUNT, sampleInterval);
+	} else {
+		lua_sethook(L, nullptr, 0, 0);
+	}
+}
+
+void LuaProfiler::enter(std::string name)
+{
+	if (!frames.empty()) {
+		name = frames.back().stack + ';' + name;
+	}
+	frames.push_back({std::move(name), std::chrono::steady_clock::now()});
+}
+
+void LuaProfiler::leave()
+{
+	// stopped from inside a callback
+	if (frames.empty()) {
+		return;
+	}
+
+	Frame& frame = frames.back();
+	auto elapsed = std::chrono::steady_clock::now() - frame.start;
+	times[frame.stack] += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed - frame.children).count();
+	frames.pop_back();
+
+	if (!frames.empty()) {
+		frames.back().children += elapsed;
+	}
+}
+
+bool LuaProfiler::dump(const std::string& path) const
+{
+	// folded stacks only take whole numbers, time is written in microseconds
+	if (!writeFolded(path + ".time.folded", times, 1000)) {
+		return false;
+	}
+	return samples.empty() || writeFolded(path + ".samples.folded", samples, 1);
+}
+
+void LuaProfiler::reset()
+{
+	frames.clear();
+	times.clear();
+	samples.clear();
+}
+
+void LuaProfiler::printSummary() const
+{
+	uint64_t total = 0;
+	std::vector<std::pair<uint64_t, const std::string*>> top;
+	top.reserve(times.size());
+	for (const auto& it : times) {
+		total += it.second;
+		top.emplace_back(it.second, &it.first);
+	}
+
+	size_t count = std::min<size_t>(top.size(), 10);
+	std::partial_sort(top.begin(), top.begin() + count, top.end(), std::greater<>());
+
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Lua profiler: {:d} ms in scripts, {:d} stacks sampled.", total / 1000000, samples.size()));
+	for (size_t i = 0; i < count; ++i) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("  {:d} ms {:s}", top[i].first / 1000000, *top[i].second));
+	}
+}
+
+void LuaProfiler::sampleHook(lua_State* L, lua_Debug*)
+{
+	LuaProfiler& profiler = g_luaProfiler;
+
+	std::vector<std::string> luaFrames;
+	lua_Debug ar;
+	for (int level = 0; lua_getstack(L, level, &ar) == 1; ++level) {
+		lua_getinfo(L, "Sn", &ar);
+		if (ar.what && std::strcmp(ar.what, "C") == 0) {
+			luaFrames.emplace_back(ar.name ? ar.name : "[C]");
+		} else if (ar.name) {
+			luaFrames.push_back(fmt::format("{:s} ({:s}:{:d})", ar.name, ar.short_src, ar.linedefined));
+		} else {
+			luaFrames.push_back(fmt::format("{:s}:{:d}", ar.short_src, ar.linedefined));
+		}
+	}
+
+	// outside of a callback while scripts are loaded
+	std::string stack = profiler.frames.empty() ? "(loading)" : profiler.frames.back().stack;
+	for (auto it = luaFrames.rbegin(), end = luaFrames.rend(); it != end; ++it) {
+		stack.push_back(';');
+		stack.append(*it);
+	}
+	++profiler.samples[stack];
+}
@@ -0,0 +1,62 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUAPROFILER_H
+#define FS_LUAPROFILER_H
+
+struct lua_State;
+struct lua_Debug;
+
+// opt-in timing of script callbacks and sampling of the Lua stack, written as collapsed stacks for flame graphs
+class LuaProfiler
+{
+	public:
+		LuaProfiler() = default;
+
+		// non-copyable
+		LuaProfiler(const LuaProfiler&) = delete;
+		LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+		// starts or stops the profiler as set in config.lua
+		void configure();
+
+		void start(int32_t sampleInterval);
+		void stop();
+		bool isEnabled() const {
+			return enabled;
+		}
+
+		// installs the sample hook on a (new) state
+		void attach(lua_State* L);
+
+		void enter(std::string name);
+		void leave();
+
+		// writes <path>.time.folded and, if sampled, <path>.samples.folded
+		bool dump(const std::string& path) const;
+		void reset();
+		bool empty() const {
+			return times.empty() && samples.empty();
+		}
+
+		void printSummary() const;
+
+	private:
+		static void sampleHook(lua_State* L, lua_Debug* ar);
+
+		struct Frame {
+			std::string stack;
+			std::chrono::steady_clock::time_point start;
+			std::chrono::nanoseconds children{0};
+		};
+
+		std::vector<Frame> frames;
+		std::map<std::string, uint64_t> times;
+		std::map<std::string, uint64_t> samples;
+
+		lua_State* luaState = nullptr;
+		int32_t sampleInterval = 0;
+		bool enabled = false;
+};
+
+#endif // FS_LUAPROFILER_H
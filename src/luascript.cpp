@@ -19,6 +19,10 @@
 #include "iologindata.h"
 #include "iomapserialize.h"
 #include "iomarket.h"
+#include "journal.h"
+#include "luacache.h"
+#include "luacollector.h"
+#include "luaprofiler.h"
 #include "luavariant.h"
 #include "monster.h"
 #include "movement.h"
@@ -28,8 +32,10 @@
 #include "player.h"
 #include "podium.h"
 #include "protocolstatus.h"
+#include "saytrie.h"
 #include "scheduler.h"
 #include "script.h"
+#include "scriptshards.h"
 #include "spectators.h"
 #include "spells.h"
 #include "storeinbox.h"
@@ -58,6 +64,10 @@ uint32_t ScriptEnvironment::lastResultId = 0;
 
 std::multimap<ScriptEnvironment*, Item*> ScriptEnvironment::tempItems;
 
+LuaBytecodeCache g_luaBytecodeCache;
+LuaProfiler g_luaProfiler;
+LuaGarbageCollector g_luaGarbageCollector;
+ScriptShards g_scriptShards;
 LuaEnvironment g_luaEnvironment;
 
 ScriptEnvironment::ScriptEnvironment()
@@ -266,6 +276,263 @@ std::string LuaScriptInterface::getErrorDesc(ErrorCode_t code)
 ScriptEnvironment LuaScriptInterface::scriptEnv[16];
 int32_t LuaScriptInterface::scriptEnvIndex = -1;
 
+uint64_t LuaScriptInterface::userdataCreated = 0;
+uint64_t LuaScriptInterface::userdataReused = 0;
+
+namespace {
+
+// registry refs looked up once per Lua state, coroutines share them through the registry
+struct StateRefs {
+	lua_State* L = nullptr;
+	const void* registry = nullptr;
+	std::array<int, LuaData_Tile + 1> metatables;
+	int userdataCache = LUA_NOREF;
+
+	StateRefs() {
+		metatables.fill(LUA_NOREF);
+	}
+};
+
+std::vector<StateRefs> stateRefs;
+// the thread pushing game objects, objects freed anywhere else never had cached userdata
+std::atomic<std::thread::id> userdataCacheThread;
+
+// addEvent timers are fired a scheduler tick at a time
+constexpr int64_t LUA_TIMER_TICK = SCHEDULER_MINTICKS;
+// event ids are the slot index with its reuse count above it, below 2^53 to survive as a Lua number
+constexpr uint32_t LUA_TIMER_SLOT_BITS = 20;
+constexpr uint32_t LUA_TIMER_SLOT_MASK = (1 << LUA_TIMER_SLOT_BITS) - 1;
+
+// times a callback as one profiler frame while the profiler runs
+class ProfilerScope
+{
+	public:
+		ProfilerScope(lua_State* L, int params) {
+			if (!g_luaProfiler.isEnabled()) {
+				return;
+			}
+
+			int32_t scriptId, callbackId;
+			bool timerEvent;
+			LuaScriptInterface* scriptInterface;
+			LuaScriptInterface::getScriptEnv()->getEventInfo(scriptId, scriptInterface, callbackId, timerEvent);
+
+			if (timerEvent) {
+				// the environment only knows the id of the script that called addEvent,
+				// the function itself tells where it was defined
+				lua_Debug ar;
+				lua_pushvalue(L, -(params + 1));
+				lua_getinfo(L, ">S", &ar);
+				g_luaProfiler.enter(fmt::format("addEvent;{:s}:{:d}", ar.short_src, ar.linedefined));
+			} else if (scriptInterface) {
+				g_luaProfiler.enter(scriptInterface->getInterfaceName() + ';' + scriptInterface->getFileById(callbackId != 0 ? callbackId : scriptId));
+			} else {
+				g_luaProfiler.enter("(unknown)");
+			}
+			entered = true;
+		}
+
+		~ProfilerScope() {
+			if (entered) {
+				g_luaProfiler.leave();
+			}
+		}
+
+		// non-copyable
+		ProfilerScope(const ProfilerScope&) = delete;
+		ProfilerScope& operator=(const ProfilerScope&) = delete;
+
+	private:
+		bool entered = false;
+};
+
+const char* const metatableNames[] = {"", "Item", "Container", "Teleport", "Podium", "Player", "Monster", "Npc", "Tile"};
+
+StateRefs* getStateRefs(lua_State* L)
+{
+	const void* registry = lua_topointer(L, LUA_REGISTRYINDEX);
+	for (StateRefs& refs : stateRefs) {
+		if (refs.registry == registry) {
+			return &refs;
+		}
+	}
+	return nullptr;
+}
+
+StateRefs& addStateRefs(lua_State* L)
+{
+	if (StateRefs* refs = getStateRefs(L)) {
+		return *refs;
+	}
+
+	StateRefs& refs = stateRefs.emplace_back();
+	refs.L = L;
+	refs.registry = lua_topointer(L, LUA_REGISTRYINDEX);
+	return refs;
+}
+
+void removeStateRefs(lua_State* L)
+{
+	const void* registry = lua_topointer(L, LUA_REGISTRYINDEX);
+	stateRefs.erase(std::remove_if(stateRefs.begin(), stateRefs.end(), [registry](const StateRefs& refs) { return refs.registry == registry; }), stateRefs.end());
+}
+
+// predicate of the Game area functions, checked on the tiles without creating any userdata
+struct AreaFilter {
+	std::vector<uint16_t> itemIds;
+	uint32_t actionId = 0;
+	uint32_t flag = 0;
+	uint32_t noFlag = 0;
+	bool creatures = false;
+	bool movable = false;
+	bool ground = false;
+
+	bool hasItemFilter() const {
+		return !itemIds.empty() || actionId != 0 || movable;
+	}
+
+	bool matches(const Item* item) const {
+		if (!itemIds.empty() && std::find(itemIds.begin(), itemIds.end(), item->getID()) == itemIds.end()) {
+			return false;
+		}
+		if (actionId != 0 && item->getActionId() != actionId) {
+			return false;
+		}
+		return !movable || item->isMoveable();
+	}
+
+	bool matches(const Tile* tile) const {
+		if ((flag != 0 && !tile->hasFlag(flag)) || (noFlag != 0 && tile->hasFlag(noFlag))) {
+			return false;
+		}
+		if (creatures && tile->getCreatureCount() == 0) {
+			return false;
+		}
+		if (!hasItemFilter()) {
+			return true;
+		}
+
+		if (const Item* ground = tile->getGround()) {
+			if (matches(ground)) {
+				return true;
+			}
+		}
+
+		if (const TileItemVector* items = tile->getItemList()) {
+			for (const Item* item : *items) {
+				if (matches(item)) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// the matching items of a tile, collected first as removing or transforming them changes the item list
+	void getItems(Tile* tile, std::vector<Item*>& result) const {
+		if (Item* tileGround = tile->getGround(); tileGround && ground) {
+			if (matches(tileGround)) {
+				result.push_back(tileGround);
+			}
+		}
+
+		if (TileItemVector* items = tile->getItemList()) {
+			for (Item* item : *items) {
+				if (matches(item)) {
+					result.push_back(item);
+				}
+			}
+		}
+	}
+};
+
+// { itemId = id or {ids...}, actionId = id, flag = TILESTATE_*, noFlag = TILESTATE_*, creatures = bool, movable = bool, ground = bool }
+// grounds are only changed with ground = true
+AreaFilter getAreaFilter(lua_State* L, int32_t arg)
+{
+	AreaFilter filter;
+	if (!lua_istable(L, arg)) {
+		return filter;
+	}
+
+	lua_getfield(L, arg, "itemId");
+	if (lua_istable(L, -1)) {
+		lua_pushnil(L);
+		while (lua_next(L, -2) != 0) {
+			filter.itemIds.push_back(LuaScriptInterface::getNumber<uint16_t>(L, -1));
+			lua_pop(L, 1);
+		}
+	} else if (LuaScriptInterface::isNumber(L, -1)) {
+		filter.itemIds.push_back(LuaScriptInterface::getNumber<uint16_t>(L, -1));
+	}
+	lua_pop(L, 1);
+
+	filter.actionId = LuaScriptInterface::getField<uint32_t>(L, arg, "actionId");
+	filter.flag = LuaScriptInterface::getField<uint32_t>(L, arg, "flag");
+	filter.noFlag = LuaScriptInterface::getField<uint32_t>(L, arg, "noFlag");
+	lua_pop(L, 3);
+
+	lua_getfield(L, arg, "creatures");
+	filter.creatures = LuaScriptInterface::getBoolean(L, -1);
+	lua_getfield(L, arg, "movable");
+	filter.movable = LuaScriptInterface::getBoolean(L, -1);
+	lua_getfield(L, arg, "ground");
+	filter.ground = LuaScriptInterface::getBoolean(L, -1);
+	lua_pop(L, 3);
+	return filter;
+}
+
+// the Game area functions run in a single dispatcher task, larger areas have to be split by the script
+constexpr uint64_t LUA_AREA_MAX_TILES = 256 * 256;
+
+// number of tiles between the corners of an area, in any order they are given
+uint64_t getAreaTileCount(const Position& fromPosition, const Position& toPosition)
+{
+	uint64_t width = std::abs(fromPosition.x - toPosition.x) + 1;
+	uint64_t height = std::abs(fromPosition.y - toPosition.y) + 1;
+	int32_t fromZ = std::min(fromPosition.z, toPosition.z), toZ = std::min<int32_t>(std::max(fromPosition.z, toPosition.z), MAP_MAX_LAYERS - 1);
+	return width * height * std::max<int32_t>(0, toZ - fromZ + 1);
+}
+
+// calls f on every tile between the corners of an area, in any order they are given
+template<typename F>
+void forEachAreaTile(const Position& fromPosition, const Position& toPosition, F&& f)
+{
+	int32_t fromX = std::min(fromPosition.x, toPosition.x), toX = std::max(fromPosition.x, toPosition.x);
+	int32_t fromY = std::min(fromPosition.y, toPosition.y), toY = std::max(fromPosition.y, toPosition.y);
+	int32_t fromZ = std::min(fromPosition.z, toPosition.z), toZ = std::min<int32_t>(std::max(fromPosition.z, toPosition.z), MAP_MAX_LAYERS - 1);
+
+	for (int32_t z = fromZ; z <= toZ; ++z) {
+		for (int32_t y = fromY; y <= toY; ++y) {
+			for (int32_t x = fromX; x <= toX; ++x) {
+				if (Tile* tile = g_game.map.getTile(x, y, z)) {
+					f(tile);
+				}
+			}
+		}
+	}
+}
+
+// pushes the weak valued table mapping object addresses to their userdata
+bool pushUserdataCache(lua_State* L)
+{
+	StateRefs& refs = addStateRefs(L);
+	if (refs.userdataCache == LUA_NOREF) {
+		lua_newtable(L);
+		lua_newtable(L);
+		lua_pushstring(L, "v");
+		lua_setfield(L, -2, "__mode");
+		lua_setmetatable(L, -2);
+		refs.userdataCache = luaL_ref(L, LUA_REGISTRYINDEX);
+		userdataCacheThread = std::this_thread::get_id();
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, refs.userdataCache);
+	return true;
+}
+
+}
+
 LuaScriptInterface::LuaScriptInterface(std::string interfaceName) : interfaceName(std::move(interfaceName))
 {
 	if (!g_luaEnvironment.getLuaState()) {
@@ -302,7 +569,7 @@ int LuaScriptInterface::protectedCall(lua_State* L, int nargs, int nresults)
 int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = nullptr*/)
 {
 	//loads file as a chunk at stack top
-	int ret = luaL_loadfile(luaState, file.c_str());
+	int ret = g_luaBytecodeCache.load(luaState, file);
 	if (ret != 0) {
 		lastLuaError = popString(luaState);
 		return -1;
@@ -546,6 +813,8 @@ bool LuaScriptInterface::callFunction(int params)
 {
 	bool result = false;
 	int size = lua_gettop(luaState);
+
+	ProfilerScope profilerScope(luaState, params);
 	if (protectedCall(luaState, params, 1) != 0) {
 		LuaScriptInterface::reportError(nullptr, LuaScriptInterface::getString(luaState, -1));
 	} else {
@@ -564,6 +833,8 @@ bool LuaScriptInterface::callFunction(int params)
 void LuaScriptInterface::callVoidFunction(int params)
 {
 	int size = lua_gettop(luaState);
+
+	ProfilerScope profilerScope(luaState, params);
 	if (protectedCall(luaState, params, 0) != 0) {
 		LuaScriptInterface::reportError(nullptr, LuaScriptInterface::popString(luaState));
 	}
@@ -633,7 +904,7 @@ void LuaScriptInterface::pushCylinder(lua_State* L, Cylinder* cylinder)
 		setItemMetatable(L, -1, parentItem);
 	} else if (Tile* tile = cylinder->getTile()) {
 		pushUserdata<Tile>(L, tile);
-		setMetatable(L, -1, "Tile");
+		setMetatable(L, -1, LuaData_Tile);
 	} else if (cylinder == VirtualCylinder::virtualCylinder) {
 		pushBoolean(L, true);
 	} else {
@@ -674,6 +945,70 @@ void LuaScriptInterface::setMetatable(lua_State* L, int32_t index, const std::st
 	lua_setmetatable(L, index - 1);
 }
 
+void LuaScriptInterface::setMetatable(lua_State* L, int32_t index, LuaDataType type)
+{
+	StateRefs* refs = getStateRefs(L);
+	if (refs && refs->metatables[type] != LUA_NOREF) {
+		lua_rawgeti(L, LUA_REGISTRYINDEX, refs->metatables[type]);
+	} else {
+		luaL_getmetatable(L, metatableNames[type]);
+	}
+	lua_setmetatable(L, index - 1);
+}
+
+bool LuaScriptInterface::pushCachedUserdata(lua_State* L, void* value)
+{
+	if (!g_config.getBoolean(ConfigManager::LUA_USERDATA_CACHE)) {
+		++userdataCreated;
+		return false;
+	}
+
+	pushUserdataCache(L);
+	lua_pushlightuserdata(L, value);
+	lua_rawget(L, -2);
+	if (lua_type(L, -1) == LUA_TUSERDATA) {
+		lua_remove(L, -2);
+		++userdataReused;
+		return true;
+	}
+
+	lua_pop(L, 2);
+	++userdataCreated;
+	return false;
+}
+
+void LuaScriptInterface::cacheUserdata(lua_State* L, void* value)
+{
+	if (!g_config.getBoolean(ConfigManager::LUA_USERDATA_CACHE)) {
+		return;
+	}
+
+	pushUserdataCache(L);
+	lua_pushlightuserdata(L, value);
+	lua_pushvalue(L, -3);
+	lua_rawset(L, -3);
+	lua_pop(L, 1);
+}
+
+void LuaScriptInterface::removeCachedUserdata(void* value)
+{
+	if (std::this_thread::get_id() != userdataCacheThread) {
+		return;
+	}
+
+	for (const StateRefs& refs : stateRefs) {
+		if (refs.userdataCache == LUA_NOREF) {
+			continue;
+		}
+
+		lua_rawgeti(refs.L, LUA_REGISTRYINDEX, refs.userdataCache);
+		lua_pushlightuserdata(refs.L, value);
+		lua_pushnil(refs.L);
+		lua_rawset(refs.L, -3);
+		lua_pop(refs.L, 1);
+	}
+}
+
 void LuaScriptInterface::setWeakMetatable(lua_State* L, int32_t index, const std::string& name)
 {
 	static std::set<std::string> weakObjectTypes;
@@ -712,27 +1047,25 @@ void LuaScriptInterface::setWeakMetatable(lua_State* L, int32_t index, const std
 void LuaScriptInterface::setItemMetatable(lua_State* L, int32_t index, const Item* item)
 {
 	if (item->getContainer()) {
-		luaL_getmetatable(L, "Container");
+		setMetatable(L, index, LuaData_Container);
 	} else if (item->getTeleport()) {
-		luaL_getmetatable(L, "Teleport");
+		setMetatable(L, index, LuaData_Teleport);
 	} else if (item->getPodium()) {
-		luaL_getmetatable(L, "Podium");
+		setMetatable(L, index, LuaData_Podium);
 	} else {
-		luaL_getmetatable(L, "Item");
+		setMetatable(L, index, LuaData_Item);
 	}
-	lua_setmetatable(L, index - 1);
 }
 
 void LuaScriptInterface::setCreatureMetatable(lua_State* L, int32_t index, const Creature* creature)
 {
 	if (creature->getPlayer()) {
-		luaL_getmetatable(L, "Player");
+		setMetatable(L, index, LuaData_Player);
 	} else if (creature->getMonster()) {
-		luaL_getmetatable(L, "Monster");
+		setMetatable(L, index, LuaData_Monster);
 	} else {
-		luaL_getmetatable(L, "Npc");
+		setMetatable(L, index, LuaData_Npc);
 	}
-	lua_setmetatable(L, index - 1);
 }
 
 // Get
@@ -2444,6 +2777,10 @@ void LuaScriptInterface::registerFunctions()
 	registerTable("Game");
 
 	registerMethod("Game", "getSpectators", LuaScriptInterface::luaGameGetSpectators);
+	registerMethod("Game", "getSpectatorIds", LuaScriptInterface::luaGameGetSpectatorIds);
+	registerMethod("Game", "getAreaPositions", LuaScriptInterface::luaGameGetAreaPositions);
+	registerMethod("Game", "removeItems", LuaScriptInterface::luaGameRemoveItems);
+	registerMethod("Game", "transformItems", LuaScriptInterface::luaGameTransformItems);
 	registerMethod("Game", "getPlayers", LuaScriptInterface::luaGameGetPlayers);
 	registerMethod("Game", "getMonsterIds", LuaScriptInterface::luaGameGetMonsterIds);
 	registerMethod("Game", "loadMap", LuaScriptInterface::luaGameLoadMap);
@@ -2454,6 +2791,8 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("Game", "getMonsterCount", LuaScriptInterface::luaGameGetMonsterCount);
 	registerMethod("Game", "getPlayerCount", LuaScriptInterface::luaGameGetPlayerCount);
 	registerMethod("Game", "getNpcCount", LuaScriptInterface::luaGameGetNpcCount);
+	registerMethod("Game", "getActiveCreatureCount", LuaScriptInterface::luaGameGetActiveCreatureCount);
+	registerMethod("Game", "getSleepingCreatureCount", LuaScriptInterface::luaGameGetSleepingCreatureCount);
 	registerMethod("Game", "getMonsterTypes", LuaScriptInterface::luaGameGetMonsterTypes);
 	registerMethod("Game", "getMountIdByLookType", LuaScriptInterface::luaGameGetMountIdByLookType);
 	registerMethod("Game", "getCurrencyItems", LuaScriptInterface::luaGameGetCurrencyItems);
@@ -2486,11 +2825,23 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("Game", "createMonsterType", LuaScriptInterface::luaGameCreateMonsterType);
 
 	registerMethod("Game", "startRaid", LuaScriptInterface::luaGameStartRaid);
+	registerMethod("Game", "respawnMonsters", LuaScriptInterface::luaGameRespawnMonsters);
 
 	registerMethod("Game", "getClientVersion", LuaScriptInterface::luaGameGetClientVersion);
 
 	registerMethod("Game", "reload", LuaScriptInterface::luaGameReload);
 
+	registerMethod("Game", "setLuaProfiler", LuaScriptInterface::luaGameSetLuaProfiler);
+	registerMethod("Game", "dumpLuaProfile", LuaScriptInterface::luaGameDumpLuaProfile);
+	registerMethod("Game", "getTimerEventCounts", LuaScriptInterface::luaGameGetTimerEventCounts);
+	registerMethod("Game", "getLuaGcStats", LuaScriptInterface::luaGameGetLuaGcStats);
+	registerMethod("Game", "benchmarkSayDispatch", LuaScriptInterface::luaGameBenchmarkSayDispatch);
+	registerMethod("Game", "printStats", LuaScriptInterface::luaGamePrintStats);
+
+	registerMethod("Game", "postShard", LuaScriptInterface::luaGamePostShard);
+	registerMethod("Game", "onShardMessage", LuaScriptInterface::luaGameOnShardMessage);
+	registerMethod("Game", "getShardCount", LuaScriptInterface::luaGameGetShardCount);
+
 	registerMethod("Game", "getAccountStorageValue", LuaScriptInterface::luaGameGetAccountStorageValue);
 	registerMethod("Game", "setAccountStorageValue", LuaScriptInterface::luaGameSetAccountStorageValue);
 	registerMethod("Game", "saveAccountStorageValues", LuaScriptInterface::luaGameSaveAccountStorageValues);
@@ -3342,6 +3693,7 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("MonsterType", "canWalkOnEnergy", LuaScriptInterface::luaMonsterTypeCanWalkOnEnergy);
 	registerMethod("MonsterType", "canWalkOnFire", LuaScriptInterface::luaMonsterTypeCanWalkOnFire);
 	registerMethod("MonsterType", "canWalkOnPoison", LuaScriptInterface::luaMonsterTypeCanWalkOnPoison);
+	registerMethod("MonsterType", "asyncPathfinding", LuaScriptInterface::luaMonsterTypeAsyncPathfinding);
 
 	registerMethod("MonsterType", "name", LuaScriptInterface::luaMonsterTypeName);
 	registerMethod("MonsterType", "nameDescription", LuaScriptInterface::luaMonsterTypeNameDescription);
@@ -3679,27 +4031,36 @@ void LuaScriptInterface::registerClass(const std::string& className, const std::
 	lua_rawseti(luaState, metatable, 'p');
 
 	// className.metatable['t'] = type
+	LuaDataType type = LuaData_Unknown;
 	if (className == "Item") {
-		lua_pushnumber(luaState, LuaData_Item);
+		type = LuaData_Item;
 	} else if (className == "Container") {
-		lua_pushnumber(luaState, LuaData_Container);
+		type = LuaData_Container;
 	} else if (className == "Teleport") {
-		lua_pushnumber(luaState, LuaData_Teleport);
+		type = LuaData_Teleport;
 	} else if (className == "Podium") {
-		lua_pushnumber(luaState, LuaData_Podium);
+		type = LuaData_Podium;
 	} else if (className == "Player") {
-		lua_pushnumber(luaState, LuaData_Player);
+		type = LuaData_Player;
 	} else if (className == "Monster") {
-		lua_pushnumber(luaState, LuaData_Monster);
+		type = LuaData_Monster;
 	} else if (className == "Npc") {
-		lua_pushnumber(luaState, LuaData_Npc);
+		type = LuaData_Npc;
 	} else if (className == "Tile") {
-		lua_pushnumber(luaState, LuaData_Tile);
-	} else {
-		lua_pushnumber(luaState, LuaData_Unknown);
+		type = LuaData_Tile;
 	}
+	lua_pushnumber(luaState, type);
 	lua_rawseti(luaState, metatable, 't');
 
+	// keep a ref for setMetatable(L, index, type), registering again reuses the same metatable
+	if (type != LuaData_Unknown) {
+		StateRefs& refs = addStateRefs(luaState);
+		if (refs.metatables[type] == LUA_NOREF) {
+			lua_pushvalue(luaState, metatable);
+			refs.metatables[type] = luaL_ref(luaState, LUA_REGISTRYINDEX);
+		}
+	}
+
 	// pop className, className.metatable
 	lua_pop(luaState, 2);
 }
@@ -4264,49 +4625,23 @@ int LuaScriptInterface::luaAddEvent(lua_State* L)
 		}
 	}
 
-	LuaTimerEventDesc eventDesc;
-	eventDesc.parameters.reserve(parameters - 2); // safe to use -2 since we garanteed that there is at least two parameters
-	for (int i = 0; i < parameters - 2; ++i) {
-		eventDesc.parameters.push_back(luaL_ref(L, LUA_REGISTRYINDEX));
-	}
-
 	uint32_t delay = std::max<uint32_t>(100, getNumber<uint32_t>(L, 2));
-	lua_pop(L, 1);
-
-	eventDesc.function = luaL_ref(L, LUA_REGISTRYINDEX);
-	eventDesc.scriptId = getScriptEnv()->getScriptId();
-
-	auto& lastTimerEventId = g_luaEnvironment.lastEventTimerId;
-	eventDesc.eventId = g_scheduler.addEvent(createSchedulerTask(delay, [=]() { g_luaEnvironment.executeTimerEvent(lastTimerEventId); }));
+	uint64_t eventId = g_luaEnvironment.addTimerEvent(L, delay, parameters - 2);
+	if (eventId == 0) {
+		reportErrorFunc(L, "Too many timer events.");
+		pushBoolean(L, false);
+		return 1;
+	}
 
-	g_luaEnvironment.timerEvents.emplace(lastTimerEventId, std::move(eventDesc));
-	lua_pushnumber(L, lastTimerEventId++);
+	lua_pushnumber(L, eventId);
 	return 1;
 }
 
 int LuaScriptInterface::luaStopEvent(lua_State* L)
 {
 	//stopEvent(eventid)
-	uint32_t eventId = getNumber<uint32_t>(L, 1);
-
-	auto& timerEvents = g_luaEnvironment.timerEvents;
-	auto it = timerEvents.find(eventId);
-	if (it == timerEvents.end()) {
-		pushBoolean(L, false);
-		return 1;
-	}
-
-	LuaTimerEventDesc timerEventDesc = std::move(it->second);
-	timerEvents.erase(it);
-
-	g_scheduler.stopEvent(timerEventDesc.eventId);
-	luaL_unref(L, LUA_REGISTRYINDEX, timerEventDesc.function);
-
-	for (auto parameter : timerEventDesc.parameters) {
-		luaL_unref(L, LUA_REGISTRYINDEX, parameter);
-	}
-
-	pushBoolean(L, true);
+	uint64_t eventId = getNumber<uint64_t>(L, 1);
+	pushBoolean(L, g_luaEnvironment.stopTimerEvent(L, eventId));
 	return 1;
 }
 
@@ -4788,6 +5123,165 @@ int LuaScriptInterface::luaGameGetSpectators(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetSpectatorIds(lua_State* L)
+{
+	// Game.getSpectatorIds(position[, multifloor = false[, onlyPlayer = false[, minRangeX = 0[, maxRangeX = 0[, minRangeY = 0[, maxRangeY = 0[, withPositions = false]]]]]]])
+	const Position& position = getPosition(L, 1);
+	bool multifloor = getBoolean(L, 2, false);
+	bool onlyPlayers = getBoolean(L, 3, false);
+	int32_t minRangeX = getNumber<int32_t>(L, 4, 0);
+	int32_t maxRangeX = getNumber<int32_t>(L, 5, 0);
+	int32_t minRangeY = getNumber<int32_t>(L, 6, 0);
+	int32_t maxRangeY = getNumber<int32_t>(L, 7, 0);
+	bool withPositions = getBoolean(L, 8, false);
+
+	SpectatorVec spectators;
+	g_game.map.getSpectators(spectators, position, multifloor, onlyPlayers, minRangeX, maxRangeX, minRangeY, maxRangeY);
+
+	lua_createtable(L, spectators.size(), 0);
+
+	int index = 0;
+	for (Creature* creature : spectators) {
+		lua_pushnumber(L, creature->getID());
+		lua_rawseti(L, -2, ++index);
+	}
+
+	if (!withPositions) {
+		return 1;
+	}
+
+	// x, y and z of every creature one after another
+	lua_createtable(L, spectators.size() * 3, 0);
+
+	index = 0;
+	for (Creature* creature : spectators) {
+		const Position& creaturePosition = creature->getPosition();
+		lua_pushnumber(L, creaturePosition.x);
+		lua_rawseti(L, -2, ++index);
+		lua_pushnumber(L, creaturePosition.y);
+		lua_rawseti(L, -2, ++index);
+		lua_pushnumber(L, creaturePosition.z);
+		lua_rawseti(L, -2, ++index);
+	}
+	return 2;
+}
+
+int LuaScriptInterface::luaGameGetAreaPositions(lua_State* L)
+{
+	// Game.getAreaPositions(fromPosition, toPosition[, filter])
+	const Position& fromPosition = getPosition(L, 1);
+	const Position& toPosition = getPosition(L, 2);
+	if (getAreaTileCount(fromPosition, toPosition) > LUA_AREA_MAX_TILES) {
+		reportErrorFunc(L, fmt::format("Area is too large, at most {:d} tiles are allowed.", LUA_AREA_MAX_TILES));
+		lua_pushnil(L);
+		return 1;
+	}
+
+	const AreaFilter filter = getAreaFilter(L, 3);
+
+	lua_newtable(L);
+
+	int index = 0;
+	forEachAreaTile(fromPosition, toPosition, [&](Tile* tile) {
+		if (filter.matches(tile)) {
+			pushPosition(L, tile->getPosition());
+			lua_rawseti(L, -2, ++index);
+		}
+	});
+	return 1;
+}
+
+int LuaScriptInterface::luaGameRemoveItems(lua_State* L)
+{
+	// Game.removeItems(fromPosition, toPosition, filter)
+	if (!isTable(L, 3)) {
+		reportErrorFunc(L, "Game.removeItems needs a filter, pass an empty table to remove every item.");
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	const Position& fromPosition = getPosition(L, 1);
+	const Position& toPosition = getPosition(L, 2);
+	if (getAreaTileCount(fromPosition, toPosition) > LUA_AREA_MAX_TILES) {
+		reportErrorFunc(L, fmt::format("Area is too large, at most {:d} tiles are allowed.", LUA_AREA_MAX_TILES));
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	const AreaFilter filter = getAreaFilter(L, 3);
+
+	uint32_t removed = 0;
+	std::vector<Item*> items;
+	forEachAreaTile(fromPosition, toPosition, [&](Tile* tile) {
+		items.clear();
+		filter.getItems(tile, items);
+		for (Item* item : items) {
+			// grounds stay, the tile would be gone with them
+			if (item != tile->getGround() && g_game.internalRemoveItem(item) == RETURNVALUE_NOERROR) {
+				++removed;
+			}
+		}
+	});
+
+	lua_pushnumber(L, removed);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameTransformItems(lua_State* L)
+{
+	// Game.transformItems(fromPosition, toPosition, filter, itemId[, count/subType = -1])
+	if (!isTable(L, 3)) {
+		reportErrorFunc(L, "Game.transformItems needs a filter, pass an empty table to transform every item.");
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	uint16_t itemId;
+	if (isNumber(L, 4)) {
+		itemId = getNumber<uint16_t>(L, 4);
+	} else {
+		itemId = Item::items.getItemIdByName(getString(L, 4));
+		if (itemId == 0) {
+			pushBoolean(L, false);
+			return 1;
+		}
+	}
+
+	const Position& fromPosition = getPosition(L, 1);
+	const Position& toPosition = getPosition(L, 2);
+	if (getAreaTileCount(fromPosition, toPosition) > LUA_AREA_MAX_TILES) {
+		reportErrorFunc(L, fmt::format("Area is too large, at most {:d} tiles are allowed.", LUA_AREA_MAX_TILES));
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	const AreaFilter filter = getAreaFilter(L, 3);
+
+	int32_t subType = getNumber<int32_t>(L, 5, -1);
+	if (Item::items[itemId].stackable) {
+		subType = std::min<int32_t>(subType, 100);
+	}
+
+	uint32_t transformed = 0;
+	std::vector<Item*> items;
+	forEachAreaTile(fromPosition, toPosition, [&](Tile* tile) {
+		items.clear();
+		filter.getItems(tile, items);
+		for (Item* item : items) {
+			if (item->getID() == itemId && (subType == -1 || subType == item->getSubType())) {
+				continue;
+			}
+
+			if (g_game.transformItem(item, itemId, subType)) {
+				++transformed;
+			}
+		}
+	});
+
+	lua_pushnumber(L, transformed);
+	return 1;
+}
+
 int LuaScriptInterface::luaGameGetPlayers(lua_State* L)
 {
 	// Game.getPlayers()
@@ -4796,7 +5290,7 @@ int LuaScriptInterface::luaGameGetPlayers(lua_State* L)
 	int index = 0;
 	for (const auto& playerEntry : g_game.getPlayers()) {
 		pushUserdata<Player>(L, playerEntry.second);
-		setMetatable(L, -1, "Player");
+		setMetatable(L, -1, LuaData_Player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4892,6 +5386,20 @@ int LuaScriptInterface::luaGameGetNpcCount(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetActiveCreatureCount(lua_State* L)
+{
+	// Game.getActiveCreatureCount()
+	lua_pushnumber(L, g_game.getActiveCreatureCount());
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetSleepingCreatureCount(lua_State* L)
+{
+	// Game.getSleepingCreatureCount()
+	lua_pushnumber(L, g_game.getSleepingCreatureCount());
+	return 1;
+}
+
 int LuaScriptInterface::luaGameGetMonsterTypes(lua_State* L)
 {
 	// Game.getMonsterTypes()
@@ -5243,7 +5751,7 @@ int LuaScriptInterface::luaGameCreateContainer(lua_State* L)
 	}
 
 	pushUserdata<Container>(L, container);
-	setMetatable(L, -1, "Container");
+	setMetatable(L, -1, LuaData_Container);
 	return 1;
 }
 
@@ -5264,7 +5772,7 @@ int LuaScriptInterface::luaGameCreateMonster(lua_State* L)
 	if (g_events->eventMonsterOnSpawn(monster, position, false, true) || force) {
 		if (g_game.placeCreature(monster, position, extended, force, magicEffect)) {
 			pushUserdata<Monster>(L, monster);
-			setMetatable(L, -1, "Monster");
+			setMetatable(L, -1, LuaData_Monster);
 		} else {
 			delete monster;
 			lua_pushboolean(L, false);
@@ -5292,7 +5800,7 @@ int LuaScriptInterface::luaGameCreateNpc(lua_State* L)
 
 	if (g_game.placeCreature(npc, position, extended, force, magicEffect)) {
 		pushUserdata<Npc>(L, npc);
-		setMetatable(L, -1, "Npc");
+		setMetatable(L, -1, LuaData_Npc);
 	} else {
 		delete npc;
 		lua_pushboolean(L, false);
@@ -5328,7 +5836,7 @@ int LuaScriptInterface::luaGameCreateTile(lua_State* L)
 	}
 
 	pushUserdata(L, tile);
-	setMetatable(L, -1, "Tile");
+	setMetatable(L, -1, LuaData_Tile);
 	return 1;
 }
 
@@ -5391,6 +5899,14 @@ int LuaScriptInterface::luaGameStartRaid(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameRespawnMonsters(lua_State* L)
+{
+	// Game.respawnMonsters()
+	g_game.map.spawns.respawnAll();
+	pushBoolean(L, true);
+	return 1;
+}
+
 int LuaScriptInterface::luaGameGetClientVersion(lua_State* L)
 {
 	// Game.getClientVersion()
@@ -5415,6 +5931,151 @@ int LuaScriptInterface::luaGameReload(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameSetLuaProfiler(lua_State* L)
+{
+	// Game.setLuaProfiler(enabled[, sampleInterval = 0])
+	if (getBoolean(L, 1)) {
+		g_luaProfiler.start(std::max<int32_t>(0, getNumber<int32_t>(L, 2, 0)));
+	} else {
+		g_luaProfiler.stop();
+	}
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameDumpLuaProfile(lua_State* L)
+{
+	// Game.dumpLuaProfile([path])
+	std::string path = isString(L, 1) ? getString(L, 1) : g_config.getString(ConfigManager::LUA_PROFILER_FILE);
+	if (g_luaProfiler.empty()) {
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	g_luaProfiler.printSummary();
+	pushBoolean(L, g_luaProfiler.dump(path));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetTimerEventCounts(lua_State* L)
+{
+	// Game.getTimerEventCounts()
+	lua_newtable(L);
+	for (const auto& it : g_luaEnvironment.getTimerScripts()) {
+		if (it.second != 0) {
+			setField(L, it.first.c_str(), it.second);
+		}
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetLuaGcStats(lua_State* L)
+{
+	// Game.getLuaGcStats()
+	lua_createtable(L, 0, 9);
+	setField(L, "heap", lua_gc(L, LUA_GCCOUNT, 0));
+	setField(L, "peakHeap", g_luaGarbageCollector.getPeakHeapSize());
+	setField(L, "lastStepTime", std::chrono::duration_cast<std::chrono::microseconds>(g_luaGarbageCollector.getLastStepTime()).count());
+	setField(L, "stepTime", std::chrono::duration_cast<std::chrono::microseconds>(g_luaGarbageCollector.getStepTime()).count());
+	setField(L, "steps", g_luaGarbageCollector.getSteps());
+	setField(L, "cycles", g_luaGarbageCollector.getCycles());
+	setField(L, "fullCollections", g_luaGarbageCollector.getFullCollections());
+	pushBoolean(L, g_luaGarbageCollector.isEnabled());
+	lua_setfield(L, -2, "paced");
+	pushBoolean(L, g_luaGarbageCollector.isGenerational());
+	lua_setfield(L, -2, "generational");
+	return 1;
+}
+
+int LuaScriptInterface::luaGameBenchmarkSayDispatch(lua_State* L)
+{
+	// Game.benchmarkSayDispatch([iterations = 100])
+	SayTrie::BenchmarkResult result = g_sayTrie.benchmark(getNumber<uint32_t>(L, 1, 100));
+
+	lua_createtable(L, 0, 4);
+	setField(L, "samples", result.samples);
+	setField(L, "mismatches", result.mismatches);
+	setField(L, "scanTime", std::chrono::duration_cast<std::chrono::microseconds>(result.scanTime).count());
+	setField(L, "trieTime", std::chrono::duration_cast<std::chrono::microseconds>(result.trieTime).count());
+	return 1;
+}
+
+int LuaScriptInterface::luaGamePrintStats(lua_State* L)
+{
+	// Game.printStats()
+	g_game.printStats();
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGamePostShard(lua_State* L)
+{
+	// Game.postShard(handler, payload[, callback[, key = 0]])
+	if (g_scriptShards.getShardCount() == 0) {
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	const std::string handler = getString(L, 1);
+	ScriptValue payload;
+	std::string error;
+	if (!payload.read(L, 2, error)) {
+		reportErrorFunc(L, error);
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	int32_t callback = -1;
+	if (isFunction(L, 3)) {
+		lua_pushvalue(L, 3);
+		callback = luaL_ref(L, LUA_REGISTRYINDEX);
+	} else if (!lua_isnoneornil(L, 3)) {
+		reportErrorFunc(L, "callback parameter should be a function.");
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	if (!g_scriptShards.post(handler, std::move(payload), getNumber<uint32_t>(L, 4, 0), callback, getScriptEnv()->getScriptId())) {
+		if (callback != -1) {
+			luaL_unref(L, LUA_REGISTRYINDEX, callback);
+		}
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameOnShardMessage(lua_State* L)
+{
+	// Game.onShardMessage(name, callback)
+	const std::string name = getString(L, 1);
+	if (lua_isnoneornil(L, 2)) {
+		g_scriptShards.setMessageHandler(name, -1, 0);
+		pushBoolean(L, true);
+		return 1;
+	}
+
+	if (!isFunction(L, 2)) {
+		reportErrorFunc(L, "callback parameter should be a function.");
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	lua_settop(L, 2);
+	g_scriptShards.setMessageHandler(name, luaL_ref(L, LUA_REGISTRYINDEX), getScriptEnv()->getScriptId());
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetShardCount(lua_State* L)
+{
+	// Game.getShardCount()
+	lua_pushnumber(L, g_scriptShards.getShardCount());
+	return 1;
+}
+
 int LuaScriptInterface::luaGameGetAccountStorageValue(lua_State* L)
 {
 	// Game.getAccountStorageValue(accountId, key)
@@ -5685,7 +6346,7 @@ int LuaScriptInterface::luaTileCreate(lua_State* L)
 
 	if (tile) {
 		pushUserdata<Tile>(L, tile);
-		setMetatable(L, -1, "Tile");
+		setMetatable(L, -1, LuaData_Tile);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7276,7 +7937,7 @@ int LuaScriptInterface::luaItemGetTile(lua_State* L)
 	Tile* tile = item->getTile();
 	if (tile) {
 		pushUserdata<Tile>(L, tile);
-		setMetatable(L, -1, "Tile");
+		setMetatable(L, -1, LuaData_Tile);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7771,7 +8432,7 @@ int LuaScriptInterface::luaContainerCreate(lua_State* L)
 	Container* container = getScriptEnv()->getContainerByUID(id);
 	if (container) {
 		pushUserdata(L, container);
-		setMetatable(L, -1, "Container");
+		setMetatable(L, -1, LuaData_Container);
 	} else {
 		lua_pushnil(L);
 	}
@@ -8057,7 +8718,7 @@ int LuaScriptInterface::luaTeleportCreate(lua_State* L)
 	Item* item = getScriptEnv()->getItemByUID(id);
 	if (item && item->getTeleport()) {
 		pushUserdata(L, item);
-		setMetatable(L, -1, "Teleport");
+		setMetatable(L, -1, LuaData_Teleport);
 	} else {
 		lua_pushnil(L);
 	}
@@ -8098,7 +8759,7 @@ int LuaScriptInterface::luaPodiumCreate(lua_State* L)
 	Item* item = getScriptEnv()->getItemByUID(id);
 	if (item && item->getPodium()) {
 		pushUserdata(L, item);
-		setMetatable(L, -1, "Podium");
+		setMetatable(L, -1, LuaData_Podium);
 	} else {
 		lua_pushnil(L);
 	}
@@ -8227,11 +8888,11 @@ int LuaScriptInterface::luaCreatureGetEvents(lua_State* L)
 	}
 
 	CreatureEventType_t eventType = getNumber<CreatureEventType_t>(L, 2);
-	const auto& eventList = creature->getCreatureEvents(eventType);
+	const CreatureEventList& eventList = creature->getCreatureEvents(eventType);
 	lua_createtable(L, eventList.size(), 0);
 
 	int index = 0;
-	for (CreatureEvent* event : eventList) {
+	for (CreatureEvent* event : CreatureEventDispatch(creature, eventList)) {
 		pushString(L, event->getName());
 		lua_rawseti(L, -2, ++index);
 	}
@@ -8706,7 +9367,7 @@ int LuaScriptInterface::luaCreatureGetTile(lua_State* L)
 	Tile* tile = creature->getTile();
 	if (tile) {
 		pushUserdata<Tile>(L, tile);
-		setMetatable(L, -1, "Tile");
+		setMetatable(L, -1, LuaData_Tile);
 	} else {
 		lua_pushnil(L);
 	}
@@ -9411,7 +10072,7 @@ int LuaScriptInterface::luaPlayerCreate(lua_State* L)
 
 	if (player) {
 		pushUserdata<Player>(L, player);
-		setMetatable(L, -1, "Player");
+		setMetatable(L, -1, LuaData_Player);
 	} else {
 		lua_pushnil(L);
 	}
@@ -11808,7 +12469,7 @@ int LuaScriptInterface::luaPlayerGetContainerById(lua_State* L)
 	Container* container = player->getContainerByID(getNumber<uint8_t>(L, 2));
 	if (container) {
 		pushUserdata<Container>(L, container);
-		setMetatable(L, -1, "Container");
+		setMetatable(L, -1, LuaData_Container);
 	} else {
 		lua_pushnil(L);
 	}
@@ -11838,7 +12499,7 @@ int LuaScriptInterface::luaPlayerGetOpenContainers(lua_State* L)
 		lua_createtable(L, openContainers.size(), 0);
 		for (auto const& containerInfo : openContainers) {
 			pushUserdata<Container>(L, containerInfo.second.container);
-			setMetatable(L, -1, "Container");
+			setMetatable(L, -1, LuaData_Container);
 			lua_rawseti(L, -2, containerInfo.first);
 		}
 	} else {
@@ -11939,7 +12600,7 @@ int LuaScriptInterface::luaPlayerGetStoreInbox(lua_State* L)
 	}
 
 	pushUserdata<Container>(L, storeInbox);
-	setMetatable(L, -1, "Container");
+	setMetatable(L, -1, LuaData_Container);
 	return 1;
 }
 
@@ -11988,7 +12649,7 @@ int LuaScriptInterface::luaMonsterCreate(lua_State* L)
 
 	if (monster) {
 		pushUserdata<Monster>(L, monster);
-		setMetatable(L, -1, "Monster");
+		setMetatable(L, -1, LuaData_Monster);
 	} else {
 		lua_pushnil(L);
 	}
@@ -12461,7 +13122,7 @@ int LuaScriptInterface::luaNpcCreate(lua_State* L)
 
 	if (npc) {
 		pushUserdata<Npc>(L, npc);
-		setMetatable(L, -1, "Npc");
+		setMetatable(L, -1, LuaData_Npc);
 	} else {
 		lua_pushnil(L);
 	}
@@ -12585,7 +13246,7 @@ int LuaScriptInterface::luaGuildGetMembersOnline(lua_State* L)
 	int index = 0;
 	for (Player* player : members) {
 		pushUserdata<Player>(L, player);
-		setMetatable(L, -1, "Player");
+		setMetatable(L, -1, LuaData_Player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -13482,7 +14143,7 @@ int LuaScriptInterface::luaHouseGetTiles(lua_State* L)
 	int index = 0;
 	for (Tile* tile : tiles) {
 		pushUserdata<Tile>(L, tile);
-		setMetatable(L, -1, "Tile");
+		setMetatable(L, -1, LuaData_Tile);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -13599,7 +14260,7 @@ int LuaScriptInterface::luaHouseSave(lua_State* L)
 		return 1;
 	}
 
-	pushBoolean(L, IOMapSerialize::saveHouse(house));
+	pushBoolean(L, g_journal.record([house]() { return IOMapSerialize::saveHouse(house); }));
 	return 1;
 }
 
@@ -15318,6 +15979,23 @@ int LuaScriptInterface::luaMonsterTypeCanWalkOnPoison(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaMonsterTypeAsyncPathfinding(lua_State* L)
+{
+	// get: monsterType:asyncPathfinding() set: monsterType:asyncPathfinding(bool)
+	MonsterType* monsterType = getUserdata<MonsterType>(L, 1);
+	if (monsterType) {
+		if (lua_gettop(L) == 1) {
+			pushBoolean(L, monsterType->info.asyncPathfinding);
+		} else {
+			monsterType->info.asyncPathfinding = getBoolean(L, 2);
+			pushBoolean(L, true);
+		}
+	} else {
+		lua_pushnil(L);
+	}
+	return 1;
+}
+
 int32_t LuaScriptInterface::luaMonsterTypeName(lua_State* L)
 {
 	// get: monsterType:name() set: monsterType:name(name)
@@ -16654,7 +17332,7 @@ int LuaScriptInterface::luaPartyGetLeader(lua_State* L)
 	Player* leader = party->getLeader();
 	if (leader) {
 		pushUserdata<Player>(L, leader);
-		setMetatable(L, -1, "Player");
+		setMetatable(L, -1, LuaData_Player);
 	} else {
 		lua_pushnil(L);
 	}
@@ -16687,7 +17365,7 @@ int LuaScriptInterface::luaPartyGetMembers(lua_State* L)
 	lua_createtable(L, party->getMemberCount(), 0);
 	for (Player* player : party->getMembers()) {
 		pushUserdata<Player>(L, player);
-		setMetatable(L, -1, "Player");
+		setMetatable(L, -1, LuaData_Player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -16706,7 +17384,7 @@ int LuaScriptInterface::luaPartyGetActiveMembers(lua_State* L)
 	lua_createtable(L, party->getMemberCount(), 0);
 	for (Player* player : party->getActiveMembers()) {
 		pushUserdata<Player>(L, player);
-		setMetatable(L, -1, "Player");
+		setMetatable(L, -1, LuaData_Player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -16734,7 +17412,7 @@ int LuaScriptInterface::luaPartyGetInvitees(lua_State* L)
 		int index = 0;
 		for (Player* player : party->getInvitees()) {
 			pushUserdata<Player>(L, player);
-			setMetatable(L, -1, "Player");
+			setMetatable(L, -1, LuaData_Player);
 			lua_rawseti(L, -2, ++index);
 		}
 	} else {
@@ -19192,7 +19870,7 @@ int LuaScriptInterface::luaWeaponExtraElement(lua_State* L)
 }
 
 //
-LuaEnvironment::LuaEnvironment() : LuaScriptInterface("Main Interface") {}
+LuaEnvironment::LuaEnvironment() : LuaScriptInterface("Main Interface"), executingTimerScript(timerScripts.end()) {}
 
 LuaEnvironment::~LuaEnvironment()
 {
@@ -19209,6 +19887,9 @@ bool LuaEnvironment::initState()
 
 	luaL_openlibs(luaState);
 	registerFunctions();
+	g_luaProfiler.attach(luaState);
+	g_luaGarbageCollector.attach(luaState);
+	g_scriptShards.attach(luaState);
 
 	runningEventId = EVENT_ID_USER;
 	return true;
@@ -19235,19 +19916,25 @@ bool LuaEnvironment::closeState()
 		clearAreaObjects(areaEntry.first);
 	}
 
-	for (auto& timerEntry : timerEvents) {
-		LuaTimerEventDesc timerEventDesc = std::move(timerEntry.second);
-		for (int32_t parameter : timerEventDesc.parameters) {
-			luaL_unref(luaState, LUA_REGISTRYINDEX, parameter);
-		}
-		luaL_unref(luaState, LUA_REGISTRYINDEX, timerEventDesc.function);
-	}
-
 	combatIdMap.clear();
 	areaIdMap.clear();
-	timerEvents.clear();
 	cacheFiles.clear();
 
+	// the timer refs go with the state
+	timerSlots.clear();
+	timerWheel.fill({0, 0});
+	timerScripts.clear();
+	executingTimerScript = timerScripts.end();
+	freeTimerSlot = 0;
+	linkedTimers = 0;
+	liveTimers = 0;
+	++timerTask;
+	timerTaskPending = false;
+
+	removeStateRefs(luaState);
+	g_luaProfiler.attach(nullptr);
+	g_luaGarbageCollector.attach(nullptr);
+	g_scriptShards.attach(nullptr);
 	lua_close(luaState);
 	luaState = nullptr;
 	return true;
@@ -19328,37 +20015,234 @@ void LuaEnvironment::clearAreaObjects(LuaScriptInterface* interface)
 	it->second.clear();
 }
 
-void LuaEnvironment::executeTimerEvent(uint32_t eventIndex)
+uint64_t LuaEnvironment::addTimerEvent(lua_State* L, int64_t delay, uint16_t parameters)
+{
+	if (timerSlots.empty()) {
+		timerSlots.emplace_back();
+	}
+
+	uint32_t index = freeTimerSlot;
+	if (index != 0) {
+		freeTimerSlot = timerSlots[index].next;
+	} else if (timerSlots.size() <= LUA_TIMER_SLOT_MASK) {
+		index = timerSlots.size();
+		timerSlots.emplace_back();
+	} else {
+		return 0;
+	}
+
+	ScriptEnvironment* env = getScriptEnv();
+
+	// timers started by a timer count towards the script that started the first one
+	LuaTimerScripts::iterator script = executingTimerScript;
+	if (!env->isTimerEvent() || script == timerScripts.end()) {
+		static const std::string unknown = "(Unknown scriptfile)";
+		LuaScriptInterface* scriptInterface = env->getScriptInterface();
+		const std::string& file = scriptInterface ? scriptInterface->getFileById(env->getScriptId()) : unknown;
+
+		script = timerScripts.find(file);
+		if (script == timerScripts.end()) {
+			script = timerScripts.emplace(file, 0).first;
+		}
+	}
+
+	// the callback alone needs no table, otherwise it goes into one along with its arguments
+	if (parameters == 0) {
+		lua_pushvalue(L, 1);
+	} else {
+		lua_createtable(L, parameters + 1, 0);
+		lua_pushvalue(L, 1);
+		lua_rawseti(L, -2, 1);
+		for (int i = 1; i <= parameters; ++i) {
+			lua_pushvalue(L, i + 2);
+			lua_rawseti(L, -2, i + 1);
+		}
+	}
+
+	LuaTimerEvent& event = timerSlots[index];
+	event.script = script;
+	event.due = OTSYS_TIME() + delay;
+	event.scriptId = env->getScriptId();
+	event.ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	event.parameters = parameters;
+	event.active = true;
+
+	++script->second;
+	++timersCreated;
+	peakTimers = std::max(peakTimers, ++liveTimers);
+
+	linkTimerEvent(index);
+	return (static_cast<uint64_t>(event.generation) << LUA_TIMER_SLOT_BITS) | index;
+}
+
+bool LuaEnvironment::stopTimerEvent(lua_State* L, uint64_t eventId)
 {
-	auto it = timerEvents.find(eventIndex);
-	if (it == timerEvents.end()) {
+	uint32_t index = eventId & LUA_TIMER_SLOT_MASK;
+	if (index == 0 || index >= timerSlots.size()) {
+		return false;
+	}
+
+	// the slot stays in its bucket until the wheel passes it
+	LuaTimerEvent& event = timerSlots[index];
+	if (!event.active || event.generation != (eventId >> LUA_TIMER_SLOT_BITS)) {
+		return false;
+	}
+
+	releaseTimerEvent(L, event);
+	return true;
+}
+
+void LuaEnvironment::linkTimerEvent(uint32_t index)
+{
+	int64_t now = OTSYS_TIME();
+	bool schedule = !timerTaskPending;
+	if (schedule) {
+		// the wheel is empty, move it to the present
+		timerTick = std::max<int64_t>(timerTick, now / LUA_TIMER_TICK);
+		timerTaskPending = true;
+	}
+
+	LuaTimerEvent& event = timerSlots[index];
+	int64_t tick = std::max<int64_t>(timerTick, event.due / LUA_TIMER_TICK);
+
+	auto& bucket = timerWheel[tick % LUA_TIMER_WHEEL_SIZE];
+	++linkedTimers;
+
+	// buckets are ordered by due time, timers started later mostly go to the end
+	if (bucket.first == 0) {
+		event.next = 0;
+		bucket.first = index;
+		bucket.second = index;
+	} else if (timerSlots[bucket.second].due <= event.due) {
+		event.next = 0;
+		timerSlots[bucket.second].next = index;
+		bucket.second = index;
+	} else if (event.due < timerSlots[bucket.first].due) {
+		event.next = bucket.first;
+		bucket.first = index;
+	} else {
+		uint32_t previous = bucket.first;
+		while (timerSlots[timerSlots[previous].next].due <= event.due) {
+			previous = timerSlots[previous].next;
+		}
+		event.next = timerSlots[previous].next;
+		timerSlots[previous].next = index;
+	}
+
+	if (schedule) {
+		scheduleTimerEvents(now);
+	}
+}
+
+void LuaEnvironment::releaseTimerEvent(lua_State* L, LuaTimerEvent& event)
+{
+	luaL_unref(L, LUA_REGISTRYINDEX, event.ref);
+	event.ref = LUA_NOREF;
+	event.active = false;
+	++event.generation;
+
+	--event.script->second;
+	--liveTimers;
+}
+
+void LuaEnvironment::scheduleTimerEvents(int64_t now)
+{
+	// wake up for the next bucket, or earlier for the first timer of this one
+	int64_t due = (timerTick + 1) * LUA_TIMER_TICK;
+	if (uint32_t head = timerWheel[timerTick % LUA_TIMER_WHEEL_SIZE].first) {
+		due = std::min(due, timerSlots[head].due);
+	}
+
+	int64_t delay = std::max<int64_t>(1, due - now);
+	g_scheduler.addEvent(createSchedulerTask(delay, [task = timerTask]() { g_luaEnvironment.executeTimerEvents(task); }));
+}
+
+void LuaEnvironment::executeTimerEvents(uint32_t task)
+{
+	if (task != timerTask || !luaState) {
 		return;
 	}
 
-	LuaTimerEventDesc timerEventDesc = std::move(it->second);
-	timerEvents.erase(it);
+	int64_t now = OTSYS_TIME();
+	int64_t tick = now / LUA_TIMER_TICK;
 
-	//push function
-	lua_rawgeti(luaState, LUA_REGISTRYINDEX, timerEventDesc.function);
+	// when running late a single turn still visits every bucket once
+	for (size_t visited = 0; visited < LUA_TIMER_WHEEL_SIZE; ++visited) {
+		auto& bucket = timerWheel[timerTick % LUA_TIMER_WHEEL_SIZE];
 
-	//push parameters
-	for (auto parameter : boost::adaptors::reverse(timerEventDesc.parameters)) {
-		lua_rawgeti(luaState, LUA_REGISTRYINDEX, parameter);
+		// the due timers are at the head, the rest is due later in this tick or in a later turn of the wheel
+		while (bucket.first != 0) {
+			uint32_t index = bucket.first;
+			LuaTimerEvent& event = timerSlots[index];
+			if (event.active && event.due > now) {
+				break;
+			}
+
+			bucket.first = event.next;
+			if (bucket.first == 0) {
+				bucket.second = 0;
+			}
+			--linkedTimers;
+
+			if (!event.active) {
+				event.next = freeTimerSlot;
+				freeTimerSlot = index;
+				continue;
+			}
+
+			executeTimerEvent(index);
+
+			// the state was closed by the callback
+			if (task != timerTask) {
+				return;
+			}
+		}
+
+		if (timerTick >= tick) {
+			break;
+		}
+		++timerTick;
+	}
+	timerTick = std::max(timerTick, tick);
+
+	if (linkedTimers != 0) {
+		scheduleTimerEvents(OTSYS_TIME());
+	} else {
+		timerTaskPending = false;
+	}
+}
+
+void LuaEnvironment::executeTimerEvent(uint32_t index)
+{
+	LuaTimerEvent& event = timerSlots[index];
+	int32_t scriptId = event.scriptId;
+	uint16_t parameters = event.parameters;
+	LuaTimerScripts::iterator script = event.script;
+
+	lua_rawgeti(luaState, LUA_REGISTRYINDEX, event.ref);
+	releaseTimerEvent(luaState, event);
+	event.next = freeTimerSlot;
+	freeTimerSlot = index;
+
+	if (parameters != 0) {
+		int table = lua_gettop(luaState);
+		for (int i = 1; i <= parameters + 1; ++i) {
+			lua_rawgeti(luaState, table, i);
+		}
+		lua_remove(luaState, table);
 	}
 
 	//call the function
 	if (reserveScriptEnv()) {
 		ScriptEnvironment* env = getScriptEnv();
 		env->setTimerEvent();
-		env->setScriptId(timerEventDesc.scriptId, this);
-		callFunction(timerEventDesc.parameters.size());
+		env->setScriptId(scriptId, this);
+
+		executingTimerScript = script;
+		callFunction(parameters);
+		executingTimerScript = timerScripts.end();
 	} else {
+		lua_pop(luaState, parameters + 1);
 		console::reportOverflow("LuaScriptInterface::executeTimerEvent");
 	}
-
-	//free resources
-	luaL_unref(luaState, LUA_REGISTRYINDEX, timerEventDesc.function);
-	for (auto parameter : timerEventDesc.parameters) {
-		luaL_unref(luaState, LUA_REGISTRYINDEX, parameter);
-	}
 }
@@ -27,10 +27,14 @@ class InstantSpell;
 class Item;
 class LuaScriptInterface;
 class LuaVariant;
+class Monster;
 class Npc;
 class Player;
+class Podium;
 class RuneSpell;
+class Teleport;
 class Thing;
+class Tile;
 struct Familiar;
 struct LootBlock;
 struct Mount;
@@ -56,16 +60,23 @@ enum LuaDataType {
 	LuaData_Tile,
 };
 
-struct LuaTimerEventDesc {
-	int32_t scriptId = -1;
-	int32_t function = -1;
-	std::vector<int32_t> parameters;
-	uint32_t eventId = 0;
+// live addEvent timers per creating script
+using LuaTimerScripts = std::map<std::string, uint32_t, std::less<>>;
 
-	LuaTimerEventDesc() = default;
-	LuaTimerEventDesc(LuaTimerEventDesc&& other) = default;
+// one addEvent timer, slots are reused once the wheel passed them
+struct LuaTimerEvent {
+	LuaTimerScripts::iterator script;
+	int64_t due = 0;
+	uint32_t generation = 0;
+	uint32_t next = 0; // next slot in the same wheel bucket (ordered by due) or in the free list
+	int32_t scriptId = -1;
+	int32_t ref = -1; // the callback, or a table holding the callback and its arguments
+	uint16_t parameters = 0;
+	bool active = false;
 };
 
+static constexpr size_t LUA_TIMER_WHEEL_SIZE = 512;
+
 class ScriptEnvironment
 {
 	public:
@@ -94,6 +105,9 @@ class ScriptEnvironment
 		void setTimerEvent() {
 			timerEvent = true;
 		}
+		bool isTimerEvent() const {
+			return timerEvent;
+		}
 
 		void getEventInfo(int32_t& scriptId, LuaScriptInterface*& scriptInterface, int32_t& callbackId, bool& timerEvent) const;
 
@@ -230,8 +244,38 @@ class LuaScriptInterface
 		template<class T>
 		static void pushUserdata(lua_State* L, T* value)
 		{
+			if constexpr (isCachedUserdata<T>()) {
+				if (pushCachedUserdata(L, value)) {
+					return;
+				}
+			}
+
 			T** userdata = static_cast<T**>(lua_newuserdata(L, sizeof(T*)));
 			*userdata = value;
+
+			if constexpr (isCachedUserdata<T>()) {
+				cacheUserdata(L, value);
+			}
+		}
+
+		// game objects pushed often enough to reuse their userdata, see luaUserdataCache
+		template<class T>
+		static constexpr bool isCachedUserdata()
+		{
+			return std::is_same<T, Creature>::value || std::is_same<T, Player>::value || std::is_same<T, Monster>::value ||
+			       std::is_same<T, Npc>::value || std::is_same<T, Item>::value || std::is_same<T, Container>::value ||
+			       std::is_same<T, Teleport>::value || std::is_same<T, Podium>::value || std::is_same<T, Tile>::value;
+		}
+		static bool pushCachedUserdata(lua_State* L, void* value);
+		static void cacheUserdata(lua_State* L, void* value);
+		// called by the destructors of cached types, the address may be reused afterwards
+		static void removeCachedUserdata(void* value);
+
+		static uint64_t getUserdataCreated() {
+			return userdataCreated;
+		}
+		static uint64_t getUserdataReused() {
+			return userdataReused;
 		}
 
 		// Shared Ptr
@@ -243,6 +287,7 @@ class LuaScriptInterface
 
 		// Metatables
 		static void setMetatable(lua_State* L, int32_t index, const std::string& name);
+		static void setMetatable(lua_State* L, int32_t index, LuaDataType type);
 		static void setWeakMetatable(lua_State* L, int32_t index, const std::string& name);
 
 		static void setItemMetatable(lua_State* L, int32_t index, const Item* item);
@@ -531,6 +576,10 @@ class LuaScriptInterface
 
 		// Game
 		static int luaGameGetSpectators(lua_State* L);
+		static int luaGameGetSpectatorIds(lua_State* L);
+		static int luaGameGetAreaPositions(lua_State* L);
+		static int luaGameRemoveItems(lua_State* L);
+		static int luaGameTransformItems(lua_State* L);
 		static int luaGameGetPlayers(lua_State* L);
 		static int luaGameGetMonsterIds(lua_State* L);
 		static int luaGameLoadMap(lua_State* L);
@@ -541,6 +590,8 @@ class LuaScriptInterface
 		static int luaGameGetMonsterCount(lua_State* L);
 		static int luaGameGetPlayerCount(lua_State* L);
 		static int luaGameGetNpcCount(lua_State* L);
+		static int luaGameGetActiveCreatureCount(lua_State* L);
+		static int luaGameGetSleepingCreatureCount(lua_State* L);
 		static int luaGameGetMonsterTypes(lua_State* L);
 		static int luaGameGetCurrencyItems(lua_State* L);
 		static int luaGameGetMountIdByLookType(lua_State* L);
@@ -573,11 +624,22 @@ class LuaScriptInterface
 		static int luaGameCreateMonsterType(lua_State* L);
 
 		static int luaGameStartRaid(lua_State* L);
+		static int luaGameRespawnMonsters(lua_State* L);
 
 		static int luaGameGetClientVersion(lua_State* L);
 
 		static int luaGameReload(lua_State* L);
 
+		static int luaGameSetLuaProfiler(lua_State* L);
+		static int luaGameDumpLuaProfile(lua_State* L);
+		static int luaGameGetTimerEventCounts(lua_State* L);
+		static int luaGameGetLuaGcStats(lua_State* L);
+		static int luaGameBenchmarkSayDispatch(lua_State* L);
+		static int luaGamePrintStats(lua_State* L);
+		static int luaGamePostShard(lua_State* L);
+		static int luaGameOnShardMessage(lua_State* L);
+		static int luaGameGetShardCount(lua_State* L);
+
 		static int luaGameGetAccountStorageValue(lua_State* L);
 		static int luaGameSetAccountStorageValue(lua_State* L);
 		static int luaGameSaveAccountStorageValues(lua_State* L);
@@ -1404,6 +1466,7 @@ class LuaScriptInterface
 		static int luaMonsterTypeCanWalkOnEnergy(lua_State* L);
 		static int luaMonsterTypeCanWalkOnFire(lua_State* L);
 		static int luaMonsterTypeCanWalkOnPoison(lua_State* L);
+		static int luaMonsterTypeAsyncPathfinding(lua_State* L);
 
 		static int luaMonsterTypeName(lua_State* L);
 		static int luaMonsterTypeNameDescription(lua_State* L);
@@ -1663,6 +1726,9 @@ class LuaScriptInterface
 		static ScriptEnvironment scriptEnv[16];
 		static int32_t scriptEnvIndex;
 
+		static uint64_t userdataCreated;
+		static uint64_t userdataReused;
+
 		std::string loadingFile;
 };
 
@@ -1690,10 +1756,40 @@ class LuaEnvironment : public LuaScriptInterface
 		uint32_t createAreaObject(LuaScriptInterface* interface);
 		void clearAreaObjects(LuaScriptInterface* interface);
 
-	private:
-		void executeTimerEvent(uint32_t eventIndex);
+		const LuaTimerScripts& getTimerScripts() const {
+			return timerScripts;
+		}
+		uint64_t getTimersCreated() const {
+			return timersCreated;
+		}
+		uint32_t getPeakTimers() const {
+			return peakTimers;
+		}
 
-		std::unordered_map<uint32_t, LuaTimerEventDesc> timerEvents;
+	private:
+		uint64_t addTimerEvent(lua_State* L, int64_t delay, uint16_t parameters);
+		bool stopTimerEvent(lua_State* L, uint64_t eventId);
+		void linkTimerEvent(uint32_t index);
+		void releaseTimerEvent(lua_State* L, LuaTimerEvent& event);
+		void scheduleTimerEvents(int64_t now);
+		void executeTimerEvents(uint32_t task);
+		void executeTimerEvent(uint32_t index);
+
+		// slot 0 is unused so that 0 can end the bucket and free lists
+		std::vector<LuaTimerEvent> timerSlots;
+		// first and last slot of the timers due in each tick of a wheel turn
+		std::array<std::pair<uint32_t, uint32_t>, LUA_TIMER_WHEEL_SIZE> timerWheel = {};
+		LuaTimerScripts timerScripts;
+		LuaTimerScripts::iterator executingTimerScript;
+		int64_t timerTick = 0;
+		uint64_t timersCreated = 0;
+		uint32_t freeTimerSlot = 0;
+		uint32_t linkedTimers = 0;
+		uint32_t liveTimers = 0;
+		uint32_t peakTimers = 0;
+		// tells the scheduled wheel task of a closed state apart
+		uint32_t timerTask = 0;
+		bool timerTaskPending = false;
 		std::unordered_map<uint32_t, Combat_ptr> combatMap;
 		std::unordered_map<uint32_t, AreaCombat*> areaMap;
 
@@ -1702,7 +1798,6 @@ class LuaEnvironment : public LuaScriptInterface
 
 		LuaScriptInterface* testInterface = nullptr;
 
-		uint32_t lastEventTimerId = 1;
 		uint32_t lastCombatId = 0;
 		uint32_t lastAreaId = 0;
 
@@ -9,10 +9,15 @@
 #include "game.h"
 #include "iomap.h"
 #include "iomapserialize.h"
+#include "journal.h"
 #include "monster.h"
+#include "movement.h"
 #include "spectators.h"
+#include "tasks.h"
+#include "workerpool.h"
 
 extern Game g_game;
+extern MoveEvents* g_moveEvents;
 
 bool Map::loadMap(const std::string& identifier, bool loadHouses)
 {
@@ -53,7 +58,7 @@ bool Map::save()
 
 	saved = false;
 	for (uint32_t tries = 0; tries < 3; tries++) {
-		if (IOMapSerialize::saveHouseItems()) {
+		if (g_journal.record([]() { return IOMapSerialize::saveHouseItems(); })) {
 			saved = true;
 			break;
 		}
@@ -139,6 +144,9 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 		delete newTile;
 	} else {
 		tile = newTile;
+		if (g_moveEvents && g_moveEvents->hasPositionEvent(tile->getPosition())) {
+			tile->setFlag(TILESTATE_MOVEEVENT);
+		}
 	}
 }
 
@@ -333,6 +341,13 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 		}
 	}
 
+	// only the moved creature changed, so whoever could see the new position still can; seeding
+	// the cache lets the moved creature look around without another scan
+	if (std::find(newPosSpectators.begin(), newPosSpectators.end(), &creature) == newPosSpectators.end()) {
+		newPosSpectators.emplace_back(&creature);
+	}
+	spectatorCache[newPos] = std::move(newPosSpectators);
+
 	//event method
 	for (Creature* spectator : spectators) {
 		spectator->onCreatureMove(&creature, &newTile, newPos, &oldTile, oldPos, teleport);
@@ -342,7 +357,8 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 	newTile.postAddNotification(&creature, &oldTile, 0);
 }
 
-void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const
+template<typename Function>
+bool Map::findSpectator(const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers, Function&& f) const
 {
 	auto min_y = centerPos.y + minRangeY;
 	auto min_x = centerPos.x + minRangeX;
@@ -382,7 +398,9 @@ void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& center
 						continue;
 					}
 
-					spectators.emplace_back(creature);
+					if (f(creature)) {
+						return true;
+					}
 				}
 				leafE = leafE->leafE;
 			} else {
@@ -396,6 +414,26 @@ void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& center
 			leafS = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, startx1, ny + FLOOR_SIZE);
 		}
 	}
+	return false;
+}
+
+void Map::getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const
+{
+	findSpectator(centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers, [&spectators](Creature* creature) {
+		spectators.emplace_back(creature);
+		return false;
+	});
+}
+
+bool Map::isPlayerInView(const Position& centerPos) const
+{
+	if (centerPos.z >= MAP_MAX_LAYERS) {
+		return false;
+	}
+
+	return findSpectator(centerPos, -maxViewportX, maxViewportX, -maxViewportY, maxViewportY, centerPos.z, centerPos.z, true, [](Creature* creature) {
+		return !creature->getPlayer()->hasFlag(PlayerFlag_IgnoredByMonsters);
+	});
 }
 
 void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, bool multifloor /*= false*/, bool onlyPlayers /*= false*/, int32_t minRangeX /*= 0*/, int32_t maxRangeX /*= 0*/, int32_t minRangeY /*= 0*/, int32_t maxRangeY /*= 0*/)
@@ -423,6 +461,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 				}
 
 				foundCache = true;
+				++spectatorCacheHits;
 			}
 		}
 
@@ -446,6 +485,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 				}
 
 				foundCache = true;
+				++spectatorCacheHits;
 			} else {
 				cacheResult = true;
 			}
@@ -477,6 +517,7 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 		}
 
 		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+		++spectatorScans;
 
 		if (cacheResult) {
 			if (onlyPlayers) {
@@ -524,7 +565,8 @@ bool Map::isTileClear(uint16_t x, uint16_t y, uint8_t z, bool blockFloor /*= fal
 
 namespace {
 
-bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z)
+template <typename IsClear>
+bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const IsClear& isClear)
 {
 	float dx = x1 - x0;
 	float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
@@ -532,7 +574,7 @@ bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t
 
 	for (uint16_t x = x0 + 1; x < x1; ++x) {
 		//0.1 is necessary to avoid loss of precision during calculation
-		if (!g_game.map.isTileClear(std::floor(yi + 0.1), x, z)) {
+		if (!isClear(std::floor(yi + 0.1), x)) {
 			return false;
 		}
 		yi += slope;
@@ -541,7 +583,8 @@ bool checkSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t
 	return true;
 }
 
-bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z)
+template <typename IsClear>
+bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const IsClear& isClear)
 {
 	float dx = x1 - x0;
 	float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
@@ -549,7 +592,7 @@ bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t
 
 	for (uint16_t x = x0 + 1; x < x1; ++x) {
 		//0.1 is necessary to avoid loss of precision during calculation
-		if (!g_game.map.isTileClear(x, std::floor(yi + 0.1), z)) {
+		if (!isClear(x, std::floor(yi + 0.1))) {
 			return false;
 		}
 		yi += slope;
@@ -558,9 +601,9 @@ bool checkSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t
 	return true;
 }
 
-}
-
-bool Map::checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z) const
+// isClear(x, y) tells whether a tile lets projectiles through
+template <typename IsClear>
+bool checkLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const IsClear& isClear)
 {
 	if (x0 == x1 && y0 == y1) {
 		return true;
@@ -568,16 +611,23 @@ bool Map::checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uin
 
 	if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
 		if (y1 > y0) {
-			return checkSteepLine(y0, x0, y1, x1, z);
+			return checkSteepLine(y0, x0, y1, x1, isClear);
 		}
-		return checkSteepLine(y1, x1, y0, x0, z);
+		return checkSteepLine(y1, x1, y0, x0, isClear);
 	}
 
 	if (x0 > x1) {
-		return checkSlightLine(x1, y1, x0, y0, z);
+		return checkSlightLine(x1, y1, x0, y0, isClear);
 	}
 
-	return checkSlightLine(x0, y0, x1, y1, z);
+	return checkSlightLine(x0, y0, x1, y1, isClear);
+}
+
+}
+
+bool Map::checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z) const
+{
+	return checkLine(x0, y0, x1, y1, [this, z](uint16_t x, uint16_t y) { return isTileClear(x, y, z); });
 }
 
 bool Map::isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor /*= false*/) const
@@ -657,9 +707,14 @@ const Tile* Map::canWalkTo(const Creature& creature, const Position& pos) const
 	return tile;
 }
 
-bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp) const
+namespace {
+
+// walkCost(pos, known) gives the extra cost of stepping on pos or -1 if it is blocked, known is set for tiles
+// that were walkable before. sightClear(pos) checks the line of sight from pos to the target
+template <typename WalkCost, typename SightClear>
+bool searchPath(Position pos, const Position& targetPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition,
+                const FindPathParams& fpp, const WalkCost& walkCost, const SightClear& sightClear, size_t& nodeCount)
 {
-	Position pos = creature.getPosition();
 	Position endPos;
 
 	AStarNodes nodes(pos.x, pos.y);
@@ -689,6 +744,7 @@ bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vec
 			if (found) {
 				break;
 			}
+			nodeCount = nodes.getNodeCount();
 			return false;
 		}
 
@@ -696,7 +752,7 @@ bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vec
 		const int_fast32_t y = n->y;
 		pos.x = x;
 		pos.y = y;
-		if (pathCondition(startPos, pos, fpp, bestMatch)) {
+		if (pathCondition.isInRange(startPos, pos, fpp) && (!fpp.clearSight || sightClear(pos)) && pathCondition.isInDistance(pos, fpp, bestMatch)) {
 			found = n;
 			endPos = pos;
 			if (bestMatch == 0) {
@@ -751,20 +807,14 @@ bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vec
 				continue;
 			}
 
-			const Tile* tile;
 			AStarNode* neighborNode = nodes.getNodeByPosition(pos.x, pos.y);
-			if (neighborNode) {
-				tile = getTile(pos.x, pos.y, pos.z);
-			} else {
-				tile = canWalkTo(creature, pos);
-				if (!tile) {
-					continue;
-				}
+			const int_fast32_t extraCost = walkCost(pos, neighborNode != nullptr);
+			if (extraCost < 0) {
+				continue;
 			}
 
 			//The cost (g) for this neighbor
 			const int_fast32_t cost = AStarNodes::getMapWalkCost(n, pos);
-			const int_fast32_t extraCost = AStarNodes::getTileWalkCost(creature, tile);
 			const int_fast32_t newf = f + cost + extraCost;
 
 			if (neighborNode) {
@@ -785,6 +835,7 @@ bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vec
 					if (found) {
 						break;
 					}
+					nodeCount = nodes.getNodeCount();
 					return false;
 				}
 			}
@@ -793,6 +844,8 @@ bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vec
 		nodes.closeNode(n);
 	}
 
+	nodeCount = nodes.getNodeCount();
+
 	if (!found) {
 		return false;
 	}
@@ -834,6 +887,127 @@ bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vec
 	return true;
 }
 
+// walkability of the tiles around a creature, copied on the dispatcher so a worker can search a path in it
+struct PathSnapshot {
+	Position origin;
+	int32_t size = 0;
+	std::vector<int16_t> walkCosts;
+	std::vector<bool> sightClear;
+
+	bool contains(uint16_t x, uint16_t y) const {
+		return x >= origin.x && y >= origin.y && x - origin.x < size && y - origin.y < size;
+	}
+	size_t getIndex(uint16_t x, uint16_t y) const {
+		return (y - origin.y) * size + (x - origin.x);
+	}
+
+	int_fast32_t getWalkCost(const Position& pos) const {
+		return contains(pos.x, pos.y) ? walkCosts[getIndex(pos.x, pos.y)] : -1;
+	}
+	bool isSightClear(const Position& fromPos, const Position& toPos) const {
+		if (Position::getDistanceX(fromPos, toPos) < 2 && Position::getDistanceY(fromPos, toPos) < 2) {
+			return true;
+		}
+		return checkLine(fromPos.x, fromPos.y, toPos.x, toPos.y, [this](uint16_t x, uint16_t y) { return !contains(x, y) || sightClear[getIndex(x, y)]; });
+	}
+};
+
+// larger snapshots cost the dispatcher more than the search they save
+constexpr int32_t MAX_PATH_SNAPSHOT_RADIUS = 16;
+
+}
+
+bool Map::getPathMatching(const Creature& creature, Position targetPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp) const
+{
+	++pathSearches;
+
+	size_t nodeCount = 0;
+	bool found = searchPath(creature.getPosition(), targetPos, dirList, pathCondition, fpp,
+		[&](const Position& pos, bool known) -> int_fast32_t {
+			const Tile* tile = known ? getTile(pos.x, pos.y, pos.z) : canWalkTo(creature, pos);
+			if (!tile) {
+				return -1;
+			}
+			return AStarNodes::getTileWalkCost(creature, tile);
+		},
+		[&](const Position& pos) { return isSightClear(pos, targetPos, true); }, nodeCount);
+
+	pathSearchNodes += nodeCount;
+	return found;
+}
+
+bool Map::getPathMatchingAsync(const Creature& creature, const Position& targetPos, const FindPathParams& fpp, PathCallback&& onResult)
+{
+	const Position& startPos = creature.getPosition();
+	const int32_t radius = fpp.maxSearchDist;
+	if (g_workerPool.getThreadCount() == 0 || radius <= 0 || radius > MAX_PATH_SNAPSHOT_RADIUS || startPos.z != targetPos.z ||
+	        startPos.x < radius || startPos.y < radius) {
+		return false;
+	}
+
+	// the sight line to the target has to stay inside the snapshot
+	if (fpp.clearSight && (Position::getDistanceX(startPos, targetPos) > radius || Position::getDistanceY(startPos, targetPos) > radius)) {
+		return false;
+	}
+
+	// nothing in the way, the search expands a few nodes and costs less than a snapshot
+	if (checkLine(startPos.x, startPos.y, targetPos.x, targetPos.y, [&](uint16_t x, uint16_t y) { return canWalkTo(creature, Position(x, y, startPos.z)) != nullptr; })) {
+		++asyncPathStats.direct;
+		return false;
+	}
+
+	auto snapshotStart = std::chrono::steady_clock::now();
+
+	auto snapshot = std::make_shared<PathSnapshot>();
+	snapshot->origin = Position(startPos.x - radius, startPos.y - radius, startPos.z);
+	snapshot->size = radius * 2 + 1;
+	snapshot->walkCosts.resize(snapshot->size * snapshot->size);
+	if (fpp.clearSight) {
+		snapshot->sightClear.resize(snapshot->size * snapshot->size);
+	}
+
+	size_t index = 0;
+	for (int32_t y = 0; y < snapshot->size; ++y) {
+		for (int32_t x = 0; x < snapshot->size; ++x, ++index) {
+			Position pos(snapshot->origin.x + x, snapshot->origin.y + y, startPos.z);
+			const Tile* tile = canWalkTo(creature, pos);
+			snapshot->walkCosts[index] = tile ? AStarNodes::getTileWalkCost(creature, tile) : -1;
+			if (fpp.clearSight) {
+				snapshot->sightClear[index] = isTileClear(pos.x, pos.y, pos.z);
+			}
+		}
+	}
+
+	auto requested = std::chrono::steady_clock::now();
+	asyncPathStats.snapshotTime += std::chrono::duration_cast<std::chrono::microseconds>(requested - snapshotStart);
+	asyncPathStats.peakPending = std::max(asyncPathStats.peakPending, ++asyncPathStats.pending);
+
+	g_workerPool.addTask([this, snapshot, startPos, targetPos, fpp, requested, onResult = std::move(onResult)]() mutable {
+		std::vector<Direction> dirList;
+		size_t nodeCount = 0;
+		bool found = searchPath(startPos, targetPos, dirList, FrozenPathingConditionCall(targetPos), fpp,
+			[&](const Position& pos, bool) { return snapshot->getWalkCost(pos); },
+			[&](const Position& pos) { return snapshot->isSightClear(pos, targetPos); }, nodeCount);
+
+		g_dispatcher.addTask(createTask([this, found, nodeCount, requested, dirList = std::move(dirList), onResult = std::move(onResult)]() mutable {
+			auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - requested);
+
+			--asyncPathStats.pending;
+			++asyncPathStats.searches;
+			asyncPathStats.latency += latency;
+			asyncPathStats.maxLatency = std::max(asyncPathStats.maxLatency, latency);
+
+			++pathSearches;
+			pathSearchNodes += nodeCount;
+
+			if (!onResult(found, dirList)) {
+				++asyncPathStats.discarded;
+			}
+		}));
+	});
+	return true;
+}
+
 // AStarNodes
 
 AStarNodes::AStarNodes(uint32_t x, uint32_t y)
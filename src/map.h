@@ -35,6 +35,9 @@ class AStarNodes
 		void closeNode(AStarNode* node);
 		void openNode(AStarNode* node);
 		int_fast32_t getClosedNodes() const;
+		size_t getNodeCount() const {
+			return curNode;
+		}
 		AStarNode* getNodeByPosition(uint32_t x, uint32_t y);
 
 		static int_fast32_t getMapWalkCost(AStarNode* node, const Position& neighborPos);
@@ -50,6 +53,19 @@ class AStarNodes
 
 using SpectatorCache = std::map<Position, SpectatorVec>;
 
+struct AsyncPathStats {
+	uint64_t searches = 0;
+	uint64_t discarded = 0;
+	// searches with nothing in the way, left on the dispatcher
+	uint64_t direct = 0;
+	size_t pending = 0;
+	size_t peakPending = 0;
+	std::chrono::microseconds latency{0};
+	std::chrono::microseconds maxLatency{0};
+	// dispatcher time spent copying the tiles for the workers
+	std::chrono::microseconds snapshotTime{0};
+};
+
 static constexpr int32_t FLOOR_BITS = 3;
 static constexpr int32_t FLOOR_SIZE = (1 << FLOOR_BITS);
 static constexpr int32_t FLOOR_MASK = (FLOOR_SIZE - 1);
@@ -207,9 +223,28 @@ class Map
 		                   int32_t minRangeX = 0, int32_t maxRangeX = 0,
 		                   int32_t minRangeY = 0, int32_t maxRangeY = 0);
 
+		// same floor and range as getSpectators, players ignored by monsters don't count
+		bool isPlayerInView(const Position& centerPos) const;
+
 		void clearSpectatorCache();
 		void clearPlayersSpectatorCache();
 
+		uint64_t getSpectatorScans() const {
+			return spectatorScans;
+		}
+		uint64_t getSpectatorCacheHits() const {
+			return spectatorCacheHits;
+		}
+		uint64_t getPathSearches() const {
+			return pathSearches;
+		}
+		uint64_t getPathSearchNodes() const {
+			return pathSearchNodes;
+		}
+		const AsyncPathStats& getAsyncPathStats() const {
+			return asyncPathStats;
+		}
+
 		/**
 		  * Checks if you can throw an object to that position
 		  *	\param fromPos from Source point
@@ -246,6 +281,15 @@ class Map
 		bool getPathMatching(const Creature& creature, Position targetPos, std::vector<Direction>& dirList,
 		                     const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp) const;
 
+		// gets called on the dispatcher with the search result, returns false when the result was stale
+		using PathCallback = std::function<bool(bool, std::vector<Direction>&)>;
+
+		/**
+		  * Searches the path on a worker thread, in a copy of the tiles within fpp.maxSearchDist
+		  *	\returns false if the search can't run asynchronously, onResult is not called then
+		  */
+		bool getPathMatchingAsync(const Creature& creature, const Position& targetPos, const FindPathParams& fpp, PathCallback&& onResult);
+
 		std::map<std::string, Position> waypoints;
 
 		QTreeLeafNode* getQTNode(uint16_t x, uint16_t y) {
@@ -260,6 +304,12 @@ class Map
 		SpectatorCache spectatorCache;
 		SpectatorCache playersSpectatorCache;
 
+		uint64_t spectatorScans = 0;
+		uint64_t spectatorCacheHits = 0;
+		mutable uint64_t pathSearches = 0;
+		mutable uint64_t pathSearchNodes = 0;
+		AsyncPathStats asyncPathStats;
+
 		QTreeNode root;
 
 		std::string spawnfile;
@@ -274,6 +324,13 @@ class Map
 		                           int32_t minRangeY, int32_t maxRangeY,
 		                           int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const;
 
+		// calls f for every creature in range until it returns true
+		template<typename Function>
+		bool findSpectator(const Position& centerPos,
+		                   int32_t minRangeX, int32_t maxRangeX,
+		                   int32_t minRangeY, int32_t maxRangeY,
+		                   int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers, Function&& f) const;
+
 		friend class Game;
 		friend class IOMap;
 };
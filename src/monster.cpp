@@ -17,6 +17,9 @@ extern Monsters g_monsters;
 extern Events* g_events;
 extern ConfigManager g_config;
 
+// full target rescans only catch opponents that changed without moving (party, flags, masters)
+static constexpr uint32_t TARGET_RESCAN_INTERVAL = 10000;
+
 int32_t Monster::despawnRange;
 int32_t Monster::despawnRadius;
 
@@ -67,6 +70,10 @@ void Monster::addList()
 void Monster::removeList()
 {
 	g_game.removeMonster(this);
+
+	if (spawn) {
+		spawn->removeMonster(this);
+	}
 }
 
 const std::string& Monster::getName() const
@@ -142,7 +149,7 @@ void Monster::onCreatureAppear(Creature* creature, bool isLogin)
 		scriptInterface->pushFunction(mType->info.creatureAppearEvent);
 
 		LuaScriptInterface::pushUserdata<Monster>(L, this);
-		LuaScriptInterface::setMetatable(L, -1, "Monster");
+		LuaScriptInterface::setMetatable(L, -1, LuaData_Monster);
 
 		LuaScriptInterface::pushUserdata<Creature>(L, creature);
 		LuaScriptInterface::setCreatureMetatable(L, -1, creature);
@@ -184,7 +191,7 @@ void Monster::onRemoveCreature(Creature* creature, bool isLogout)
 		scriptInterface->pushFunction(mType->info.creatureDisappearEvent);
 
 		LuaScriptInterface::pushUserdata<Monster>(L, this);
-		LuaScriptInterface::setMetatable(L, -1, "Monster");
+		LuaScriptInterface::setMetatable(L, -1, LuaData_Monster);
 
 		LuaScriptInterface::pushUserdata<Creature>(L, creature);
 		LuaScriptInterface::setCreatureMetatable(L, -1, creature);
@@ -195,10 +202,6 @@ void Monster::onRemoveCreature(Creature* creature, bool isLogout)
 	}
 
 	if (creature == this) {
-		if (spawn) {
-			spawn->startSpawnCheck();
-		}
-
 		setIdle(true);
 	} else {
 		onCreatureLeave(creature);
@@ -225,7 +228,7 @@ void Monster::onCreatureMove(Creature* creature, const Tile* newTile, const Posi
 		scriptInterface->pushFunction(mType->info.creatureMoveEvent);
 
 		LuaScriptInterface::pushUserdata<Monster>(L, this);
-		LuaScriptInterface::setMetatable(L, -1, "Monster");
+		LuaScriptInterface::setMetatable(L, -1, LuaData_Monster);
 
 		LuaScriptInterface::pushUserdata<Creature>(L, creature);
 		LuaScriptInterface::setCreatureMetatable(L, -1, creature);
@@ -307,7 +310,7 @@ void Monster::onCreatureSay(Creature* creature, MessageClasses type, const std::
 		scriptInterface->pushFunction(mType->info.creatureSayEvent);
 
 		LuaScriptInterface::pushUserdata<Monster>(L, this);
-		LuaScriptInterface::setMetatable(L, -1, "Monster");
+		LuaScriptInterface::setMetatable(L, -1, LuaData_Monster);
 
 		LuaScriptInterface::pushUserdata<Creature>(L, creature);
 		LuaScriptInterface::setCreatureMetatable(L, -1, creature);
@@ -322,15 +325,15 @@ void Monster::onCreatureSay(Creature* creature, MessageClasses type, const std::
 void Monster::addFriend(Creature* creature)
 {
 	assert(creature != this);
-	auto result = friendList.insert(creature);
-	if (result.second) {
+	if (std::find(friendList.begin(), friendList.end(), creature) == friendList.end()) {
 		creature->incrementReferenceCounter();
+		friendList.push_back(creature);
 	}
 }
 
 void Monster::removeFriend(Creature* creature)
 {
-	auto it = friendList.find(creature);
+	auto it = std::find(friendList.begin(), friendList.end(), creature);
 	if (it != friendList.end()) {
 		creature->decrementReferenceCounter();
 		friendList.erase(it);
@@ -343,7 +346,7 @@ void Monster::addTarget(Creature* creature, bool pushFront/* = false*/)
 	if (std::find(targetList.begin(), targetList.end(), creature) == targetList.end()) {
 		creature->incrementReferenceCounter();
 		if (pushFront) {
-			targetList.push_front(creature);
+			targetList.insert(targetList.begin(), creature);
 		} else {
 			targetList.push_back(creature);
 		}
@@ -361,34 +364,27 @@ void Monster::removeTarget(Creature* creature)
 
 void Monster::updateTargetList()
 {
-	auto friendIterator = friendList.begin();
-	while (friendIterator != friendList.end()) {
-		Creature* creature = *friendIterator;
+	auto isGone = [this](Creature* creature) {
 		if (creature->getHealth() <= 0 || !canSee(creature->getPosition())) {
 			creature->decrementReferenceCounter();
-			friendIterator = friendList.erase(friendIterator);
-		} else {
-			++friendIterator;
+			return true;
 		}
-	}
+		return false;
+	};
 
-	auto targetIterator = targetList.begin();
-	while (targetIterator != targetList.end()) {
-		Creature* creature = *targetIterator;
-		if (creature->getHealth() <= 0 || !canSee(creature->getPosition())) {
-			creature->decrementReferenceCounter();
-			targetIterator = targetList.erase(targetIterator);
-		} else {
-			++targetIterator;
-		}
-	}
+	friendList.erase(std::remove_if(friendList.begin(), friendList.end(), isGone), friendList.end());
+	targetList.erase(std::remove_if(targetList.begin(), targetList.end(), isGone), targetList.end());
 
+	// creatures entering our view are reported through onCreatureMove, this only picks up
+	// what came into view by our own movement and is served by the map's spectator cache
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, position, true);
 	spectators.erase(this);
 	for (Creature* spectator : spectators) {
 		onCreatureFound(spectator);
 	}
+
+	targetScanTicks = 0;
 }
 
 void Monster::clearTargetList()
@@ -513,16 +509,28 @@ void Monster::onCreatureLeave(Creature* creature)
 
 bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAULT*/)
 {
-	std::list<Creature*> resultList;
+	CreatureList resultList;
 	const Position& myPos = getPosition();
 
-	for (Creature* creature : targetList) {
-		if (followCreature != creature && isTarget(creature)) {
-			if (searchType == TARGETSEARCH_RANDOM || canUseAttack(myPos, creature)) {
+	if (searchType == TARGETSEARCH_DEFAULT && decision.searchedTargets && decision.position == myPos) {
+		// the sight checks were done by prepareThink, only keep targets that didn't move since
+		for (const auto& it : decision.targets) {
+			Creature* creature = it.first;
+			if (followCreature != creature && std::find(targetList.begin(), targetList.end(), creature) != targetList.end() &&
+			        creature->getPosition() == it.second && isTarget(creature)) {
 				resultList.push_back(creature);
 			}
 		}
+	} else {
+		for (Creature* creature : targetList) {
+			if (followCreature != creature && isTarget(creature)) {
+				if (searchType == TARGETSEARCH_RANDOM || canUseAttack(myPos, creature)) {
+					resultList.push_back(creature);
+				}
+			}
+		}
 	}
+	decision.searchedTargets = false;
 
 	switch (searchType) {
 		case TARGETSEARCH_NEAREST: {
@@ -571,9 +579,7 @@ bool Monster::searchTarget(TargetSearchType_t searchType /*= TARGETSEARCH_DEFAUL
 		case TARGETSEARCH_RANDOM:
 		default: {
 			if (!resultList.empty()) {
-				auto it = resultList.begin();
-				std::advance(it, uniform_random(0, resultList.size() - 1));
-				return selectTarget(*it);
+				return selectTarget(resultList[uniform_random(0, resultList.size() - 1)]);
 			}
 
 			if (searchType == TARGETSEARCH_ATTACKRANGE) {
@@ -602,7 +608,7 @@ void Monster::onFollowCreatureComplete(const Creature* creature)
 			targetList.erase(it);
 
 			if (hasFollowPath) {
-				targetList.push_front(target);
+				targetList.insert(targetList.begin(), target);
 			} else if (!isSummon()) {
 				targetList.push_back(target);
 			} else {
@@ -692,7 +698,7 @@ void Monster::setIdle(bool idle)
 		onIdleStatus();
 		clearTargetList();
 		clearFriendList();
-		Game::removeCreatureCheck(this);
+		g_game.sleepCreature(this);
 	}
 }
 
@@ -752,7 +758,7 @@ void Monster::onThink(uint32_t interval)
 		scriptInterface->pushFunction(mType->info.thinkEvent);
 
 		LuaScriptInterface::pushUserdata<Monster>(L, this);
-		LuaScriptInterface::setMetatable(L, -1, "Monster");
+		LuaScriptInterface::setMetatable(L, -1, LuaData_Monster);
 
 		lua_pushnumber(L, interval);
 
@@ -770,6 +776,11 @@ void Monster::onThink(uint32_t interval)
 			setIdle(true);
 		}
 	} else {
+		targetScanTicks += interval;
+		if (targetScanTicks >= TARGET_RESCAN_INTERVAL) {
+			updateTargetList();
+		}
+
 		updateIdleStatus();
 
 		if (!isIdle) {
@@ -807,6 +818,36 @@ void Monster::onThink(uint32_t interval)
 	}
 }
 
+void Monster::prepareThink()
+{
+	decision.position = getPosition();
+	decision.targets.clear();
+	decision.searchedTargets = false;
+	decision.step = DIRECTION_NONE;
+
+	if (isIdle) {
+		return;
+	}
+
+	// the same conditions onThink uses to call searchTarget
+	if (!isSummon() && !targetList.empty() && (!followCreature || !hasFollowPath)) {
+		for (Creature* creature : targetList) {
+			if (followCreature != creature && isTarget(creature) && canUseAttack(decision.position, creature)) {
+				decision.targets.emplace_back(creature, creature->getPosition());
+			}
+		}
+		decision.searchedTargets = true;
+	}
+
+	// the same conditions getNextStep uses to take a random step
+	if (!walkingToSpawn && (!followCreature || !hasFollowPath) && (!isSummon() || !isMasterInRange) && !isFamiliar()) {
+		Direction direction;
+		if (getRandomStep(decision.position, direction)) {
+			decision.step = direction;
+		}
+	}
+}
+
 void Monster::doAttacking(uint32_t interval)
 {
 	if (!attackedCreature || (isSummon() && attackedCreature == this)) {
@@ -1265,8 +1306,14 @@ bool Monster::getNextStep(Direction& direction, uint32_t& flags)
 		if (!isFamiliar()) {
 			if (getTimeSinceLastMove() >= 1000) {
 				randomStepping = true;
-				//choose a random direction
-				result = getRandomStep(getPosition(), direction);
+				//choose a random direction, prepareThink may have found one already
+				if (decision.step != DIRECTION_NONE && decision.position == getPosition() && canWalkTo(getPosition(), decision.step)) {
+					direction = decision.step;
+					result = true;
+				} else {
+					result = getRandomStep(getPosition(), direction);
+				}
+				decision.step = DIRECTION_NONE;
 			}
 		} else {
 			if (listWalkDir.empty()) {
@@ -1315,7 +1362,7 @@ bool Monster::getNextStep(Direction& direction, uint32_t& flags)
 
 bool Monster::getRandomStep(const Position& creaturePos, Direction& direction) const
 {
-	static std::vector<Direction> dirList{
+	std::array<Direction, 4> dirList{
 			DIRECTION_NORTH,
 		DIRECTION_WEST, DIRECTION_EAST,
 			DIRECTION_SOUTH
@@ -13,8 +13,7 @@ class Item;
 class Spawn;
 class Tile;
 
-using CreatureHashSet = std::unordered_set<Creature*>;
-using CreatureList = std::list<Creature*>;
+using CreatureList = std::vector<Creature*>;
 
 enum TargetSearchType_t {
 	TARGETSEARCH_DEFAULT,
@@ -140,6 +139,8 @@ class Monster final : public Creature
 		void onChangeZone(ZoneType_t zone) override;
 
 		void onThink(uint32_t interval) override;
+		// read-only part of onThink, runs on a worker thread while the dispatcher waits
+		void prepareThink();
 
 		bool challengeCreature(Creature* creature, bool force = false) override;
 
@@ -162,7 +163,7 @@ class Monster final : public Creature
 		const CreatureList& getTargetList() const {
 			return targetList;
 		}
-		const CreatureHashSet& getFriendList() const {
+		const CreatureList& getFriendList() const {
 			return friendList;
 		}
 
@@ -238,8 +239,17 @@ class Monster final : public Creature
 		static uint32_t monsterAutoID;
 
 	private:
-		CreatureHashSet friendList;
+		// made by prepareThink, checked against the world again before it is used
+		struct ThinkDecision {
+			Position position;
+			std::vector<std::pair<Creature*, Position>> targets;
+			Direction step = DIRECTION_NONE;
+			bool searchedTargets = false;
+		};
+
+		CreatureList friendList;
 		CreatureList targetList;
+		ThinkDecision decision;
 
 		std::string name;
 		std::string nameDescription;
@@ -254,6 +264,7 @@ class Monster final : public Creature
 		uint32_t targetChangeTicks = 0;
 		uint32_t defenseTicks = 0;
 		uint32_t yellTicks = 0;
+		uint32_t targetScanTicks = 0;
 		int32_t minCombatValue = 0;
 		int32_t maxCombatValue = 0;
 		int32_t targetChangeCooldown = 0;
@@ -334,6 +345,9 @@ class Monster final : public Creature
 			return mType->info.conditionImmunities;
 		}
 		void getPathSearchParams(const Creature* creature, FindPathParams& fpp) const override;
+		bool hasAsyncPathfinding() const override {
+			return mType->info.asyncPathfinding;
+		}
 		bool useCacheMap() const override {
 			return !randomStepping;
 		}
@@ -945,6 +945,8 @@ MonsterType* Monsters::loadMonster(const std::string& file, const std::string& m
 				mType->info.canWalkOnFire = attr.as_bool();
 			} else if (caseInsensitiveEqual(attrName, "canwalkonpoison")) {
 				mType->info.canWalkOnPoison = attr.as_bool();
+			} else if (caseInsensitiveEqual(attrName, "asyncpathfinding")) {
+				mType->info.asyncPathfinding = attr.as_bool();
 			} else {
 				console::reportWarning(location, "Unknown flag attribute \"" + std::string(attrName) + "\"! (" + file + ")");
 			}
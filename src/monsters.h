@@ -147,6 +147,7 @@ class MonsterType
 		bool canWalkOnEnergy = true;
 		bool canWalkOnFire = true;
 		bool canWalkOnPoison = true;
+		bool asyncPathfinding = false;
 
 		MonstersEvent_t eventType = MONSTERS_EVENT_NONE;
 	};
@@ -41,7 +41,8 @@ void MoveEvents::clearMap(MoveListMap& map, bool fromLua)
 
 void MoveEvents::clearPosMap(MovePosListMap& map, bool fromLua)
 {
-	for (auto it = map.begin(); it != map.end(); ++it) {
+	for (auto it = map.begin(); it != map.end(); ) {
+		bool empty = true;
 		for (int eventType = MOVE_EVENT_STEP_IN; eventType < MOVE_EVENT_LAST; ++eventType) {
 			auto& moveEvents = it->second.moveEvent[eventType];
 			for (auto find = moveEvents.begin(); find != moveEvents.end(); ) {
@@ -51,20 +52,80 @@ void MoveEvents::clearPosMap(MovePosListMap& map, bool fromLua)
 					++find;
 				}
 			}
+			empty = empty && moveEvents.empty();
+		}
+
+		if (empty) {
+			it = map.erase(it);
+		} else {
+			++it;
 		}
 	}
 }
 
 void MoveEvents::clear(bool fromLua)
 {
+	// positions left without events are erased, their tiles lose the flag too
+	std::vector<Position> positions;
+	positions.reserve(positionMap.size());
+	for (const auto& it : positionMap) {
+		positions.push_back(it.first);
+	}
+
 	clearMap(itemIdMap, fromLua);
 	clearMap(actionIdMap, fromLua);
 	clearMap(uniqueIdMap, fromLua);
 	clearPosMap(positionMap, fromLua);
 
+	invalidateIndexes();
+	for (const Position& pos : positions) {
+		updateTileFlag(pos);
+	}
+
 	reInitState(fromLua);
 }
 
+void MoveEvents::invalidateIndexes()
+{
+	uniqueIdIndex.invalidate();
+	actionIdIndex.invalidate();
+	itemIdIndex.invalidate();
+}
+
+void MoveEvents::buildIndexes()
+{
+	auto get = [](MoveEventList& moveEventList) { return &moveEventList; };
+	uniqueIdIndex.build(uniqueIdMap, get);
+	actionIdIndex.build(actionIdMap, get);
+	itemIdIndex.build(itemIdMap, get);
+}
+
+void MoveEvents::updateTileFlag(const Position& pos)
+{
+	Tile* tile = g_game.map.getTile(pos);
+	if (!tile) {
+		// set by Map::setTile once the tile is created
+		return;
+	}
+
+	if (hasPositionEvent(pos)) {
+		tile->setFlag(TILESTATE_MOVEEVENT);
+	} else {
+		tile->resetFlag(TILESTATE_MOVEEVENT);
+	}
+}
+
+bool MoveEvents::hasPositionEvent(const Position& pos) const
+{
+	auto it = positionMap.find(pos);
+	if (it == positionMap.end()) {
+		return false;
+	}
+
+	auto hasEvents = [](const std::list<MoveEvent>& moveEvents) { return !moveEvents.empty(); };
+	return std::any_of(std::begin(it->second.moveEvent), std::end(it->second.moveEvent), hasEvents);
+}
+
 LuaScriptInterface& MoveEvents::getScriptInterface()
 {
 	return scriptInterface;
@@ -318,6 +379,8 @@ bool MoveEvents::registerLuaEvent(MoveEvent* event)
 
 void MoveEvents::addEvent(MoveEvent moveEvent, int32_t id, MoveListMap& map)
 {
+	invalidateIndexes();
+
 	auto it = map.find(id);
 	if (it == map.end()) {
 		MoveEventList moveEventList;
@@ -351,9 +414,12 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType, slots_t slot)
 		default: slotp = 0; break;
 	}
 
-	auto it = itemIdMap.find(item->getID());
-	if (it != itemIdMap.end()) {
-		std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
+	if (itemIdIndex.isStale()) {
+		buildIndexes();
+	}
+
+	if (MoveEventList* moveEvents = itemIdIndex.find(item->getID())) {
+		std::list<MoveEvent>& moveEventList = moveEvents->moveEvent[eventType];
 		for (MoveEvent& moveEvent : moveEventList) {
 			if ((moveEvent.getSlot() & slotp) != 0) {
 				return &moveEvent;
@@ -365,12 +431,13 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType, slots_t slot)
 
 MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType)
 {
-	MoveListMap::iterator it;
+	if (itemIdIndex.isStale()) {
+		buildIndexes();
+	}
 
 	if (item->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID)) {
-		it = uniqueIdMap.find(item->getUniqueId());
-		if (it != uniqueIdMap.end()) {
-			std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
+		if (MoveEventList* moveEvents = uniqueIdIndex.find(item->getUniqueId())) {
+			std::list<MoveEvent>& moveEventList = moveEvents->moveEvent[eventType];
 			if (!moveEventList.empty()) {
 				return &(*moveEventList.begin());
 			}
@@ -378,18 +445,16 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType)
 	}
 
 	if (item->hasAttribute(ITEM_ATTRIBUTE_ACTIONID)) {
-		it = actionIdMap.find(item->getActionId());
-		if (it != actionIdMap.end()) {
-			std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
+		if (MoveEventList* moveEvents = actionIdIndex.find(item->getActionId())) {
+			std::list<MoveEvent>& moveEventList = moveEvents->moveEvent[eventType];
 			if (!moveEventList.empty()) {
 				return &(*moveEventList.begin());
 			}
 		}
 	}
 
-	it = itemIdMap.find(item->getID());
-	if (it != itemIdMap.end()) {
-		std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
+	if (MoveEventList* moveEvents = itemIdIndex.find(item->getID())) {
+		std::list<MoveEvent>& moveEventList = moveEvents->moveEvent[eventType];
 		if (!moveEventList.empty()) {
 			return &(*moveEventList.begin());
 		}
@@ -414,10 +479,17 @@ void MoveEvents::addEvent(MoveEvent moveEvent, const Position& pos, MovePosListM
 
 		moveEventList.push_back(std::move(moveEvent));
 	}
+
+	updateTileFlag(pos);
 }
 
 MoveEvent* MoveEvents::getEvent(const Tile* tile, MoveEvent_t eventType)
 {
+	// most tiles have no event of their own
+	if (!tile->hasFlag(TILESTATE_MOVEEVENT)) {
+		return nullptr;
+	}
+
 	auto it = positionMap.find(tile->getPosition());
 	if (it != positionMap.end()) {
 		std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
@@ -1025,7 +1097,7 @@ bool MoveEvent::executeEquip(Player* player, Item* item, slots_t slot, bool isCh
 
 	scriptInterface->pushFunction(scriptId);
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 	LuaScriptInterface::pushThing(L, item);
 	lua_pushnumber(L, slot);
 	LuaScriptInterface::pushBoolean(L, isCheck);
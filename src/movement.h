@@ -6,6 +6,7 @@
 
 #include "baseevents.h"
 #include "creature.h"
+#include "idlookup.h"
 #include "luascript.h"
 #include "vocation.h"
 
@@ -51,6 +52,7 @@ class MoveEvents final : public BaseEvents
 		uint32_t onItemMove(Item* item, Tile* tile, bool isAdd);
 
 		MoveEvent* getEvent(Item* item, MoveEvent_t eventType);
+		bool hasPositionEvent(const Position& pos) const;
 
 		bool registerLuaEvent(MoveEvent* event);
 		bool registerLuaFunction(MoveEvent* event);
@@ -79,6 +81,14 @@ class MoveEvents final : public BaseEvents
 		MoveListMap itemIdMap;
 		MovePosListMap positionMap;
 
+		// rebuilt from the maps above on the first use after they changed
+		IdLookupTable<MoveEventList> uniqueIdIndex;
+		IdLookupTable<MoveEventList> actionIdIndex;
+		IdLookupTable<MoveEventList> itemIdIndex{true};
+		void invalidateIndexes();
+		void buildIndexes();
+		void updateTileFlag(const Position& pos);
+
 		LuaScriptInterface scriptInterface;
 };
 
@@ -14,6 +14,7 @@ extern LuaEnvironment g_luaEnvironment;
 
 uint32_t Npc::npcAutoID = 0x20000000;
 NpcScriptInterface* Npc::scriptInterface = nullptr;
+std::map<std::string, NpcScriptStats> Npcs::scriptStats;
 
 void Npcs::reload()
 {
@@ -30,6 +31,34 @@ void Npcs::reload()
 	}
 }
 
+NpcScriptStats& Npcs::getScriptStats(const std::string& file)
+{
+	return scriptStats[file];
+}
+
+void Npcs::printScriptStats()
+{
+	std::vector<std::pair<const std::string*, const NpcScriptStats*>> sorted;
+	sorted.reserve(scriptStats.size());
+	for (const auto& it : scriptStats) {
+		if (it.second.calls != 0) {
+			sorted.emplace_back(&it.first, &it.second);
+		}
+	}
+
+	if (sorted.empty()) {
+		return;
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) { return lhs.second->time > rhs.second->time; });
+	sorted.resize(std::min<size_t>(sorted.size(), 10));
+
+	console::print(CONSOLEMESSAGE_TYPE_INFO, "NPC scripts by CPU time:");
+	for (const auto& it : sorted) {
+		console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("  {:s}: {:d} ms in {:d} calls.", *it.first, it.second->time.count() / 1000, it.second->calls));
+	}
+}
+
 Npc* Npc::createNpc(const std::string& name)
 {
 	std::unique_ptr<Npc> npc(new Npc(name));
@@ -90,6 +119,8 @@ void Npc::reset()
 	floorChange = false;
 	attackable = false;
 	ignoreHeight = false;
+	asyncPathfinding = false;
+	alwaysThink = false;
 	focusCreature = 0;
 	speechBubble = SPEECHBUBBLE_NONE;
 
@@ -167,6 +198,14 @@ bool Npc::loadFromXml()
 		ignoreHeight = attr.as_bool();
 	}
 
+	if ((attr = npcNode.attribute("asyncpathfinding"))) {
+		asyncPathfinding = attr.as_bool();
+	}
+
+	if ((attr = npcNode.attribute("alwaysthink"))) {
+		alwaysThink = attr.as_bool();
+	}
+
 	if ((attr = npcNode.attribute("speechbubble"))) {
 		speechBubble = pugi::cast<uint32_t>(attr.value());
 	}
@@ -351,7 +390,16 @@ void Npc::onThink(uint32_t interval)
 		npcEventHandler->onThink();
 	}
 
-	if (!isIdle && getTimeSinceLastMove() >= walkTicks) {
+	if (isIdle) {
+		// the think above let the script notice that its players left,
+		// sleep until setIdle(false) wakes us up again
+		if (!alwaysThink) {
+			g_game.sleepCreature(this);
+		}
+		return;
+	}
+
+	if (getTimeSinceLastMove() >= walkTicks) {
 		addEventWalk();
 	}
 }
@@ -432,6 +480,8 @@ void Npc::setIdle(const bool idle)
 
 	if (isIdle) {
 		onIdleStatus();
+	} else {
+		g_game.addCreatureCheck(this);
 	}
 }
 
@@ -1113,7 +1163,7 @@ int NpcScriptInterface::luaNpcCloseShopWindow(lua_State* L)
 }
 
 NpcEventsHandler::NpcEventsHandler(const std::string& file, Npc* npc) :
-	npc(npc), scriptInterface(npc->getScriptInterface())
+	npc(npc), scriptInterface(npc->getScriptInterface()), stats(Npcs::getScriptStats(file))
 {
 	loaded = scriptInterface->loadFile("data/npc/scripts/" + file, npc) == 0;
 	if (!loaded) {
@@ -1134,6 +1184,14 @@ bool NpcEventsHandler::isLoaded() const
 	return loaded;
 }
 
+void NpcEventsHandler::callFunction(int params)
+{
+	auto start = std::chrono::steady_clock::now();
+	scriptInterface->callFunction(params);
+	stats.time += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	++stats.calls;
+}
+
 void NpcEventsHandler::onCreatureAppear(Creature* creature)
 {
 	if (creatureAppearEvent == -1) {
@@ -1154,7 +1212,7 @@ void NpcEventsHandler::onCreatureAppear(Creature* creature)
 	scriptInterface->pushFunction(creatureAppearEvent);
 	LuaScriptInterface::pushUserdata<Creature>(L, creature);
 	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
-	scriptInterface->callFunction(1);
+	callFunction(1);
 }
 
 void NpcEventsHandler::onCreatureDisappear(Creature* creature)
@@ -1177,7 +1235,7 @@ void NpcEventsHandler::onCreatureDisappear(Creature* creature)
 	scriptInterface->pushFunction(creatureDisappearEvent);
 	LuaScriptInterface::pushUserdata<Creature>(L, creature);
 	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
-	scriptInterface->callFunction(1);
+	callFunction(1);
 }
 
 void NpcEventsHandler::onCreatureMove(Creature* creature, const Position& oldPos, const Position& newPos)
@@ -1202,7 +1260,7 @@ void NpcEventsHandler::onCreatureMove(Creature* creature, const Position& oldPos
 	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
 	LuaScriptInterface::pushPosition(L, oldPos);
 	LuaScriptInterface::pushPosition(L, newPos);
-	scriptInterface->callFunction(3);
+	callFunction(3);
 }
 
 void NpcEventsHandler::onCreatureSay(Creature* creature, MessageClasses type, const std::string& text)
@@ -1227,7 +1285,7 @@ void NpcEventsHandler::onCreatureSay(Creature* creature, MessageClasses type, co
 	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
 	lua_pushnumber(L, type);
 	LuaScriptInterface::pushString(L, text);
-	scriptInterface->callFunction(3);
+	callFunction(3);
 }
 
 void NpcEventsHandler::onPlayerTrade(Player* player, int32_t callback, uint16_t itemId,
@@ -1250,13 +1308,13 @@ void NpcEventsHandler::onPlayerTrade(Player* player, int32_t callback, uint16_t
 	lua_State* L = scriptInterface->getLuaState();
 	LuaScriptInterface::pushCallback(L, callback);
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 	lua_pushnumber(L, itemId);
 	lua_pushnumber(L, subType);
 	lua_pushnumber(L, amount);
 	LuaScriptInterface::pushBoolean(L, ignore);
 	LuaScriptInterface::pushBoolean(L, inBackpacks);
-	scriptInterface->callFunction(6);
+	callFunction(6);
 }
 
 void NpcEventsHandler::onPlayerCloseChannel(Player* player)
@@ -1278,8 +1336,8 @@ void NpcEventsHandler::onPlayerCloseChannel(Player* player)
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(playerCloseChannelEvent);
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
-	scriptInterface->callFunction(1);
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
+	callFunction(1);
 }
 
 void NpcEventsHandler::onPlayerEndTrade(Player* player)
@@ -1301,8 +1359,8 @@ void NpcEventsHandler::onPlayerEndTrade(Player* player)
 	lua_State* L = scriptInterface->getLuaState();
 	scriptInterface->pushFunction(playerEndTradeEvent);
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
-	scriptInterface->callFunction(1);
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
+	callFunction(1);
 }
 
 void NpcEventsHandler::onThink()
@@ -1322,5 +1380,5 @@ void NpcEventsHandler::onThink()
 	env->setNpc(npc);
 
 	scriptInterface->pushFunction(thinkEvent);
-	scriptInterface->callFunction(0);
+	callFunction(0);
 }
@@ -10,10 +10,22 @@
 class Npc;
 class Player;
 
+struct NpcScriptStats {
+	uint64_t calls = 0;
+	std::chrono::microseconds time{0};
+};
+
 class Npcs
 {
 	public:
 		static void reload();
+
+		// callbacks of all npcs sharing a script file add up in one entry
+		static NpcScriptStats& getScriptStats(const std::string& file);
+		static void printScriptStats();
+
+	private:
+		static std::map<std::string, NpcScriptStats> scriptStats;
 };
 
 class NpcScriptInterface final : public LuaScriptInterface
@@ -70,8 +82,11 @@ class NpcEventsHandler
 		bool isLoaded() const;
 
 	private:
+		void callFunction(int params);
+
 		Npc* npc;
 		NpcScriptInterface* scriptInterface;
+		NpcScriptStats& stats;
 
 		int32_t creatureAppearEvent = -1;
 		int32_t creatureDisappearEvent = -1;
@@ -189,6 +204,9 @@ class Npc final : public Creature
 		bool isAttackable() const override {
 			return attackable;
 		}
+		bool hasAsyncPathfinding() const override {
+			return asyncPathfinding;
+		}
 		bool getNextStep(Direction& dir, uint32_t& flags) override;
 
 		void setIdle(const bool idle);
@@ -224,6 +242,8 @@ class Npc final : public Creature
 		bool floorChange;
 		bool attackable;
 		bool ignoreHeight;
+		bool asyncPathfinding;
+		bool alwaysThink;
 		bool loaded;
 		bool isIdle;
 		bool pushable;
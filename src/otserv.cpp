@@ -7,7 +7,12 @@
 #include "databasemanager.h"
 #include "databasetasks.h"
 #include "game.h"
+#include "iologindata.h"
 #include "iomarket.h"
+#include "journal.h"
+#include "luacache.h"
+#include "luacollector.h"
+#include "luaprofiler.h"
 #include "monsters.h"
 #include "outfit.h"
 #include "protocollogin.h"
@@ -17,7 +22,9 @@
 #include "scheduler.h"
 #include "script.h"
 #include "scriptmanager.h"
+#include "scriptshards.h"
 #include "server.h"
+#include "workerpool.h"
 
 #include <fstream>
 #include <iomanip>
@@ -27,14 +34,20 @@
 #endif
 
 DatabaseTasks g_databaseTasks;
+Journal g_journal;
 Dispatcher g_dispatcher;
 Scheduler g_scheduler;
+WorkerPool g_workerPool;
 
 Game g_game;
 ConfigManager g_config;
 Monsters g_monsters;
 Vocations g_vocations;
 extern Scripts* g_scripts;
+extern LuaBytecodeCache g_luaBytecodeCache;
+extern LuaGarbageCollector g_luaGarbageCollector;
+extern ScriptShards g_scriptShards;
+extern LuaProfiler g_luaProfiler;
 RSA g_RSA;
 
 std::mutex g_loaderLock;
@@ -91,11 +104,13 @@ int main(int argc, char* argv[])
 	} else {
 		console::print(CONSOLEMESSAGE_TYPE_ERROR, "No services running. The server is NOT online!");
 		g_scheduler.shutdown();
+		g_journal.shutdown();
 		g_databaseTasks.shutdown();
 		g_dispatcher.shutdown();
 	}
 
 	g_scheduler.join();
+	g_journal.join();
 	g_databaseTasks.join();
 	g_dispatcher.join();
 	return 0;
@@ -255,10 +270,22 @@ void mainLoader(int, char*[], ServiceManager* services)
 	// start database tasks
 	g_databaseTasks.start();
 
+	// start helper threads for the parallel monster decisions
+	g_workerPool.start(std::max<int32_t>(0, g_config.getNumber(ConfigManager::WORKER_THREADS)));
+
+	g_luaProfiler.configure();
+	g_luaGarbageCollector.configure();
+
 	// run database migrations if necessary
 	// Checking database migrations...
 	DatabaseManager::updateDatabase();
 
+	// replay the write-ahead journal before anything is loaded from the database
+	if (!g_journal.open()) {
+		startupErrorMessage("Failed to open the journal file!");
+		return;
+	}
+
 	// load autonumering for loot containers
 	g_game.loadLatestLootContainerId();
 
@@ -320,11 +347,16 @@ void mainLoader(int, char*[], ServiceManager* services)
 	console::printResultText(LUA_RELEASE);
 #endif
 
+	// compile what changed since the last start on the worker threads
+	g_luaBytecodeCache.configure();
+	g_luaBytecodeCache.precompile("data");
+
 	if (!ScriptingManager::getInstance().loadScriptSystems()) {
 		startupErrorMessage("Failed to load script systems");
 		return;
 	}
 
+	auto scriptsStart = std::chrono::steady_clock::now();
 	if (!g_scripts->loadScripts("scripts", false, false)) {
 		startupErrorMessage("Failed to load lua scripts");
 		return;
@@ -332,6 +364,7 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	// load monsters
 	//console::print(CONSOLEMESSAGE_TYPE_STARTUP, "Loading monsters ... ");
+	auto monstersStart = std::chrono::steady_clock::now();
 	if (!g_monsters.loadFromXml()) {
 		startupErrorMessage("Unable to load monsters!");
 		return;
@@ -342,6 +375,15 @@ void mainLoader(int, char*[], ServiceManager* services)
 		return;
 	}
 
+	auto monstersEnd = std::chrono::steady_clock::now();
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Scripts loaded in {:d} ms, monsters in {:d} ms.", std::chrono::duration_cast<std::chrono::milliseconds>(monstersStart - scriptsStart).count(), std::chrono::duration_cast<std::chrono::milliseconds>(monstersEnd - monstersStart).count()));
+	g_luaBytecodeCache.printStats();
+
+	if (!g_scriptShards.start()) {
+		startupErrorMessage("Failed to load shard scripts");
+		return;
+	}
+
 	// load world type
 	console::print(CONSOLEMESSAGE_TYPE_STARTUP, "Configuring world type ... ", false);
 	std::string worldType = asLowerCaseString(g_config.getString(ConfigManager::WORLD_TYPE));
@@ -380,6 +422,11 @@ void mainLoader(int, char*[], ServiceManager* services)
 	console::printWorldInfo("NPCs", std::to_string(g_game.map.spawns.getNpcCount()));
 	console::printWorldInfo("Spawns", std::to_string(g_game.map.spawns.size()));
 
+	if (!IOLoginData::convertItemStorage()) {
+		startupErrorMessage("Failed to convert player item storage");
+		return;
+	}
+
 	// bind service ports
 	g_game.setGameState(GAME_STATE_INIT);
 
@@ -420,6 +467,7 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	g_game.map.houses.payHouses(rentPeriod);
 
+	IOMarket::getInstance().loadOffers();
 	IOMarket::checkExpiredOffers();
 	IOMarket::getInstance().updateStatistics();
 
@@ -2377,33 +2377,35 @@ void Player::death(Creature* lastHitCreature)
 			mana = manaMax;
 		}
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
+		size_t i = 0;
+		while (i < conditions.size()) {
+			Condition* condition = conditions[i];
 			if (condition->isPersistent()) {
-				it = conditions.erase(it);
+				conditions.erase(conditions.begin() + i);
+				updateConditionTypes();
 
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
 			} else {
-				++it;
+				++i;
 			}
 		}
 	} else {
 		setSkillLoss(true);
 
-		auto it = conditions.begin(), end = conditions.end();
-		while (it != end) {
-			Condition* condition = *it;
+		size_t i = 0;
+		while (i < conditions.size()) {
+			Condition* condition = conditions[i];
 			if (condition->isPersistent()) {
-				it = conditions.erase(it);
+				conditions.erase(conditions.begin() + i);
+				updateConditionTypes();
 
 				condition->endCondition(this);
 				onEndCondition(condition->getType());
 				delete condition;
 			} else {
-				++it;
+				++i;
 			}
 		}
 
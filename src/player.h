@@ -1076,6 +1076,11 @@ class Player final : public Creature, public Cylinder
 				client->sendMagicEffect(pos, type);
 			}
 		}
+		void sendCombatBatch(const CombatBatch& batch) const {
+			if (client) {
+				client->sendCombatBatch(batch);
+			}
+		}
 		void sendPing();
 		void sendPingBack() const {
 			if (client) {
@@ -9,6 +9,7 @@
 #include "ban.h"
 #include "condition.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "depotchest.h"
 #include "events.h"
 #include "game.h"
@@ -35,6 +36,8 @@ namespace {
 std::deque<std::pair<int64_t, uint32_t>> waitList; // (timeout, player guid)
 auto priorityEnd = waitList.end();
 
+std::unordered_set<uint32_t> pendingLogins; // player guids being loaded by the database thread
+
 auto findClient(uint32_t guid) {
 	std::size_t slot = 1;
 	for (auto it = waitList.begin(), end = waitList.end(); it != end; ++it, ++slot) {
@@ -192,36 +195,23 @@ void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingS
 			return;
 		}
 
-		if (!IOLoginData::loadPlayerById(player, player->getGUID())) {
-			disconnectClient("Your character could not be loaded.");
+		uint32_t guid = player->getGUID();
+		if (!pendingLogins.insert(guid).second) {
+			disconnectClient("You are already logged in.");
 			return;
 		}
 
-		player->setOperatingSystem(operatingSystem);
-
-		if (!g_game.placeCreature(player, player->getLoginPosition())) {
-			if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
-				disconnectClient("Temple position is wrong. Contact the administrator.");
-				return;
+		// the queries run on the database thread, the player is assembled and
+		// placed once the results are handed back to the dispatcher
+		g_databaseTasks.addJob([=, thisPtr = getThis()](Database& db) {
+			auto data = std::make_shared<PlayerLoadData>();
+			if (!IOLoginData::loadPlayerDataById(db, *data, guid)) {
+				data.reset();
 			}
-		}
-
-		if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
-			player->registerCreatureEvent("ExtendedOpcode");
-		}
-
-		// initialize account currencies
-		addGameTask([=, playerGUID = player->getGUID()]() { g_game.playerRegisterCurrencies(playerGUID); });
 
-		player->lastIP = player->getIP();
-		player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
-		acceptPackets = true;
-
-		lastName = name;
-		lastAccountId = accountId;
-		lastOperatingSystem = operatingSystem;
-
-		addGameTask([=, playerID = player->getID()]() { g_game.playerConnect(playerID, isLogin); });
+			g_dispatcher.addTask(createTask([=]() { thisPtr->finishLogin(guid, name, accountId, operatingSystem, data); }));
+		});
+		return;
 	} else {
 		if (eventConnect != 0 || !g_config.getBoolean(ConfigManager::REPLACE_KICK_ON_LOGIN)) {
 			//Already trying to connect
@@ -250,6 +240,61 @@ void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingS
 	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
 }
 
+void ProtocolGame::finishLogin(uint32_t guid, const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem, std::shared_ptr<const PlayerLoadData> data)
+{
+	//dispatcher thread
+	pendingLogins.erase(guid);
+
+	if (!player || isConnectionExpired()) {
+		// the client went away while its character was being loaded
+		return;
+	}
+
+	if (!data || !IOLoginData::loadPlayer(player, *data)) {
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
+
+	// the world kept running while the character was loading
+	if (!g_config.getBoolean(ConfigManager::ALLOW_CLONES) && g_game.getPlayerByName(name)) {
+		disconnectClient("You are already logged in.");
+		return;
+	}
+
+	if (g_config.getBoolean(ConfigManager::ONE_PLAYER_ON_ACCOUNT) && player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && g_game.getPlayerByAccount(player->getAccount())) {
+		disconnectClient("You may only login with one character\nof your account at the same time.");
+		return;
+	}
+
+	player->setOperatingSystem(operatingSystem);
+
+	if (!g_game.placeCreature(player, player->getLoginPosition())) {
+		if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
+			disconnectClient("Temple position is wrong. Contact the administrator.");
+			return;
+		}
+	}
+
+	if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
+		player->registerCreatureEvent("ExtendedOpcode");
+	}
+
+	// initialize account currencies
+	addGameTask([=, playerGUID = player->getGUID()]() { g_game.playerRegisterCurrencies(playerGUID); });
+
+	player->lastIP = player->getIP();
+	player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
+	acceptPackets = true;
+
+	lastName = name;
+	lastAccountId = accountId;
+	lastOperatingSystem = operatingSystem;
+
+	addGameTask([=, playerID = player->getID()]() { g_game.playerConnect(playerID, true); });
+
+	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
+}
+
 
 void ProtocolGame::sendRelogCancel(const std::string& msg, bool isRelog)
 {
@@ -2118,42 +2163,7 @@ void ProtocolGame::sendBasicData()
 void ProtocolGame::sendTextMessage(const TextMessage& message)
 {
 	NetworkMessage msg;
-	msg.addByte(0xB4);
-	msg.addByte(message.type);
-	switch (message.type) {
-		case MESSAGE_DAMAGE_DEALT:
-		case MESSAGE_DAMAGE_RECEIVED:
-		case MESSAGE_DAMAGE_OTHERS: {
-			msg.addPosition(message.position);
-			msg.add<uint32_t>(message.primary.value);
-			msg.addByte(message.primary.color);
-			msg.add<uint32_t>(message.secondary.value);
-			msg.addByte(message.secondary.color);
-			break;
-		}
-		case MESSAGE_HEALED:
-		case MESSAGE_HEALED_OTHERS:
-		case MESSAGE_EXPERIENCE:
-		case MESSAGE_EXPERIENCE_OTHERS:
-		case MESSAGE_MANA:
-		case MESSAGE_MANA2:
-		{
-			msg.addPosition(message.position);
-			msg.add<uint32_t>(message.primary.value);
-			msg.addByte(message.primary.color);
-			break;
-		}
-		case MESSAGE_CHANNEL_MANAGEMENT:
-		case MESSAGE_GUILD:
-		case MESSAGE_PARTY_MANAGEMENT:
-		case MESSAGE_PARTY:
-			msg.add<uint16_t>(message.channelId);
-			break;
-		default: {
-			break;
-		}
-	}
-	msg.addString(message.text);
+	AddTextMessage(msg, message);
 	writeToOutputBuffer(msg);
 }
 
@@ -3013,26 +3023,58 @@ void ProtocolGame::sendMagicEffect(const Position& pos, uint8_t type)
 	}
 
 	NetworkMessage msg;
-	msg.addByte(0x83);
-	msg.addPosition(pos);
-	msg.addByte(MAGIC_EFFECTS_CREATE_EFFECT);
-	msg.addByte(type);
-	msg.addByte(MAGIC_EFFECTS_END_LOOP);
+	AddMagicEffect(msg, pos, type);
 	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendCreatureHealth(const Creature* creature)
 {
 	NetworkMessage msg;
-	msg.addByte(0x8C);
-	msg.add<uint32_t>(creature->getID());
+	AddCreatureHealth(msg, creature);
+	writeToOutputBuffer(msg);
+}
 
-	if (creature->isHealthHidden()) {
-		msg.addByte(0x00);
-	} else {
-		msg.addByte(std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+void ProtocolGame::sendCombatBatch(const CombatBatch& batch)
+{
+	NetworkMessage msg;
+	uint32_t entries = 0;
+
+	// writes past the end of a message are dropped, entries that don't fit go out in the next one
+	auto reserve = [&](size_t size) {
+		if (msg.getLength() + size > NetworkMessage::MAX_PROTOCOL_BODY_LENGTH) {
+			g_game.addCombatBatchWrite(entries, msg.getLength());
+			writeToOutputBuffer(msg);
+			msg.reset();
+			entries = 0;
+		}
+		++entries;
+	};
+
+	for (const auto& magicEffect : batch.magicEffects) {
+		if (canSee(magicEffect.first)) {
+			reserve(9);
+			AddMagicEffect(msg, magicEffect.first, magicEffect.second);
+		}
+	}
+
+	for (const auto& textMessage : batch.textMessages) {
+		if (textMessage.first == player->getID()) {
+			reserve(19 + textMessage.second.text.size());
+			AddTextMessage(msg, textMessage.second);
+		}
+	}
+
+	for (const Creature* creature : batch.creatures) {
+		if (canSee(creature)) {
+			reserve(6);
+			AddCreatureHealth(msg, creature);
+		}
+	}
+
+	if (entries != 0) {
+		g_game.addCombatBatchWrite(entries, msg.getLength());
+		writeToOutputBuffer(msg);
 	}
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendFYIBox(const std::string& message)
@@ -4098,6 +4140,67 @@ void ProtocolGame::AddCreatureLight(NetworkMessage& msg, const Creature* creatur
 	msg.addByte(lightInfo.color);
 }
 
+void ProtocolGame::AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type)
+{
+	msg.addByte(0x83);
+	msg.addPosition(pos);
+	msg.addByte(MAGIC_EFFECTS_CREATE_EFFECT);
+	msg.addByte(type);
+	msg.addByte(MAGIC_EFFECTS_END_LOOP);
+}
+
+void ProtocolGame::AddCreatureHealth(NetworkMessage& msg, const Creature* creature)
+{
+	msg.addByte(0x8C);
+	msg.add<uint32_t>(creature->getID());
+
+	if (creature->isHealthHidden()) {
+		msg.addByte(0x00);
+	} else {
+		msg.addByte(std::ceil((static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+	}
+}
+
+void ProtocolGame::AddTextMessage(NetworkMessage& msg, const TextMessage& message)
+{
+	msg.addByte(0xB4);
+	msg.addByte(message.type);
+	switch (message.type) {
+		case MESSAGE_DAMAGE_DEALT:
+		case MESSAGE_DAMAGE_RECEIVED:
+		case MESSAGE_DAMAGE_OTHERS: {
+			msg.addPosition(message.position);
+			msg.add<uint32_t>(message.primary.value);
+			msg.addByte(message.primary.color);
+			msg.add<uint32_t>(message.secondary.value);
+			msg.addByte(message.secondary.color);
+			break;
+		}
+		case MESSAGE_HEALED:
+		case MESSAGE_HEALED_OTHERS:
+		case MESSAGE_EXPERIENCE:
+		case MESSAGE_EXPERIENCE_OTHERS:
+		case MESSAGE_MANA:
+		case MESSAGE_MANA2:
+		{
+			msg.addPosition(message.position);
+			msg.add<uint32_t>(message.primary.value);
+			msg.addByte(message.primary.color);
+			break;
+		}
+		case MESSAGE_CHANNEL_MANAGEMENT:
+		case MESSAGE_GUILD:
+		case MESSAGE_PARTY_MANAGEMENT:
+		case MESSAGE_PARTY:
+			msg.add<uint16_t>(message.channelId);
+			break;
+		default: {
+			break;
+		}
+	}
+	msg.addString(message.text);
+}
+
 //tile
 void ProtocolGame::RemoveTileThing(NetworkMessage& msg, const Position& pos, uint32_t stackpos)
 {
@@ -11,9 +11,11 @@
 #include "tasks.h"
 
 class Container;
+struct CombatBatch;
 class Game;
 class NetworkMessage;
 class Player;
+struct PlayerLoadData;
 class ProtocolGame;
 class Quest;
 class Tile;
@@ -73,6 +75,7 @@ class ProtocolGame final : public Protocol
 			return std::static_pointer_cast<ProtocolGame>(shared_from_this());
 		}
 		void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
+		void finishLogin(uint32_t guid, const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem, std::shared_ptr<const PlayerLoadData> data);
 		void disconnectClient(const std::string& message) const;
 		void writeToOutputBuffer(const NetworkMessage& msg);
 
@@ -204,6 +207,7 @@ class ProtocolGame final : public Protocol
 		void sendDistanceShoot(const Position& from, const Position& to, uint8_t type);
 		void sendMagicEffect(const Position& pos, uint8_t type);
 		void sendCreatureHealth(const Creature* creature);
+		void sendCombatBatch(const CombatBatch& batch);
 		void sendSkills();
 		void sendPing();
 		void sendPingBack();
@@ -329,6 +333,9 @@ class ProtocolGame final : public Protocol
 		void AddPlayerSkills(NetworkMessage& msg);
 		void AddWorldLight(NetworkMessage& msg, LightInfo lightInfo);
 		void AddCreatureLight(NetworkMessage& msg, const Creature* creature);
+		static void AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type);
+		static void AddCreatureHealth(NetworkMessage& msg, const Creature* creature);
+		static void AddTextMessage(NetworkMessage& msg, const TextMessage& message);
 
 		//tiles
 		static void RemoveTileThing(NetworkMessage& msg, const Position& pos, uint32_t stackpos);
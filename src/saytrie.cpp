@@ -0,0 +1,192 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "saytrie.h"
+#include "spells.h"
+#include "talkaction.h"
+
+extern Spells* g_spells;
+extern TalkActions* g_talkActions;
+
+namespace {
+
+char foldCase(char c)
+{
+	// the same folding caseInsensitiveStartsWith compares with
+	return static_cast<char>(tolower(c));
+}
+
+}
+
+const std::vector<SayTrie::TalkActionMatch>& SayTrie::getTalkActions(const std::string& text)
+{
+	walk(text);
+
+	talkActionEntries.clear();
+	for (uint32_t index : path) {
+		const Node& node = nodes[index];
+		talkActionEntries.insert(talkActionEntries.end(), node.talkActions.begin(), node.talkActions.end());
+	}
+
+	// words that differ in case are not ordered by length in the map
+	std::sort(talkActionEntries.begin(), talkActionEntries.end(), [](const TalkActionEntry& a, const TalkActionEntry& b) { return a.order < b.order; });
+
+	talkActionMatches.clear();
+	for (const TalkActionEntry& entry : talkActionEntries) {
+		talkActionMatches.push_back({entry.words, entry.talkAction});
+	}
+	return talkActionMatches;
+}
+
+InstantSpell* SayTrie::getInstantSpell(const std::string& text)
+{
+	walk(text);
+
+	for (auto it = path.rbegin(), end = path.rend(); it != end; ++it) {
+		if (InstantSpell* instantSpell = nodes[*it].instantSpell) {
+			return instantSpell;
+		}
+	}
+	return nullptr;
+}
+
+SayTrie::BenchmarkResult SayTrie::benchmark(uint32_t iterations)
+{
+	BenchmarkResult result;
+	if (!g_talkActions || !g_spells) {
+		return result;
+	}
+
+	std::vector<std::string> samples = {"hi", "trade", "yes", "hello, is anyone selling a magic plate armor?"};
+	for (const auto& it : g_talkActions->talkActions) {
+		samples.push_back(it.first);
+		samples.push_back(it.first + " param");
+	}
+	for (const auto& it : g_spells->instants) {
+		samples.push_back(it.first);
+		samples.push_back(it.first + " \"name\"");
+	}
+	result.samples = samples.size();
+
+	// what TalkActions::playerSaySpell and Spells::getInstantSpell used to do
+	auto scan = [](const std::string& text, size_t& talkActionCount) {
+		talkActionCount = 0;
+		for (const auto& it : g_talkActions->talkActions) {
+			if (caseInsensitiveStartsWith(text, it.first)) {
+				++talkActionCount;
+			}
+		}
+
+		InstantSpell* instantSpell = nullptr;
+		size_t length = 0;
+		for (auto& it : g_spells->instants) {
+			if (caseInsensitiveStartsWith(text, it.first) && (!instantSpell || it.first.size() > length)) {
+				instantSpell = &it.second;
+				length = it.first.size();
+			}
+		}
+		return instantSpell;
+	};
+
+	for (const std::string& sample : samples) {
+		size_t talkActionCount;
+		InstantSpell* instantSpell = scan(sample, talkActionCount);
+		if (instantSpell != getInstantSpell(sample) || talkActionCount != getTalkActions(sample).size()) {
+			++result.mismatches;
+		}
+	}
+
+	// both sides count what they found so neither loop can be optimized away
+	size_t scanFound = 0, trieFound = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		for (const std::string& sample : samples) {
+			size_t talkActionCount;
+			scanFound += (scan(sample, talkActionCount) != nullptr) + talkActionCount;
+		}
+	}
+	auto middle = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		for (const std::string& sample : samples) {
+			trieFound += (getInstantSpell(sample) != nullptr) + getTalkActions(sample).size();
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	result.scanTime = middle - start;
+	result.trieTime = end - middle;
+	if (scanFound != trieFound) {
+		++result.mismatches;
+	}
+	return result;
+}
+
+void SayTrie::build()
+{
+	nodes.assign(1, Node());
+	stale = false;
+
+	if (g_talkActions) {
+		size_t order = 0;
+		for (auto& it : g_talkActions->talkActions) {
+			uint32_t index = insert(it.first);
+			nodes[index].talkActions.push_back({order++, &it.first, &it.second});
+		}
+	}
+
+	if (g_spells) {
+		for (auto& it : g_spells->instants) {
+			uint32_t index = insert(it.first);
+			if (!nodes[index].instantSpell) {
+				nodes[index].instantSpell = &it.second;
+			}
+		}
+	}
+}
+
+uint32_t SayTrie::insert(const std::string& words)
+{
+	uint32_t index = 0;
+	for (char c : words) {
+		char folded = foldCase(c);
+
+		auto& children = nodes[index].children;
+		auto it = std::find_if(children.begin(), children.end(), [folded](const std::pair<char, uint32_t>& child) { return child.first == folded; });
+		if (it != children.end()) {
+			index = it->second;
+			continue;
+		}
+
+		uint32_t child = nodes.size();
+		nodes[index].children.emplace_back(folded, child);
+		nodes.emplace_back();
+		index = child;
+	}
+	return index;
+}
+
+void SayTrie::walk(const std::string& text)
+{
+	if (stale) {
+		build();
+	}
+
+	path.clear();
+	path.push_back(0);
+
+	uint32_t index = 0;
+	for (char c : text) {
+		char folded = foldCase(c);
+
+		const auto& children = nodes[index].children;
+		auto it = std::find_if(children.begin(), children.end(), [folded](const std::pair<char, uint32_t>& child) { return child.first == folded; });
+		if (it == children.end()) {
+			break;
+		}
+
+		index = it->second;
+		path.push_back(index);
+	}
+}
@@ -0,0 +1,66 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_SAYTRIE_H
+#define FS_SAYTRIE_H
+
+class InstantSpell;
+class TalkAction;
+
+// case-folded prefix trie over the words of all talkactions and instant spells
+class SayTrie
+{
+	public:
+		struct TalkActionMatch {
+			const std::string* words;
+			TalkAction* talkAction;
+		};
+
+		struct BenchmarkResult {
+			size_t samples = 0;
+			uint32_t mismatches = 0;
+			std::chrono::nanoseconds scanTime{0};
+			std::chrono::nanoseconds trieTime{0};
+		};
+
+		void invalidate() {
+			stale = true;
+		}
+
+		// talkactions whose words start the text, in the order TalkActions used to try them
+		const std::vector<TalkActionMatch>& getTalkActions(const std::string& text);
+		// the instant spell with the longest words starting the text
+		InstantSpell* getInstantSpell(const std::string& text);
+
+		// times the lookups against the linear scans they replace with the loaded words
+		BenchmarkResult benchmark(uint32_t iterations);
+
+	private:
+		struct TalkActionEntry {
+			size_t order;
+			const std::string* words;
+			TalkAction* talkAction;
+		};
+
+		struct Node {
+			std::vector<std::pair<char, uint32_t>> children;
+			std::vector<TalkActionEntry> talkActions;
+			// same words in different case, the first one wins like in the map
+			InstantSpell* instantSpell = nullptr;
+		};
+
+		void build();
+		uint32_t insert(const std::string& words);
+		// the nodes along the text, the root first
+		void walk(const std::string& text);
+
+		std::vector<Node> nodes;
+		std::vector<uint32_t> path;
+		std::vector<TalkActionEntry> talkActionEntries;
+		std::vector<TalkActionMatch> talkActionMatches;
+		bool stale = true;
+};
+
+extern SayTrie g_sayTrie;
+
+#endif // FS_SAYTRIE_H
@@ -10,6 +10,7 @@
 #include "events.h"
 #include "globalevent.h"
 #include "movement.h"
+#include "saytrie.h"
 #include "script.h"
 #include "spells.h"
 #include "talkaction.h"
@@ -25,6 +26,7 @@ TalkActions* g_talkActions = nullptr;
 MoveEvents* g_moveEvents = nullptr;
 Weapons* g_weapons = nullptr;
 Scripts* g_scripts = nullptr;
+SayTrie g_sayTrie;
 
 extern LuaEnvironment g_luaEnvironment;
 
@@ -45,15 +47,27 @@ ScriptingManager::~ScriptingManager()
 bool ScriptingManager::loadScriptSystems()
 {
 	std::string location = "ScriptingManager::loadScriptSystems";
+
+	// time spent per subsystem, printed once all of them loaded
+	std::vector<std::pair<const char*, int64_t>> timings;
+	auto last = std::chrono::steady_clock::now();
+	auto loaded = [&timings, &last](const char* name) {
+		auto now = std::chrono::steady_clock::now();
+		timings.emplace_back(name, std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count());
+		last = now;
+	};
+
 	if (g_luaEnvironment.loadFile("data/global.lua") == -1) {
 		console::reportFileError(location, "data/global.lua");
 	}
+	loaded("global.lua");
 
 	g_scripts = new Scripts();
 	if (!g_scripts->loadScripts("scripts/lib", true, false)) {
 		console::reportFileError(location, "lua libs");
 		return false;
 	}
+	loaded("libs");
 
 	g_chat = new Chat();
 
@@ -64,48 +78,61 @@ bool ScriptingManager::loadScriptSystems()
 	}
 
 	g_weapons->loadDefaults();
+	loaded("weapons");
 
 	g_spells = new Spells();
 	if (!g_spells->loadFromXml()) {
 		console::reportFileError(location, "spells");
 		return false;
 	}
+	loaded("spells");
 
 	g_actions = new Actions();
 	if (!g_actions->loadFromXml()) {
 		console::reportFileError(location, "actions");
 		return false;
 	}
+	loaded("actions");
 
 	g_talkActions = new TalkActions();
 	if (!g_talkActions->loadFromXml()) {
 		console::reportFileError(location, "talkactions");
 		return false;
 	}
+	loaded("talkactions");
 
 	g_moveEvents = new MoveEvents();
 	if (!g_moveEvents->loadFromXml()) {
 		console::reportFileError(location, "moveevents");
 		return false;
 	}
+	loaded("moveevents");
 
 	g_creatureEvents = new CreatureEvents();
 	if (!g_creatureEvents->loadFromXml()) {
 		console::reportFileError(location, "creatureevents");
 		return false;
 	}
+	loaded("creatureevents");
 
 	g_globalEvents = new GlobalEvents();
 	if (!g_globalEvents->loadFromXml()) {
 		console::reportFileError(location, "globalevents");
 		return false;
 	}
+	loaded("globalevents");
 
 	g_events = new Events();
 	if (!g_events->load()) {
 		console::reportFileError(location, "events");
 		return false;
 	}
+	loaded("events");
 
+	std::string summary;
+	for (const auto& timing : timings) {
+		summary += fmt::format("{:s}{:s} {:d} ms", summary.empty() ? "" : ", ", timing.first, timing.second);
+	}
+	console::print(CONSOLEMESSAGE_TYPE_INFO, "Script systems loaded: " + summary + '.');
 	return true;
 }
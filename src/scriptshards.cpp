@@ -0,0 +1,468 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "scriptshards.h"
+#include "configmanager.h"
+#include "luacache.h"
+#include "luascript.h"
+#include "tasks.h"
+#include "workerpool.h"
+
+#include <filesystem>
+
+extern ConfigManager g_config;
+extern LuaEnvironment g_luaEnvironment;
+extern LuaBytecodeCache g_luaBytecodeCache;
+extern ScriptShards g_scriptShards;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto SHARD_SCRIPTS_PATH = "data/shards";
+
+// tables nested deeper than this are most likely cyclic
+constexpr int MAX_VALUE_DEPTH = 32;
+
+// a long queue doesn't keep its worker from the other shards
+constexpr int JOBS_PER_DRAIN = 64;
+
+}
+
+bool ScriptValue::read(lua_State* L, int arg, std::string& error, int depth /* = 0*/)
+{
+	switch (lua_type(L, arg)) {
+		case LUA_TNONE:
+		case LUA_TNIL:
+			type = NIL;
+			return true;
+
+		case LUA_TBOOLEAN:
+			type = BOOLEAN;
+			boolean = lua_toboolean(L, arg) != 0;
+			return true;
+
+		case LUA_TNUMBER:
+			type = NUMBER;
+			number = lua_tonumber(L, arg);
+			return true;
+
+		case LUA_TSTRING: {
+			size_t length;
+			const char* data = lua_tolstring(L, arg, &length);
+			type = STRING;
+			string.assign(data, length);
+			return true;
+		}
+
+		case LUA_TTABLE: {
+			if (depth >= MAX_VALUE_DEPTH) {
+				error = "Table nested too deep.";
+				return false;
+			}
+
+			if (arg < 0) {
+				arg = lua_gettop(L) + arg + 1;
+			}
+
+			type = TABLE;
+			lua_pushnil(L);
+			while (lua_next(L, arg) != 0) {
+				keys.emplace_back();
+				values.emplace_back();
+				if (!keys.back().read(L, -2, error, depth + 1) || !values.back().read(L, -1, error, depth + 1)) {
+					lua_pop(L, 2);
+					return false;
+				}
+				lua_pop(L, 1);
+			}
+			return true;
+		}
+
+		default:
+			error = fmt::format("A {:s} can't be passed to another state.", lua_typename(L, lua_type(L, arg)));
+			return false;
+	}
+}
+
+void ScriptValue::push(lua_State* L) const
+{
+	switch (type) {
+		case BOOLEAN:
+			lua_pushboolean(L, boolean);
+			break;
+
+		case NUMBER:
+			// keep whole numbers integers on Lua 5.3+, tostring would add a .0 otherwise
+			if (std::floor(number) == number && std::abs(number) < 9007199254740992.0) {
+				lua_pushinteger(L, static_cast<lua_Integer>(number));
+			} else {
+				lua_pushnumber(L, number);
+			}
+			break;
+
+		case STRING:
+			lua_pushlstring(L, string.data(), string.size());
+			break;
+
+		case TABLE:
+			lua_createtable(L, 0, static_cast<int>(keys.size()));
+			for (size_t i = 0, size = keys.size(); i < size; ++i) {
+				keys[i].push(L);
+				values[i].push(L);
+				lua_rawset(L, -3);
+			}
+			break;
+
+		default:
+			lua_pushnil(L);
+			break;
+	}
+}
+
+ScriptShards::~ScriptShards()
+{
+	shutdown();
+}
+
+bool ScriptShards::start()
+{
+	int32_t count = std::max<int32_t>(0, g_config.getNumber(ConfigManager::SCRIPT_SHARDS));
+	if (count == 0) {
+		return true;
+	}
+
+	std::vector<std::string> files;
+	std::error_code ec;
+	for (fs::recursive_directory_iterator it(SHARD_SCRIPTS_PATH, ec), end; !ec && it != end; it.increment(ec)) {
+		if (it->is_regular_file(ec) && it->path().extension() == ".lua") {
+			files.push_back(it->path().generic_string());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	shards.reserve(count);
+	for (int32_t i = 0; i < count; ++i) {
+		auto shard = std::make_unique<Shard>();
+		shard->id = i + 1;
+		shard->L = luaL_newstate();
+		if (!shard->L) {
+			console::reportError("ScriptShards::start", "Unable to create a Lua state.");
+			return false;
+		}
+		shards.push_back(std::move(shard));
+
+		if (!loadScripts(*shards.back(), files)) {
+			return false;
+		}
+	}
+
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Script shards: {:d} states running {:d} scripts.", count, files.size()));
+	return true;
+}
+
+void ScriptShards::shutdown()
+{
+	for (const auto& shard : shards) {
+		std::unique_lock<std::mutex> lockGuard(shard->lock);
+		shard->stopping = true;
+		shard->jobs.clear();
+		shard->idleSignal.wait(lockGuard, [&shard]() { return !shard->executing; });
+
+		if (shard->L) {
+			lua_close(shard->L);
+			shard->L = nullptr;
+		}
+	}
+}
+
+void ScriptShards::attach(lua_State*)
+{
+	// the refs went with the old state
+	messageHandlers.clear();
+	++generation;
+}
+
+bool ScriptShards::post(const std::string& handler, ScriptValue&& payload, uint32_t key, int32_t callback, int32_t scriptId)
+{
+	if (shards.empty()) {
+		return false;
+	}
+
+	// unkeyed jobs are spread round-robin
+	if (key == 0) {
+		key = nextShard++;
+	}
+
+	Shard& shard = *shards[key % shards.size()];
+	{
+		std::lock_guard<std::mutex> lockGuard(shard.lock);
+		if (shard.stopping) {
+			return false;
+		}
+
+		shard.jobs.push_back({handler, std::move(payload), callback, scriptId, generation});
+		if (shard.scheduled) {
+			return true;
+		}
+		shard.scheduled = true;
+	}
+
+	schedule(shard);
+	return true;
+}
+
+void ScriptShards::setMessageHandler(const std::string& name, int32_t ref, int32_t scriptId)
+{
+	auto it = messageHandlers.find(name);
+	if (it != messageHandlers.end()) {
+		if (lua_State* L = g_luaEnvironment.getLuaState()) {
+			luaL_unref(L, LUA_REGISTRYINDEX, it->second.ref);
+		}
+		messageHandlers.erase(it);
+	}
+
+	if (ref != -1) {
+		messageHandlers.emplace(name, MessageHandler{ref, scriptId});
+	}
+}
+
+void ScriptShards::printStats() const
+{
+	if (shards.empty()) {
+		return;
+	}
+
+	uint64_t jobsRun = 0;
+	std::chrono::nanoseconds jobTime{0};
+	for (const auto& shard : shards) {
+		jobsRun += shard->jobsRun;
+		jobTime += shard->jobTime;
+	}
+	console::print(CONSOLEMESSAGE_TYPE_INFO, fmt::format("Script shards: {:d} jobs took {:d} ms on {:d} states, {:d} messages posted back.", jobsRun, std::chrono::duration_cast<std::chrono::milliseconds>(jobTime).count(), shards.size(), messagesPosted.load()));
+}
+
+bool ScriptShards::loadScripts(Shard& shard, const std::vector<std::string>& files)
+{
+	lua_State* L = shard.L;
+	luaL_openlibs(L);
+
+	lua_createtable(L, 0, 4);
+	lua_pushlightuserdata(L, &shard);
+	lua_pushcclosure(L, luaShardOn, 1);
+	lua_setfield(L, -2, "on");
+	lua_pushcfunction(L, luaShardPost);
+	lua_setfield(L, -2, "post");
+	lua_pushlightuserdata(L, &shard);
+	lua_pushcclosure(L, luaShardGetId, 1);
+	lua_setfield(L, -2, "getId");
+	lua_pushcfunction(L, luaShardGetCount);
+	lua_setfield(L, -2, "getCount");
+	lua_setglobal(L, "Shard");
+
+	for (const std::string& file : files) {
+		if (g_luaBytecodeCache.load(L, file) != 0 || LuaScriptInterface::protectedCall(L, 0, 0) != 0) {
+			console::reportError("ScriptShards::loadScripts", fmt::format("Shard {:d}, {:s}: {:s}", shard.id, file, LuaScriptInterface::popString(L)));
+			return false;
+		}
+	}
+	return true;
+}
+
+void ScriptShards::schedule(Shard& shard)
+{
+	if (g_workerPool.getThreadCount() != 0) {
+		g_workerPool.addTask([this, &shard]() { drain(shard); });
+	} else {
+		// without workers the jobs run between the dispatcher tasks
+		g_dispatcher.addTask(createTask([this, &shard]() { drain(shard); }));
+	}
+}
+
+void ScriptShards::drain(Shard& shard)
+{
+	for (int i = 0; i < JOBS_PER_DRAIN; ++i) {
+		Job job;
+		{
+			std::lock_guard<std::mutex> lockGuard(shard.lock);
+			if (shard.stopping || shard.jobs.empty()) {
+				shard.scheduled = false;
+				return;
+			}
+
+			job = std::move(shard.jobs.front());
+			shard.jobs.pop_front();
+			shard.executing = true;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		runJob(shard, job);
+		auto elapsed = std::chrono::steady_clock::now() - start;
+
+		{
+			std::lock_guard<std::mutex> lockGuard(shard.lock);
+			shard.executing = false;
+			shard.jobTime += elapsed;
+			++shard.jobsRun;
+		}
+		shard.idleSignal.notify_all();
+	}
+
+	// still scheduled, back in line behind the others
+	schedule(shard);
+}
+
+void ScriptShards::runJob(Shard& shard, Job& job)
+{
+	lua_State* L = shard.L;
+
+	bool success = false;
+	ScriptValue result;
+	std::string error;
+
+	auto it = shard.handlers.find(job.handler);
+	if (it == shard.handlers.end()) {
+		error = fmt::format("No handler named {:s}.", job.handler);
+	} else {
+		lua_rawgeti(L, LUA_REGISTRYINDEX, it->second);
+		job.payload.push(L);
+		if (LuaScriptInterface::protectedCall(L, 1, 1) != 0) {
+			error = LuaScriptInterface::popString(L);
+		} else {
+			success = result.read(L, -1, error);
+			lua_pop(L, 1);
+		}
+	}
+
+	if (!success) {
+		console::reportError("ScriptShards::runJob", fmt::format("Shard {:d}, {:s}: {:s}", shard.id, job.handler, error));
+	}
+
+	if (job.callback != -1) {
+		g_dispatcher.addTask(createTask([this, callback = job.callback, scriptId = job.scriptId, generation = job.generation, success, result = std::move(result), error = std::move(error)]() {
+			deliverReply(callback, scriptId, generation, success, result, error);
+		}));
+	}
+}
+
+void ScriptShards::deliverReply(int32_t callback, int32_t scriptId, uint32_t generation, bool success, const ScriptValue& result, const std::string& error)
+{
+	lua_State* L = g_luaEnvironment.getLuaState();
+	if (!L || generation != this->generation) {
+		return;
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, callback);
+	luaL_unref(L, LUA_REGISTRYINDEX, callback);
+
+	// callback(result) or callback(nil, error)
+	int parameters = 1;
+	if (success) {
+		result.push(L);
+	} else {
+		lua_pushnil(L);
+		LuaScriptInterface::pushString(L, error);
+		parameters = 2;
+	}
+
+	if (!LuaScriptInterface::reserveScriptEnv()) {
+		lua_pop(L, parameters + 1);
+		console::reportOverflow("ScriptShards::deliverReply");
+		return;
+	}
+
+	LuaScriptInterface::getScriptEnv()->setScriptId(scriptId, &g_luaEnvironment);
+	g_luaEnvironment.callFunction(parameters);
+}
+
+void ScriptShards::deliverMessage(const std::string& name, const ScriptValue& payload)
+{
+	lua_State* L = g_luaEnvironment.getLuaState();
+	if (!L) {
+		return;
+	}
+
+	auto it = messageHandlers.find(name);
+	if (it == messageHandlers.end()) {
+		console::reportWarning("ScriptShards::deliverMessage", fmt::format("No handler for shard message {:s}.", name));
+		return;
+	}
+
+	if (!LuaScriptInterface::reserveScriptEnv()) {
+		console::reportOverflow("ScriptShards::deliverMessage");
+		return;
+	}
+
+	// the handler may replace itself
+	int32_t scriptId = it->second.scriptId;
+	lua_rawgeti(L, LUA_REGISTRYINDEX, it->second.ref);
+	payload.push(L);
+
+	LuaScriptInterface::getScriptEnv()->setScriptId(scriptId, &g_luaEnvironment);
+	g_luaEnvironment.callFunction(1);
+}
+
+int ScriptShards::luaShardOn(lua_State* L)
+{
+	// Shard.on(name, callback)
+	Shard* shard = static_cast<Shard*>(lua_touserdata(L, lua_upvalueindex(1)));
+	if (!LuaScriptInterface::isString(L, 1) || !LuaScriptInterface::isFunction(L, 2)) {
+		console::reportError("Shard.on", fmt::format("Shard {:d}: expected a name and a function.", shard->id));
+		LuaScriptInterface::pushBoolean(L, false);
+		return 1;
+	}
+
+	const std::string name = LuaScriptInterface::getString(L, 1);
+	auto it = shard->handlers.find(name);
+	if (it != shard->handlers.end()) {
+		luaL_unref(L, LUA_REGISTRYINDEX, it->second);
+	}
+
+	lua_settop(L, 2);
+	shard->handlers[name] = luaL_ref(L, LUA_REGISTRYINDEX);
+	LuaScriptInterface::pushBoolean(L, true);
+	return 1;
+}
+
+int ScriptShards::luaShardPost(lua_State* L)
+{
+	// Shard.post(name[, payload])
+	if (!LuaScriptInterface::isString(L, 1)) {
+		console::reportError("Shard.post", "Expected a message name.");
+		LuaScriptInterface::pushBoolean(L, false);
+		return 1;
+	}
+
+	std::string name = LuaScriptInterface::getString(L, 1);
+	ScriptValue payload;
+	std::string error;
+	if (!payload.read(L, 2, error)) {
+		console::reportError("Shard.post", fmt::format("{:s}: {:s}", name, error));
+		LuaScriptInterface::pushBoolean(L, false);
+		return 1;
+	}
+
+	++g_scriptShards.messagesPosted;
+	g_dispatcher.addTask(createTask([name = std::move(name), payload = std::move(payload)]() {
+		g_scriptShards.deliverMessage(name, payload);
+	}));
+	LuaScriptInterface::pushBoolean(L, true);
+	return 1;
+}
+
+int ScriptShards::luaShardGetId(lua_State* L)
+{
+	// Shard.getId()
+	const Shard* shard = static_cast<const Shard*>(lua_touserdata(L, lua_upvalueindex(1)));
+	lua_pushnumber(L, shard->id);
+	return 1;
+}
+
+int ScriptShards::luaShardGetCount(lua_State* L)
+{
+	// Shard.getCount()
+	lua_pushnumber(L, g_scriptShards.getShardCount());
+	return 1;
+}
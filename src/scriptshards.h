@@ -0,0 +1,116 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_SCRIPTSHARDS_H
+#define FS_SCRIPTSHARDS_H
+
+struct lua_State;
+
+// plain Lua value copied between states, tables are copied deeply
+struct ScriptValue
+{
+	enum Type : uint8_t {
+		NIL,
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		TABLE,
+	};
+
+	// functions, userdata and tables nested too deep are rejected with a message in error
+	bool read(lua_State* L, int arg, std::string& error, int depth = 0);
+	void push(lua_State* L) const;
+
+	Type type = NIL;
+	bool boolean = false;
+	double number = 0;
+	std::string string;
+	std::vector<ScriptValue> keys;
+	std::vector<ScriptValue> values;
+};
+
+// Lua states of their own for scripts that need no game state, jobs run on the worker pool
+class ScriptShards
+{
+	public:
+		ScriptShards() = default;
+		~ScriptShards();
+
+		// non-copyable
+		ScriptShards(const ScriptShards&) = delete;
+		ScriptShards& operator=(const ScriptShards&) = delete;
+
+		// creates the shards from config.lua and loads their scripts
+		bool start();
+		// drops the queued jobs and closes the states once the running ones finished
+		void shutdown();
+
+		// the main state was (re)created, its message handlers are gone
+		void attach(lua_State* L);
+
+		size_t getShardCount() const {
+			return shards.size();
+		}
+
+		// called on the dispatcher, callback is a main state registry ref or -1
+		bool post(const std::string& handler, ScriptValue&& payload, uint32_t key, int32_t callback, int32_t scriptId);
+		// replaces the main state handler for messages posted by shard scripts
+		void setMessageHandler(const std::string& name, int32_t ref, int32_t scriptId);
+
+		void printStats() const;
+
+	private:
+		struct Job {
+			std::string handler;
+			ScriptValue payload;
+			int32_t callback = -1;
+			int32_t scriptId = 0;
+			uint32_t generation = 0;
+		};
+
+		struct Shard {
+			lua_State* L = nullptr;
+			uint32_t id = 0;
+
+			std::map<std::string, int32_t> handlers;
+
+			std::mutex lock;
+			std::condition_variable idleSignal;
+			std::deque<Job> jobs;
+			bool scheduled = false;
+			bool executing = false;
+			bool stopping = false;
+
+			uint64_t jobsRun = 0;
+			std::chrono::nanoseconds jobTime{0};
+		};
+
+		struct MessageHandler {
+			int32_t ref;
+			int32_t scriptId;
+		};
+
+		bool loadScripts(Shard& shard, const std::vector<std::string>& files);
+		void schedule(Shard& shard);
+		void drain(Shard& shard);
+		void runJob(Shard& shard, Job& job);
+
+		void deliverReply(int32_t callback, int32_t scriptId, uint32_t generation, bool success, const ScriptValue& result, const std::string& error);
+		void deliverMessage(const std::string& name, const ScriptValue& payload);
+
+		static int luaShardOn(lua_State* L);
+		static int luaShardPost(lua_State* L);
+		static int luaShardGetId(lua_State* L);
+		static int luaShardGetCount(lua_State* L);
+
+		std::vector<std::unique_ptr<Shard>> shards;
+		uint32_t nextShard = 0;
+
+		// dispatcher only
+		std::map<std::string, MessageHandler> messageHandlers;
+		uint32_t generation = 0;
+
+		std::atomic<uint64_t> messagesPosted{0};
+};
+
+#endif // FS_SCRIPTSHARDS_H
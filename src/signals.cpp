@@ -11,6 +11,7 @@
 #include "events.h"
 #include "game.h"
 #include "globalevent.h"
+#include "journal.h"
 #include "monsters.h"
 #include "mounts.h"
 #include "movement.h"
@@ -27,6 +28,7 @@
 
 extern Scheduler g_scheduler;
 extern DatabaseTasks g_databaseTasks;
+extern Journal g_journal;
 extern Dispatcher g_dispatcher;
 
 extern ConfigManager g_config;
@@ -167,6 +169,7 @@ void dispatchSignalHandler(int signal)
 			g_dispatcher.addTask(createTask(sigbreakHandler));
 			// hold the thread until other threads end
 			g_scheduler.join();
+			g_journal.join();
 			g_databaseTasks.join();
 			g_dispatcher.join();
 			break;
@@ -12,7 +12,6 @@
 #include "npc.h"
 #include "pugicast.h"
 #include "scheduler.h"
-#include "spectators.h"
 
 extern ConfigManager g_config;
 extern Monsters g_monsters;
@@ -254,9 +253,11 @@ void Spawns::startup()
 
 void Spawns::clear()
 {
-	for (Spawn& spawn : spawnList) {
-		spawn.stopEvent();
+	if (checkSpawnEvent != 0) {
+		g_scheduler.stopEvent(checkSpawnEvent);
+		checkSpawnEvent = 0;
 	}
+	spawnQueue.clear();
 	spawnList.clear();
 
 	loaded = false;
@@ -274,11 +275,63 @@ bool Spawns::isInZone(const Position& centerPos, int32_t radius, const Position&
 			(pos.getY() >= centerPos.getY() - radius) && (pos.getY() <= centerPos.getY() + radius));
 }
 
-void Spawn::startSpawnCheck()
+void Spawns::scheduleSpawn(Spawn* spawn, uint32_t spawnId, int64_t due)
+{
+	spawnQueue.push_back({due, spawn, spawnId});
+	std::push_heap(spawnQueue.begin(), spawnQueue.end(), std::greater<SpawnEvent>());
+	scheduleCheck();
+}
+
+void Spawns::scheduleCheck()
 {
-	if (checkSpawnEvent == 0) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), [this]() { checkSpawn(); }));
+	if (spawnQueue.empty()) {
+		return;
 	}
+
+	int64_t due = spawnQueue.front().due;
+	if (checkSpawnEvent != 0) {
+		if (due >= nextCheck) {
+			return;
+		}
+		g_scheduler.stopEvent(checkSpawnEvent);
+	}
+
+	nextCheck = due;
+	checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(std::max<int64_t>(SCHEDULER_MINTICKS, due - OTSYS_TIME()), [this]() { checkSpawns(); }));
+}
+
+void Spawns::checkSpawns()
+{
+	checkSpawnEvent = 0;
+
+	int64_t now = OTSYS_TIME();
+	while (!spawnQueue.empty() && spawnQueue.front().due <= now) {
+		std::pop_heap(spawnQueue.begin(), spawnQueue.end(), std::greater<SpawnEvent>());
+		SpawnEvent event = spawnQueue.back();
+		spawnQueue.pop_back();
+
+		event.spawn->checkSpawn(event.spawnId, now, false);
+	}
+
+	scheduleCheck();
+}
+
+void Spawns::respawnAll()
+{
+	// respawns that fail again are queued while this runs
+	std::vector<SpawnEvent> events;
+	events.swap(spawnQueue);
+
+	int64_t now = OTSYS_TIME();
+	for (const SpawnEvent& event : events) {
+		event.spawn->checkSpawn(event.spawnId, now, true);
+	}
+
+	if (checkSpawnEvent != 0) {
+		g_scheduler.stopEvent(checkSpawnEvent);
+		checkSpawnEvent = 0;
+	}
+	scheduleCheck();
 }
 
 Spawn::~Spawn()
@@ -292,14 +345,7 @@ Spawn::~Spawn()
 
 bool Spawn::findPlayer(const Position& pos)
 {
-	SpectatorVec spectators;
-	g_game.map.getSpectators(spectators, pos, false, true);
-	for (Creature* spectator : spectators) {
-		if (!spectator->getPlayer()->hasFlag(PlayerFlag_IgnoredByMonsters)) {
-			return true;
-		}
-	}
-	return false;
+	return g_game.map.isPlayerInView(pos);
 }
 
 bool Spawn::isInSpawnZone(const Position& pos)
@@ -399,43 +445,64 @@ bool Spawn::spawnMonster(uint32_t spawnId, MonsterType* mType, const Position& p
 
 void Spawn::startup()
 {
-	for (const auto& it : spawnMap) {
+	for (auto& it : spawnMap) {
 		uint32_t spawnId = it.first;
-		const spawnBlock_t& sb = it.second;
-		spawnMonster(spawnId, sb, true);
+		spawnBlock_t& sb = it.second;
+		if (!spawnMonster(spawnId, sb, true)) {
+			scheduleSpawn(spawnId, sb, OTSYS_TIME() + getInterval());
+		}
 	}
 }
 
-void Spawn::checkSpawn()
+void Spawn::scheduleSpawn(uint32_t spawnId, spawnBlock_t& sb, int64_t due)
 {
-	checkSpawnEvent = 0;
+	if (sb.queued) {
+		return;
+	}
 
-	cleanup();
+	sb.queued = true;
+	g_game.map.spawns.scheduleSpawn(this, spawnId, due);
+}
 
-	uint32_t spawnCount = 0;
+void Spawn::checkSpawn(uint32_t spawnId, int64_t checkTime, bool catchUp)
+{
+	auto it = spawnMap.find(spawnId);
+	if (it == spawnMap.end()) {
+		return;
+	}
 
-	for (auto& it : spawnMap) {
-		uint32_t spawnId = it.first;
-		if (spawnedMap.find(spawnId) != spawnedMap.end()) {
-			continue;
-		}
+	spawnBlock_t& sb = it->second;
+	sb.queued = false;
 
-		spawnBlock_t& sb = it.second;
-		if (OTSYS_TIME() >= sb.lastSpawn + sb.interval) {
-			if (!spawnMonster(spawnId, sb)) {
-				sb.lastSpawn = OTSYS_TIME();
-				continue;
-			}
+	// once per scheduler pass, not for every slot due in it
+	if (lastCleanupTime != checkTime) {
+		lastCleanupTime = checkTime;
+		cleanup();
+	}
 
-			if (++spawnCount >= static_cast<uint32_t>(g_config.getNumber(ConfigManager::RATE_SPAWN))) {
-				break;
-			}
+	if (spawnedMap.find(spawnId) != spawnedMap.end()) {
+		return;
+	}
+
+	if (!catchUp) {
+		if (lastCheckTime != checkTime) {
+			lastCheckTime = checkTime;
+			checkSpawnCount = 0;
+		}
+
+		if (checkSpawnCount >= static_cast<uint32_t>(g_config.getNumber(ConfigManager::RATE_SPAWN))) {
+			scheduleSpawn(spawnId, sb, checkTime + getInterval());
+			return;
 		}
 	}
 
-	if (spawnedMap.size() < spawnMap.size()) {
-		checkSpawnEvent = g_scheduler.addEvent(createSchedulerTask(getInterval(), [this]() { checkSpawn(); }));
+	if (!spawnMonster(spawnId, sb)) {
+		sb.lastSpawn = OTSYS_TIME();
+		scheduleSpawn(spawnId, sb, sb.lastSpawn + sb.interval);
+		return;
 	}
+
+	++checkSpawnCount;
 }
 
 void Spawn::cleanup()
@@ -450,6 +517,9 @@ void Spawn::cleanup()
 		} else if (!isInSpawnZone(monster->getPosition()) && spawnId != 0) {
 			spawnedMap.insert({0, monster});
 			it = spawnedMap.erase(it);
+
+			spawnBlock_t& sb = spawnMap[spawnId];
+			scheduleSpawn(spawnId, sb, std::max<int64_t>(OTSYS_TIME(), sb.lastSpawn + sb.interval));
 		} else {
 			++it;
 		}
@@ -488,18 +558,18 @@ bool Spawn::addMonster(const std::string& name, const Position& pos, Direction d
 void Spawn::removeMonster(Monster* monster)
 {
 	for (auto it = spawnedMap.begin(), end = spawnedMap.end(); it != end; ++it) {
-		if (it->second == monster) {
-			monster->decrementReferenceCounter();
-			spawnedMap.erase(it);
-			break;
+		if (it->second != monster) {
+			continue;
 		}
-	}
-}
 
-void Spawn::stopEvent()
-{
-	if (checkSpawnEvent != 0) {
-		g_scheduler.stopEvent(checkSpawnEvent);
-		checkSpawnEvent = 0;
+		uint32_t spawnId = it->first;
+		monster->decrementReferenceCounter();
+		spawnedMap.erase(it);
+
+		if (spawnId != 0) {
+			spawnBlock_t& sb = spawnMap[spawnId];
+			scheduleSpawn(spawnId, sb, std::max<int64_t>(OTSYS_TIME() + getInterval(), sb.lastSpawn + sb.interval));
+		}
+		break;
 	}
 }
@@ -17,6 +17,7 @@ struct spawnBlock_t {
 	uint32_t interval;
 	Direction direction;
 	uint8_t spawnTries = 0;
+	bool queued = false;
 };
 
 class Spawn
@@ -38,8 +39,7 @@ class Spawn
 		}
 		void startup();
 
-		void startSpawnCheck();
-		void stopEvent();
+		void checkSpawn(uint32_t spawnId, int64_t checkTime, bool catchUp);
 
 		bool isInSpawnZone(const Position& pos);
 		void cleanup();
@@ -56,12 +56,16 @@ class Spawn
 		int32_t radius;
 
 		uint32_t interval = 60000;
-		uint32_t checkSpawnEvent = 0;
+
+		// respawns done by the current scheduler pass, limited by rateSpawn
+		int64_t lastCheckTime = 0;
+		uint32_t checkSpawnCount = 0;
+		int64_t lastCleanupTime = 0;
 
 		static bool findPlayer(const Position& pos);
 		bool spawnMonster(uint32_t spawnId, spawnBlock_t sb, bool startup = false);
 		bool spawnMonster(uint32_t spawnId, MonsterType* mType, const Position& pos, Direction dir, bool startup = false);
-		void checkSpawn();
+		void scheduleSpawn(uint32_t spawnId, spawnBlock_t& sb, int64_t due);
 };
 
 class Spawns
@@ -73,6 +77,9 @@ class Spawns
 		void startup();
 		void clear();
 
+		void scheduleSpawn(Spawn* spawn, uint32_t spawnId, int64_t due);
+		void respawnAll();
+
 		bool isStarted() const {
 			return started;
 		}
@@ -87,6 +94,24 @@ class Spawns
 		}
 
 	private:
+		struct SpawnEvent {
+			int64_t due;
+			Spawn* spawn;
+			uint32_t spawnId;
+
+			bool operator>(const SpawnEvent& other) const {
+				return due > other.due;
+			}
+		};
+
+		void checkSpawns();
+		void scheduleCheck();
+
+		// min-heap of respawn due times for every spawn
+		std::vector<SpawnEvent> spawnQueue;
+		int64_t nextCheck = 0;
+		uint32_t checkSpawnEvent = 0;
+
 		std::forward_list<Npc*> npcList;
 		std::forward_list<Spawn> spawnList;
 		std::string filename;
@@ -35,6 +35,7 @@ public:
 		vec.pop_back();
 	}
 
+	void clear() { vec.clear(); }
 	size_t size() const { return vec.size(); }
 	bool empty() const { return vec.empty(); }
 	Iterator begin() { return vec.begin(); }
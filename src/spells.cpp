@@ -11,6 +11,7 @@
 #include "luavariant.h"
 #include "monsters.h"
 #include "pugicast.h"
+#include "saytrie.h"
 
 extern Game g_game;
 extern Spells* g_spells;
@@ -92,6 +93,7 @@ void Spells::clearMaps(bool fromLua)
 			++instant;
 		}
 	}
+	g_sayTrie.invalidate();
 
 	for (auto rune = runes.begin(); rune != runes.end(); ) {
 		if (fromLua == rune->second.fromLua) {
@@ -133,6 +135,7 @@ bool Spells::registerEvent(Event_ptr event, const pugi::xml_node&)
 {
 	InstantSpell* instant = dynamic_cast<InstantSpell*>(event.get());
 	if (instant) {
+		g_sayTrie.invalidate();
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
 		if (!result.second) {
 			console::reportWarning("Spells::registerEvent", "Duplicate registered instant spell with words \"" + instant->getWords() + "\"!");
@@ -156,6 +159,7 @@ bool Spells::registerInstantLuaEvent(InstantSpell* event)
 {
 	InstantSpell_ptr instant { event };
 	if (instant) {
+		g_sayTrie.invalidate();
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
 		if (!result.second) {
 			console::reportWarning("Spells::registerInstantLuaEvent", "Duplicate registered instant spell with words \"" + instant->getWords() + "\"!");
@@ -215,21 +219,7 @@ RuneSpell* Spells::getRuneSpellByName(const std::string& name)
 
 InstantSpell* Spells::getInstantSpell(const std::string& words)
 {
-	InstantSpell* result = nullptr;
-
-	for (auto& it : instants) {
-		const std::string& instantSpellWords = it.second.getWords();
-		size_t spellLen = instantSpellWords.length();
-		if (caseInsensitiveStartsWith(words, instantSpellWords)) {
-			if (!result || spellLen > result->getWords().size()) {
-				result = &it.second;
-				if (words.length() == spellLen) {
-					break;
-				}
-			}
-		}
-	}
-
+	InstantSpell* result = g_sayTrie.getInstantSpell(words);
 	if (result) {
 		const std::string& resultWords = result->getWords();
 		if (words.length() > resultWords.length()) {
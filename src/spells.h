@@ -61,6 +61,7 @@ class Spells final : public BaseEvents
 		std::map<std::string, InstantSpell> instants;
 
 		friend class CombatSpell;
+		friend class SayTrie;
 		LuaScriptInterface scriptInterface { "Spell Interface" };
 };
 
@@ -4,6 +4,7 @@
 #include "otpch.h"
 
 #include "player.h"
+#include "saytrie.h"
 #include "talkaction.h"
 
 TalkActions::TalkActions()
@@ -26,6 +27,7 @@ void TalkActions::clear(bool fromLua)
 			++it;
 		}
 	}
+	g_sayTrie.invalidate();
 
 	reInitState(fromLua);
 }
@@ -52,6 +54,7 @@ bool TalkActions::registerEvent(Event_ptr event, const pugi::xml_node&)
 {
 	TalkAction_ptr talkAction{static_cast<TalkAction*>(event.release())}; // event is guaranteed to be a TalkAction
 	std::vector<std::string> words = talkAction->getWordsMap();
+	g_sayTrie.invalidate();
 
 	for (size_t i = 0; i < words.size(); i++) {
 		if (i == words.size() - 1) {
@@ -68,6 +71,7 @@ bool TalkActions::registerLuaEvent(TalkAction* event)
 {
 	TalkAction_ptr talkAction{ event };
 	std::vector<std::string> words = talkAction->getWordsMap();
+	g_sayTrie.invalidate();
 
 	for (size_t i = 0; i < words.size(); i++) {
 		if (i == words.size() - 1) {
@@ -83,27 +87,22 @@ bool TalkActions::registerLuaEvent(TalkAction* event)
 TalkActionResult_t TalkActions::playerSaySpell(Player* player, MessageClasses type, const std::string& words) const
 {
 	size_t wordsLength = words.length();
-	for (auto it = talkActions.begin(); it != talkActions.end(); ) {
-		const std::string& talkactionWords = it->first;
-		if (!caseInsensitiveStartsWith(words, talkactionWords)) {
-			++it;
-			continue;
-		}
+	for (const SayTrie::TalkActionMatch& match : g_sayTrie.getTalkActions(words)) {
+		const std::string& talkactionWords = *match.words;
+		TalkAction& talkAction = *match.talkAction;
 
 		std::string param;
 		if (wordsLength != talkactionWords.size()) {
 			param = words.substr(talkactionWords.size());
 			if (param.front() != ' ') {
-				++it;
 				continue;
 			}
 			trim_left(param, ' ');
 
-			std::string separator = it->second.getSeparator();
+			std::string separator = talkAction.getSeparator();
 			if (separator != " ") {
 				if (!param.empty()) {
 					if (param != separator) {
-						++it;
 						continue;
 					} else {
 						param.erase(param.begin());
@@ -112,17 +111,17 @@ TalkActionResult_t TalkActions::playerSaySpell(Player* player, MessageClasses ty
 			}
 		}
 
-		if (it->second.fromLua) {
-			if (it->second.getNeedAccess() && !player->getGroup()->access) {
+		if (talkAction.fromLua) {
+			if (talkAction.getNeedAccess() && !player->getGroup()->access) {
 				return TALKACTION_CONTINUE;
 			}
 
-			if (player->getAccountType() < it->second.getRequiredAccountType()) {
+			if (player->getAccountType() < talkAction.getRequiredAccountType()) {
 				return TALKACTION_CONTINUE;
 			}
 		}
 
-		if (it->second.executeSay(player, talkactionWords, param, type)) {
+		if (talkAction.executeSay(player, talkactionWords, param, type)) {
 			return TALKACTION_CONTINUE;
 		} else {
 			return TALKACTION_BREAK;
@@ -171,7 +170,7 @@ bool TalkAction::executeSay(Player* player, const std::string& words, const std:
 	scriptInterface->pushFunction(scriptId);
 
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 
 	LuaScriptInterface::pushString(L, words);
 	LuaScriptInterface::pushString(L, param);
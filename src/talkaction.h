@@ -93,6 +93,7 @@ class TalkActions final : public BaseEvents
 
 		std::map<std::string, TalkAction> talkActions;
 
+		friend class SayTrie;
 		LuaScriptInterface scriptInterface;
 };
 
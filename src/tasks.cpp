@@ -7,8 +7,10 @@
 
 #include "enums.h"
 #include "game.h"
+#include "luacollector.h"
 
 extern Game g_game;
+extern LuaGarbageCollector g_luaGarbageCollector;
 
 Task* createTask(TaskFunc&& f)
 {
@@ -28,6 +30,7 @@ void Dispatcher::threadMain()
 
 	while (getState() != THREAD_STATE_TERMINATED) {
 		// check if there are tasks waiting
+		auto idleStart = std::chrono::steady_clock::now();
 		taskLockUnique.lock();
 		if (taskList.empty()) {
 			//if the list is empty wait for signal
@@ -35,6 +38,7 @@ void Dispatcher::threadMain()
 		}
 		tmpTaskList.swap(taskList);
 		taskLockUnique.unlock();
+		g_luaGarbageCollector.idle(std::chrono::steady_clock::now() - idleStart);
 
 		for (Task* task : tmpTaskList) {
 			if (!task->hasExpired()) {
@@ -45,6 +49,9 @@ void Dispatcher::threadMain()
 			delete task;
 		}
 		tmpTaskList.clear();
+
+		// collect the garbage of this cycle's scripts before waiting for the next one
+		g_luaGarbageCollector.step();
 	}
 }
 
@@ -24,6 +24,12 @@ extern ConfigManager g_config;
 StaticTile real_nullptr_tile(0xFFFF, 0xFFFF, 0xFF);
 Tile& Tile::nullptr_tile = real_nullptr_tile;
 
+Tile::~Tile()
+{
+	delete ground;
+	LuaScriptInterface::removeCachedUserdata(this);
+}
+
 bool Tile::hasProperty(ITEMPROPERTY prop) const
 {
 	if (ground && ground->hasProperty(prop)) {
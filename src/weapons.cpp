@@ -33,11 +33,10 @@ const Weapon* Weapons::getWeapon(const Item* item) const
 		return nullptr;
 	}
 
-	auto it = weapons.find(item->getID());
-	if (it == weapons.end()) {
-		return nullptr;
+	if (weaponIndex.isStale()) {
+		weaponIndex.build(weapons, [](const Weapon* weapon) { return weapon; });
 	}
-	return it->second;
+	return weaponIndex.find(item->getID());
 }
 
 void Weapons::clear(bool fromLua)
@@ -49,6 +48,7 @@ void Weapons::clear(bool fromLua)
 			++it;
 		}
 	}
+	weaponIndex.invalidate();
 
 	reInitState(fromLua);
 }
@@ -65,6 +65,7 @@ std::string Weapons::getScriptBaseName() const
 
 void Weapons::loadDefaults()
 {
+	weaponIndex.invalidate();
 	for (size_t i = 100, size = Item::items.size(); i < size; ++i) {
 		const ItemType& it = Item::items.getItemType(i);
 		if (it.id == 0 || weapons.find(i) != weapons.end()) {
@@ -116,6 +117,8 @@ bool Weapons::registerEvent(Event_ptr event, const pugi::xml_node&)
 {
 	Weapon* weapon = static_cast<Weapon*>(event.release()); //event is guaranteed to be a Weapon
 
+	weaponIndex.invalidate();
+
 	auto result = weapons.emplace(weapon->getID(), weapon);
 	if (!result.second) {
 		console::reportWarning("Weapons::registerEvent", fmt::format("Duplicate registered weapon with id: {:d}!", weapon->getID()));
@@ -126,6 +129,7 @@ bool Weapons::registerEvent(Event_ptr event, const pugi::xml_node&)
 bool Weapons::registerLuaEvent(Weapon* weapon)
 {
 	weapons[weapon->getID()] = weapon;
+	weaponIndex.invalidate();
 	return true;
 }
 
@@ -528,7 +532,7 @@ bool Weapon::executeUseWeapon(Player* player, const LuaVariant& var) const
 
 	scriptInterface->pushFunction(scriptId);
 	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::setMetatable(L, -1, LuaData_Player);
 	scriptInterface->pushVariant(L, var);
 
 	return scriptInterface->callFunction(2);
@@ -7,6 +7,7 @@
 #include "baseevents.h"
 #include "combat.h"
 #include "const.h"
+#include "idlookup.h"
 #include "luascript.h"
 #include "vocation.h"
 
@@ -42,6 +43,8 @@ class Weapons final : public BaseEvents
 		bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
 
 		std::map<uint32_t, Weapon*> weapons;
+		// rebuilt from weapons on the first lookup after it changed
+		mutable IdLookupTable<const Weapon> weaponIndex{true};
 
 		LuaScriptInterface scriptInterface { "Weapon Interface" };
 };
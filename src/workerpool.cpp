@@ -0,0 +1,108 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "workerpool.h"
+
+void WorkerPool::start(size_t threadCount)
+{
+	threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back(&WorkerPool::threadMain, this);
+	}
+}
+
+void WorkerPool::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(jobLock);
+		stopping = true;
+	}
+	jobSignal.notify_all();
+
+	for (std::thread& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	threads.clear();
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& f)
+{
+	if (threads.empty() || count < 2) {
+		for (size_t i = 0; i < count; ++i) {
+			f(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(jobLock);
+		job = &f;
+		jobCount = count;
+		nextIndex.store(0, std::memory_order_relaxed);
+		++generation;
+	}
+	jobSignal.notify_all();
+
+	runJob(f, count);
+
+	// workers still busy with a task join late or not at all, only wait for those that took part
+	std::unique_lock<std::mutex> jobLockUnique(jobLock);
+	doneSignal.wait(jobLockUnique, [this]() { return busyWorkers == 0; });
+	job = nullptr;
+}
+
+void WorkerPool::addTask(std::function<void()> f)
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(jobLock);
+		tasks.push_back(std::move(f));
+	}
+	jobSignal.notify_one();
+}
+
+void WorkerPool::runJob(const std::function<void(size_t)>& f, size_t count)
+{
+	for (size_t i = nextIndex.fetch_add(1); i < count; i = nextIndex.fetch_add(1)) {
+		f(i);
+	}
+}
+
+void WorkerPool::threadMain()
+{
+	uint64_t lastGeneration = 0;
+
+	std::unique_lock<std::mutex> jobLockUnique(jobLock);
+	while (true) {
+		jobSignal.wait(jobLockUnique, [&]() { return stopping || (job && generation != lastGeneration) || !tasks.empty(); });
+		if (stopping) {
+			return;
+		}
+
+		if (job && generation != lastGeneration) {
+			lastGeneration = generation;
+			const std::function<void(size_t)>* f = job;
+			size_t count = jobCount;
+			++busyWorkers;
+
+			jobLockUnique.unlock();
+			runJob(*f, count);
+			jobLockUnique.lock();
+
+			if (--busyWorkers == 0) {
+				doneSignal.notify_one();
+			}
+			continue;
+		}
+
+		std::function<void()> task = std::move(tasks.front());
+		tasks.pop_front();
+
+		jobLockUnique.unlock();
+		task();
+		jobLockUnique.lock();
+	}
+}
@@ -0,0 +1,51 @@
+// Copyright 2022 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_WORKERPOOL_H
+#define FS_WORKERPOOL_H
+
+// helper threads for parallelFor jobs, which may read game state while the dispatcher waits for them,
+// and addTask tasks, which run alongside the dispatcher and must not touch game state
+class WorkerPool
+{
+	public:
+		WorkerPool() = default;
+
+		// non-copyable
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		void start(size_t threadCount);
+		void shutdown();
+
+		size_t getThreadCount() const {
+			return threads.size();
+		}
+
+		// calls f(0) ... f(count - 1) on the workers and the calling thread, returns once all calls finished
+		void parallelFor(size_t count, const std::function<void(size_t)>& f);
+		// runs f on some worker later, parallelFor jobs go first
+		void addTask(std::function<void()> f);
+
+	private:
+		void threadMain();
+		void runJob(const std::function<void(size_t)>& f, size_t count);
+
+		std::vector<std::thread> threads;
+		std::mutex jobLock;
+		std::condition_variable jobSignal;
+		std::condition_variable doneSignal;
+
+		std::deque<std::function<void()>> tasks;
+
+		const std::function<void(size_t)>* job = nullptr;
+		size_t jobCount = 0;
+		std::atomic<size_t> nextIndex{0};
+		size_t busyWorkers = 0;
+		uint64_t generation = 0;
+		bool stopping = false;
+};
+
+extern WorkerPool g_workerPool;
+
+#endif